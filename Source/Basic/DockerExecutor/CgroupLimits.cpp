@@ -0,0 +1,107 @@
+#include "Basic/DockerExecutor/CgroupLimits.h"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
+namespace fs = std::filesystem;
+namespace CommandExecutor = Basic::SystemIntegrate::CommandExecutor;
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        // cpu.max 的调度周期 (微秒)
+        static constexpr int64_t kCpuPeriodMicros = 100000;
+
+        // 在容器内执行一次：把已有进程移出根组，再为 gcpkg 子树开启控制器
+        static const char* kSetupScript = R"(set -e
+mount -o remount,rw /sys/fs/cgroup 2>/dev/null || true
+mkdir -p /sys/fs/cgroup/init /sys/fs/cgroup/gcpkg
+for pid in $(cat /sys/fs/cgroup/cgroup.procs); do
+    echo "$pid" > /sys/fs/cgroup/init/cgroup.procs 2>/dev/null || true
+done
+echo '+cpu +memory' > /sys/fs/cgroup/cgroup.subtree_control
+echo '+cpu +memory' > /sys/fs/cgroup/gcpkg/cgroup.subtree_control
+)";
+
+        // 由每条命令通过 "." 加载：把当前 shell (以及它之后启动的所有子进程) 移入构建自己的 cgroup
+        static const char* kEnterScript = R"(# usage: . gcpkg_cgroup_enter.sh <name> <memory_bytes> <cpu_quota_micros>
+gcpkg_cg=/sys/fs/cgroup/gcpkg/$1
+if mkdir -p "$gcpkg_cg" 2>/dev/null; then
+    [ "$2" -gt 0 ] && echo "$2" > "$gcpkg_cg/memory.max" 2>/dev/null
+    [ "$3" -gt 0 ] && echo "$3 100000" > "$gcpkg_cg/cpu.max" 2>/dev/null
+    echo $$ > "$gcpkg_cg/cgroup.procs" 2>/dev/null
+fi
+unset gcpkg_cg
+)";
+
+        // 子 cgroup 名称只保留字母、数字和 '-'，其余字符替换为 '_'
+        static std::string SafeCgroupName(const std::string& cgroupName) {
+            std::string safe_name;
+            for (char c : cgroupName) {
+                safe_name.push_back(std::isalnum(static_cast<unsigned char>(c)) || c == '-' ? c : '_');
+            }
+            return safe_name;
+        }
+
+        static bool WriteScript(const fs::path& path, const char* content) {
+            std::ofstream file(path);
+            if (!file.is_open()) return false;
+            file << content;
+            return static_cast<bool>(file);
+        }
+
+        std::string EnableCgroupDelegation(const std::string& containerName, const std::string& scriptDir) {
+            std::error_code ec;
+            fs::create_directories(scriptDir, ec);
+            fs::path setup_path = fs::absolute(fs::path(scriptDir) / "gcpkg_cgroup_setup.sh");
+            fs::path enter_path = fs::absolute(fs::path(scriptDir) / "gcpkg_cgroup_enter.sh");
+            if (!WriteScript(setup_path, kSetupScript) || !WriteScript(enter_path, kEnterScript)) {
+                std::cerr << "警告: 无法写入 cgroup 辅助脚本，构建将不使用独立的资源限制。" << std::endl;
+                return "";
+            }
+
+            std::string output;
+            if (!CommandExecutor::executeCommandWithOutput(
+                    "docker exec " + containerName + " sh " + setup_path.string() + " 2>&1", output)) {
+                std::cerr << "警告: 无法在容器内启用 cgroup 委派，构建将不使用独立的资源限制。" << output
+                          << std::endl;
+                return "";
+            }
+
+            // 开启控制器后确认 docker exec 仍然可以进入容器
+            if (!CommandExecutor::executeCommandWithOutput("docker exec " + containerName + " true 2>&1", output)) {
+                std::cerr << "警告: 启用 cgroup 委派后无法进入容器，正在尝试回滚。" << std::endl;
+                CommandExecutor::executeCommand(
+                    "docker exec " + containerName +
+                    " sh -c \"echo '-cpu -memory' > /sys/fs/cgroup/cgroup.subtree_control\"");
+                return "";
+            }
+
+            std::cout << "--- Per-build cgroup limits enabled in container '" << containerName << "' ---" << std::endl;
+            return enter_path.string();
+        }
+
+        std::string CgroupEnterPrefix(const std::string& scriptPath,
+                                      const std::string& cgroupName,
+                                      uint64_t memoryBytes,
+                                      double cpus) {
+            if (scriptPath.empty() || (memoryBytes == 0 && cpus <= 0)) {
+                return "";
+            }
+
+            int64_t cpu_quota = cpus > 0 ? static_cast<int64_t>(cpus * kCpuPeriodMicros) : 0;
+
+            return ". " + scriptPath + " " + SafeCgroupName(cgroupName) + " " + std::to_string(memoryBytes) + " " +
+                   std::to_string(cpu_quota) + "; ";
+        }
+
+        std::string BuildCgroupPath(const std::string& cgroupName) {
+            return "gcpkg/" + SafeCgroupName(cgroupName);
+        }
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        /**
+         * @brief 在会话容器内启用 cgroup v2 委派，使每个构建可以拥有独立的资源限制。
+         *
+         * 容器需要以 --cgroupns=private 和 SYS_ADMIN 能力启动。该函数会在 scriptDir 中
+         * 写入进入 cgroup 的辅助脚本 (scriptDir 必须挂载到容器内的相同路径)，然后在容器内
+         * 把已有进程移入 init 子组并为 gcpkg 子树开启 cpu/memory 控制器。
+         *
+         * @param containerName 会话容器名称。
+         * @param scriptDir 存放辅助脚本的宿主机目录。
+         * @return 辅助脚本的路径；委派失败时返回空字符串，此时构建将不带独立限制运行。
+         */
+        std::string EnableCgroupDelegation(const std::string& containerName, const std::string& scriptDir);
+
+        /**
+         * @brief 生成让后续命令进入指定 cgroup 的命令前缀。
+         *
+         * 前缀形如 ". <script> <name> <memory> <quota>; "，不含引号和 '$'，
+         * 可以安全地拼接进 ExecuteInContainer 的 bash -c "..." 中。
+         *
+         * @param scriptPath EnableCgroupDelegation 返回的脚本路径。
+         * @param cgroupName 子 cgroup 名称 (会被规范化为只含字母、数字、'-' 和 '_')。
+         * @param memoryBytes 内存上限，0 表示不限制。
+         * @param cpus CPU 配额 (核数)，0 表示不限制。
+         */
+        std::string CgroupEnterPrefix(const std::string& scriptPath,
+                                      const std::string& cgroupName,
+                                      uint64_t memoryBytes,
+                                      double cpus);
+
+        /**
+         * @brief CgroupEnterPrefix 创建的子 cgroup 相对于容器 cgroup 根的路径，例如 "gcpkg/zlib_1_3"。
+         *
+         * 与 ChildCgroup 一起使用，可以在宿主机上单独读取某个构建的资源消耗。
+         */
+        std::string BuildCgroupPath(const std::string& cgroupName);
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
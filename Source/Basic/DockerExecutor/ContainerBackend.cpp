@@ -0,0 +1,19 @@
+#include "Basic/DockerExecutor/ContainerBackend.h"
+
+#include <atomic>
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        static std::atomic<ContainerBackend*> g_backend{nullptr};
+
+        void SetContainerBackend(ContainerBackend* backend) {
+            g_backend.store(backend, std::memory_order_release);
+        }
+
+        ContainerBackend* GetContainerBackend() {
+            return g_backend.load(std::memory_order_acquire);
+        }
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
\ No newline at end of file
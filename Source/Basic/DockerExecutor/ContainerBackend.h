@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        /**
+         * @brief 会话容器操作的另一种实现。
+         *
+         * 默认情况下 RunContainer、IsContainerRunning、RemoveContainer 和 ExecuteInContainer 直接调用 docker；
+         * 安装了后端之后改为调用后端，例如基准测试用只记录命令的假执行器衡量 gcpkg 自身的开销。
+         * 使用后端时容器没有 cgroup，ResolveContainerCgroup 总是返回无效结果。
+         */
+        class ContainerBackend {
+          public:
+            virtual ~ContainerBackend() = default;
+
+            // 对应 docker run <options...>
+            virtual bool Run(const std::vector<std::string>& options) = 0;
+            virtual bool IsRunning(const std::string& containerName) = 0;
+            // 对应 docker rm -f
+            virtual void Remove(const std::string& containerName) = 0;
+            // 在容器内执行命令，可能被并行构建的多个线程同时调用
+            virtual SystemIntegrate::CommandExecutor::CommandStatus Execute(
+                const std::string& containerName,
+                const std::string& workDir,
+                const std::string& command,
+                const SystemIntegrate::CommandExecutor::CommandLimits& limits) = 0;
+        };
+
+        // 安装容器后端，传入 nullptr 恢复为 docker；只能在没有会话运行时调用
+        void SetContainerBackend(ContainerBackend* backend);
+
+        // 当前安装的容器后端；使用 docker 时返回 nullptr
+        ContainerBackend* GetContainerBackend();
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "Basic/DockerExecutor/ContainerStats.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "Basic/DockerExecutor/ContainerBackend.h"
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
+namespace fs = std::filesystem;
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        static constexpr auto kSampleInterval = std::chrono::milliseconds(200);
+
+        static void UpdateMax(std::atomic<uint64_t>& target, uint64_t value) {
+            uint64_t current = target.load();
+            while (value > current && !target.compare_exchange_weak(current, value)) {
+            }
+        }
+
+        static bool ReadCpuUsage(const ContainerCgroup& cgroup, ResourceUsage& usage) {
+            std::ifstream file(cgroup.cpu_usage_file);
+            if (!file.is_open()) return false;
+
+            if (cgroup.is_v2) {
+                // cpu.stat 的格式为多行 "key value"
+                std::string key;
+                uint64_t value;
+                bool found = false;
+                while (file >> key >> value) {
+                    if (key == "usage_usec") {
+                        usage.cpu_seconds = static_cast<double>(value) / 1e6;
+                        found = true;
+                    } else if (key == "user_usec") {
+                        usage.user_cpu_seconds = static_cast<double>(value) / 1e6;
+                    } else if (key == "system_usec") {
+                        usage.system_cpu_seconds = static_cast<double>(value) / 1e6;
+                    }
+                }
+                return found;
+            }
+
+            // cpuacct.usage 以纳秒为单位；同目录的 cpuacct.stat 以时钟滴答记录用户态和内核态时间
+            uint64_t nanoseconds;
+            if (!(file >> nanoseconds)) return false;
+            usage.cpu_seconds = static_cast<double>(nanoseconds) / 1e9;
+
+            std::ifstream stat_file(fs::path(cgroup.cpu_usage_file).parent_path() / "cpuacct.stat");
+            const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+            std::string key;
+            uint64_t ticks;
+            while (ticks_per_second > 0 && stat_file >> key >> ticks) {
+                if (key == "user") usage.user_cpu_seconds = static_cast<double>(ticks) / ticks_per_second;
+                if (key == "system") usage.system_cpu_seconds = static_cast<double>(ticks) / ticks_per_second;
+            }
+            return true;
+        }
+
+        static void ReadIoBytes(const ContainerCgroup& cgroup, ResourceUsage& usage) {
+            if (cgroup.io_usage_file.empty()) return;
+            std::ifstream file(cgroup.io_usage_file);
+            std::string line;
+            while (std::getline(file, line)) {
+                std::istringstream fields(line);
+                std::string device, field;
+                fields >> device;
+
+                if (cgroup.is_v2) {
+                    // io.stat: "<major>:<minor> rbytes=N wbytes=N rios=N ..."，按设备累加
+                    while (fields >> field) {
+                        if (field.rfind("rbytes=", 0) == 0) usage.read_bytes += std::stoull(field.substr(7));
+                        if (field.rfind("wbytes=", 0) == 0) usage.write_bytes += std::stoull(field.substr(7));
+                    }
+                    continue;
+                }
+
+                // blkio.throttle.io_service_bytes: "<major>:<minor> Read N"，最后一行 "Total N" 不属于任何设备
+                uint64_t value;
+                if (!(fields >> field >> value)) continue;
+                if (field == "Read") usage.read_bytes += value;
+                if (field == "Write") usage.write_bytes += value;
+            }
+        }
+
+        static bool ReadMemoryBytes(const ContainerCgroup& cgroup, uint64_t& bytes) {
+            std::ifstream file(cgroup.memory_usage_file);
+            return file.is_open() && static_cast<bool>(file >> bytes);
+        }
+
+        // 读取 cgroup 的累计 CPU 与 I/O 计数；统计文件不存在时返回全零
+        static ResourceUsage ReadCounters(const ContainerCgroup& cgroup) {
+            ResourceUsage usage;
+            if (!ReadCpuUsage(cgroup, usage)) return ResourceUsage{};
+            ReadIoBytes(cgroup, usage);
+            return usage;
+        }
+
+        ContainerCgroup ResolveContainerCgroup(const std::string& containerName) {
+            ContainerCgroup cgroup;
+            if (GetContainerBackend()) return cgroup;  // 替换的后端没有 docker 容器
+
+            std::string container_id;
+            if (!SystemIntegrate::CommandExecutor::executeCommandWithOutput(
+                    "docker inspect -f '{{.Id}}' " + containerName + " 2>/dev/null", container_id)) {
+                return cgroup;
+            }
+            std::istringstream(container_id) >> container_id;
+            if (container_id.empty()) return cgroup;
+
+            const fs::path root = "/sys/fs/cgroup";
+
+            // cgroup v2：统一层级
+            for (const fs::path& dir : {root / "system.slice" / ("docker-" + container_id + ".scope"),
+                                        root / "docker" / container_id}) {
+                if (fs::exists(dir / "cpu.stat") && fs::exists(dir / "memory.current")) {
+                    cgroup.cpu_usage_file = (dir / "cpu.stat").string();
+                    cgroup.memory_usage_file = (dir / "memory.current").string();
+                    if (fs::exists(dir / "io.stat")) cgroup.io_usage_file = (dir / "io.stat").string();
+                    cgroup.is_v2 = true;
+                    return cgroup;
+                }
+            }
+
+            // cgroup v1：CPU 与内存位于不同层级
+            for (const fs::path& suffix : {fs::path("system.slice") / ("docker-" + container_id + ".scope"),
+                                           fs::path("docker") / container_id}) {
+                fs::path cpu_file = root / "cpuacct" / suffix / "cpuacct.usage";
+                fs::path memory_file = root / "memory" / suffix / "memory.usage_in_bytes";
+                fs::path io_file = root / "blkio" / suffix / "blkio.throttle.io_service_bytes";
+                if (fs::exists(cpu_file) && fs::exists(memory_file)) {
+                    cgroup.cpu_usage_file = cpu_file.string();
+                    cgroup.memory_usage_file = memory_file.string();
+                    if (fs::exists(io_file)) cgroup.io_usage_file = io_file.string();
+                    cgroup.is_v2 = false;
+                    return cgroup;
+                }
+            }
+
+            return cgroup;
+        }
+
+        ContainerCgroup ChildCgroup(const ContainerCgroup& parent, const std::string& relative) {
+            ContainerCgroup child;
+            if (!parent.valid() || !parent.is_v2) return child;
+
+            const fs::path dir = fs::path(parent.cpu_usage_file).parent_path() / relative;
+            child.cpu_usage_file = (dir / "cpu.stat").string();
+            child.memory_usage_file = (dir / "memory.current").string();
+            child.io_usage_file = (dir / "io.stat").string();
+            child.is_v2 = true;
+            return child;
+        }
+
+        uint64_t ReadOomKills(const ContainerCgroup& cgroup) {
+            if (cgroup.memory_usage_file.empty()) return 0;
+            const fs::path dir = fs::path(cgroup.memory_usage_file).parent_path();
+            std::ifstream file(dir / (cgroup.is_v2 ? "memory.events" : "memory.oom_control"));
+            // 两种格式都是多行 "key value"
+            std::string key;
+            uint64_t value;
+            while (file >> key >> value) {
+                if (key == "oom_kill") return value;
+            }
+            return 0;
+        }
+
+        ResourceUsage CurrentThreadUsage() {
+            ResourceUsage usage;
+            struct rusage ru{};
+            if (getrusage(RUSAGE_THREAD, &ru) != 0) return usage;
+
+            auto seconds = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) + tv.tv_usec / 1e6; };
+            usage.user_cpu_seconds = seconds(ru.ru_utime);
+            usage.system_cpu_seconds = seconds(ru.ru_stime);
+            usage.cpu_seconds = usage.user_cpu_seconds + usage.system_cpu_seconds;
+            usage.peak_memory_bytes = static_cast<uint64_t>(ru.ru_maxrss) * 1024;  // ru_maxrss 以 KiB 为单位
+            usage.read_bytes = static_cast<uint64_t>(ru.ru_inblock) * 512;        // 以 512 字节的块为单位
+            usage.write_bytes = static_cast<uint64_t>(ru.ru_oublock) * 512;
+            return usage;
+        }
+
+        ResourceUsage UsageBetween(const ResourceUsage& start, const ResourceUsage& end) {
+            // 计数在两次读数之间被重置 (例如 cgroup 被重建) 时按 0 处理
+            auto delta = [](auto from, auto to) { return to > from ? to - from : decltype(to){}; };
+            ResourceUsage usage;
+            usage.cpu_seconds = delta(start.cpu_seconds, end.cpu_seconds);
+            usage.user_cpu_seconds = delta(start.user_cpu_seconds, end.user_cpu_seconds);
+            usage.system_cpu_seconds = delta(start.system_cpu_seconds, end.system_cpu_seconds);
+            usage.read_bytes = delta(start.read_bytes, end.read_bytes);
+            usage.write_bytes = delta(start.write_bytes, end.write_bytes);
+            usage.peak_memory_bytes = end.peak_memory_bytes;
+            return usage;
+        }
+
+        ResourceSampler::ResourceSampler(ContainerCgroup cgroup) : cgroup_(std::move(cgroup)) {
+            if (!cgroup_.valid()) {
+                return;
+            }
+            // 子 cgroup 可能在第一条命令执行时才被创建，此时基线为 0
+            start_ = ReadCounters(cgroup_);
+            lap_start_ = start_;
+            running_ = true;
+            sampler_ = std::thread([this] {
+                while (running_) {
+                    uint64_t bytes = 0;
+                    if (ReadMemoryBytes(cgroup_, bytes)) {
+                        UpdateMax(peak_memory_, bytes);
+                        UpdateMax(lap_peak_memory_, bytes);
+                    }
+                    std::this_thread::sleep_for(kSampleInterval);
+                }
+            });
+        }
+
+        ResourceSampler::~ResourceSampler() {
+            Stop();
+        }
+
+        ResourceUsage ResourceSampler::Lap() {
+            if (!running_) {
+                return ResourceUsage{};
+            }
+            ResourceUsage now = ReadCounters(cgroup_);
+            uint64_t bytes = 0;
+            ReadMemoryBytes(cgroup_, bytes);
+            UpdateMax(peak_memory_, bytes);
+            // 下一段从当前的内存占用重新开始计算峰值
+            now.peak_memory_bytes = std::max(lap_peak_memory_.exchange(bytes), bytes);
+
+            ResourceUsage usage = UsageBetween(lap_start_, now);
+            lap_start_ = now;
+            return usage;
+        }
+
+        ResourceUsage ResourceSampler::Stop() {
+            if (!running_.exchange(false)) {
+                return ResourceUsage{};
+            }
+            sampler_.join();
+
+            ResourceUsage now = ReadCounters(cgroup_);
+            uint64_t bytes = 0;
+            if (ReadMemoryBytes(cgroup_, bytes)) {
+                UpdateMax(peak_memory_, bytes);
+            }
+            now.peak_memory_bytes = peak_memory_;
+            return UsageBetween(start_, now);
+        }
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
\ No newline at end of file
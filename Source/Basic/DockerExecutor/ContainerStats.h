@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace Basic {
+    namespace DockerExecutor {
+
+        // 一段时间内容器的资源消耗
+        struct ResourceUsage {
+            double cpu_seconds = 0.0;         // 用户态 + 内核态 CPU 时间
+            double user_cpu_seconds = 0.0;    // 用户态 CPU 时间
+            double system_cpu_seconds = 0.0;  // 内核态 CPU 时间
+            uint64_t peak_memory_bytes = 0;   // 采样期间观察到的最大内存占用
+            uint64_t read_bytes = 0;          // 从块设备读取的字节数
+            uint64_t write_bytes = 0;         // 写入块设备的字节数
+        };
+
+        // 容器在宿主机上对应的 cgroup 统计文件
+        struct ContainerCgroup {
+            std::string cpu_usage_file;     // v2: cpu.stat, v1: cpuacct.usage
+            std::string memory_usage_file;  // v2: memory.current, v1: memory.usage_in_bytes
+            std::string io_usage_file;      // v2: io.stat, v1: blkio.throttle.io_service_bytes；可以为空
+            bool is_v2 = true;
+
+            bool valid() const {
+                return !cpu_usage_file.empty() && !memory_usage_file.empty();
+            }
+        };
+
+        /**
+         * @brief 查找运行中容器在宿主机上的 cgroup 统计文件。
+         *
+         * 同时支持 cgroup v2 (systemd / cgroupfs 驱动) 与 cgroup v1 的常见布局。
+         *
+         * @param containerName 容器名称或 ID。
+         * @return 找到的 cgroup 文件；找不到时 valid() 为 false。
+         */
+        ContainerCgroup ResolveContainerCgroup(const std::string& containerName);
+
+        /**
+         * @brief 容器 cgroup 之下某个子 cgroup 的统计文件。
+         *
+         * 只支持 cgroup v2；子组可以尚不存在 (例如第一条命令才会创建它)，采样器会把缺失的计数视为 0。
+         *
+         * @param parent ResolveContainerCgroup 的结果。
+         * @param relative 相对于容器 cgroup 根的路径，例如 "gcpkg/zlib_1_3"。
+         * @return 子组的统计文件；parent 无效或不是 v2 时 valid() 为 false。
+         */
+        ContainerCgroup ChildCgroup(const ContainerCgroup& parent, const std::string& relative);
+
+        /**
+         * @brief 读取 cgroup 中被 OOM killer 终止的进程数 (v2: memory.events，v1: memory.oom_control 的 oom_kill)。
+         *
+         * 统计文件不存在 (子组尚未创建或内核不提供该计数) 时返回 0。
+         */
+        uint64_t ReadOomKills(const ContainerCgroup& cgroup);
+
+        /**
+         * @brief 读取调用线程自启动以来的累计资源消耗 (getrusage RUSAGE_THREAD)。
+         *
+         * 用于在 gcpkg 进程内直接执行的元命令；peak_memory_bytes 为整个进程的常驻内存峰值。
+         */
+        ResourceUsage CurrentThreadUsage();
+
+        // 两次累计读数之间的消耗；峰值取 end 的值
+        ResourceUsage UsageBetween(const ResourceUsage& start, const ResourceUsage& end);
+
+        /**
+         * @brief 在一段代码执行期间采样容器的 CPU、内存与块设备 I/O。
+         *
+         * 构造时记录 CPU 和 I/O 计数的基线并启动后台线程周期性读取内存占用，
+         * Stop() 返回期间的增量和内存峰值。Lap() 返回自上一次 Lap() (或构造) 以来的增量和峰值，
+         * 用于在同一个步骤内分别统计每条命令。cgroup 无效时返回全零。
+         */
+        class ResourceSampler {
+          public:
+            explicit ResourceSampler(ContainerCgroup cgroup);
+            ~ResourceSampler();
+
+            ResourceSampler(const ResourceSampler&) = delete;
+            ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+            ResourceUsage Lap();
+            ResourceUsage Stop();
+
+          private:
+            ContainerCgroup cgroup_;
+            ResourceUsage start_;
+            ResourceUsage lap_start_;
+            std::atomic<uint64_t> peak_memory_{0};
+            std::atomic<uint64_t> lap_peak_memory_{0};
+            std::atomic<bool> running_{false};
+            std::thread sampler_;
+        };
+
+    }  // namespace DockerExecutor
+}  // namespace Basic
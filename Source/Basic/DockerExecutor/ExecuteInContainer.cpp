@@ -1,12 +1,22 @@
 #include "Basic/DockerExecutor/ExecuteInContainer.h"
 
+#include <unistd.h>
+
+#include <atomic>
 #include <sstream>
 
+#include "Basic/DockerExecutor/ContainerBackend.h"
+#include "Basic/Metrics/Metrics.h"
 #include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"  // 假设 executeCommand 在此
 namespace Basic {
     namespace DockerExecutor {
 
         bool ExecuteInContainer(std::string containerName, std::string workDir, std::string command) {
+            if (ContainerBackend* backend = GetContainerBackend()) {
+                return backend->Execute(containerName, workDir, command, {}) ==
+                       SystemIntegrate::CommandExecutor::CommandStatus::Success;
+            }
+
             std::stringstream cmd_stream;
             // 使用 -w 设置工作目录，并用 bash -c 来正确处理复杂的 shell 命令
             cmd_stream << "docker exec -w " << workDir << " " << containerName << " bash -c \"" << command << "\"";
@@ -16,5 +26,50 @@ namespace Basic {
             return Basic::SystemIntegrate::CommandExecutor::executeCommand(cmd);
         }
 
+        SystemIntegrate::CommandExecutor::CommandStatus ExecuteInContainer(
+            const std::string& containerName,
+            const std::string& workDir,
+            const std::string& command,
+            const SystemIntegrate::CommandExecutor::CommandLimits& limits) {
+            static Metrics::Histogram& latency = Metrics::GetHistogram(
+                "gcpkg_container_exec_duration_seconds", "Wall time of build commands run in the session container.");
+            static Metrics::Counter& failures = Metrics::GetCounter(
+                "gcpkg_container_exec_failures_total", "Build commands that failed, timed out or were cancelled.");
+            Metrics::ScopedTimer timer(latency);
+
+            if (ContainerBackend* backend = GetContainerBackend()) {
+                auto status = backend->Execute(containerName, workDir, command, limits);
+                if (status != SystemIntegrate::CommandExecutor::CommandStatus::Success) failures.Add();
+                return status;
+            }
+
+            // 容器内记录进程组 ID 的文件，每条命令唯一
+            static std::atomic<uint64_t> next_id{0};
+            const std::string pgid_file =
+                "/tmp/gcpkg-exec-" + std::to_string(getpid()) + "-" + std::to_string(next_id++) + ".pgid";
+
+            // setsid 使 bash 成为新进程组的组长，$$ 即为容器内整个进程树的进程组 ID
+            std::stringstream cmd_stream;
+            cmd_stream << "docker exec -w " << workDir << " " << containerName << " setsid -w bash -c \""
+                       << "echo \\$\\$ > " << pgid_file << "; trap 'rm -f " << pgid_file << "' EXIT; "
+                       << "exec < /dev/null; " << command << "\"";
+
+            const std::string kill_script = "pg=$(cat " + pgid_file + " 2>/dev/null) && [ -n \"$pg\" ] && "
+                                            "{ kill -TERM -- -$pg; sleep 2; kill -KILL -- -$pg; } 2>/dev/null; "
+                                            "rm -f " + pgid_file;
+
+            SystemIntegrate::CommandExecutor::CommandLimits container_limits = limits;
+            container_limits.on_abort = [&] {
+                SystemIntegrate::CommandExecutor::executeCommand("docker exec " + containerName + " sh -c '" +
+                                                                 kill_script + "'");
+                if (limits.on_abort) limits.on_abort();
+            };
+
+            auto status =
+                SystemIntegrate::CommandExecutor::executeCommandWithLimits(cmd_stream.str(), container_limits);
+            if (status != SystemIntegrate::CommandExecutor::CommandStatus::Success) failures.Add();
+            return status;
+        }
+
     }  // namespace DockerExecutor
 }  // namespace Basic
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
 namespace Basic {
     namespace DockerExecutor {
 
@@ -14,5 +17,21 @@ namespace Basic {
          */
         bool ExecuteInContainer(std::string containerName, std::string workDir, std::string command);
 
+        /**
+         * @brief 带超时和取消的 ExecuteInContainer。
+         *
+         * 命令在容器内通过 setsid 运行在独立的会话中，标准输入重定向自 /dev/null。
+         * 超时或被取消时，先通过 docker exec 终止容器内的整个进程组，再终止本地的 docker exec 客户端；
+         * 只杀掉客户端并不会停止容器内的进程。
+         *
+         * @param limits 超时时间和取消令牌。
+         * @return 命令的执行结果。
+         */
+        SystemIntegrate::CommandExecutor::CommandStatus ExecuteInContainer(
+            const std::string& containerName,
+            const std::string& workDir,
+            const std::string& command,
+            const SystemIntegrate::CommandExecutor::CommandLimits& limits);
+
     }  // namespace DockerExecutor
 }  // namespace Basic
\ No newline at end of file
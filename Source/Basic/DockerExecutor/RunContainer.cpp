@@ -3,9 +3,15 @@
 #include <cstdlib>   // for system()
 #include <iostream>  // for std::cout, std::cerr
 #include <sstream>   // for std::stringstream
+
+#include "Basic/DockerExecutor/ContainerBackend.h"
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
 namespace Basic {
     namespace DockerExecutor {
         bool RunContainer(const std::vector<std::string>& options) {
+            if (ContainerBackend* backend = GetContainerBackend()) return backend->Run(options);
+
             // 1. 使用 stringstream 来安全、高效地构建命令
             std::stringstream command_stream;
             command_stream << "docker run";
@@ -34,5 +40,24 @@ namespace Basic {
             return true;
         }
 
+        bool IsContainerRunning(const std::string& containerName) {
+            if (ContainerBackend* backend = GetContainerBackend()) return backend->IsRunning(containerName);
+
+            std::string output;
+            if (!SystemIntegrate::CommandExecutor::executeCommandWithOutput(
+                    "docker inspect -f '{{.State.Running}}' " + containerName + " 2>/dev/null", output)) {
+                return false;
+            }
+            return output.rfind("true", 0) == 0;
+        }
+
+        void RemoveContainer(const std::string& containerName) {
+            if (ContainerBackend* backend = GetContainerBackend()) {
+                backend->Remove(containerName);
+                return;
+            }
+            SystemIntegrate::CommandExecutor::executeCommand("docker rm -f " + containerName);
+        }
+
     }  // namespace DockerExecutor
 }  // namespace Basic
\ No newline at end of file
@@ -17,5 +17,20 @@ namespace Basic {
          */
         bool RunContainer(const std::vector<std::string>& options);
 
+        /**
+         * @brief 检查指定名称的容器是否存在且正在运行。
+         *
+         * @param containerName 容器名称或 ID。
+         * @return true 如果 docker inspect 报告容器处于运行状态。
+         */
+        bool IsContainerRunning(const std::string& containerName);
+
+        /**
+         * @brief 强制删除容器 (docker rm -f)，容器不存在时什么也不做。
+         *
+         * @param containerName 容器名称或 ID。
+         */
+        void RemoveContainer(const std::string& containerName);
+
     }  // namespace DockerExecutor
 }  // namespace Basic
\ No newline at end of file
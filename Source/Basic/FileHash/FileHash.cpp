@@ -0,0 +1,267 @@
+#include "Basic/FileHash/FileHash.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "Basic/FileHash/HashCache.h"
+
+namespace fs = std::filesystem;
+
+namespace Basic::FileHash {
+
+    namespace {
+        constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+        constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+        constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+        constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+        constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+        inline uint64_t Rotl(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline uint64_t Read64(const unsigned char* p) {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t Read32(const unsigned char* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t Round(uint64_t acc, uint64_t input) {
+            acc += input * kPrime2;
+            acc = Rotl(acc, 31);
+            return acc * kPrime1;
+        }
+
+        inline uint64_t MergeRound(uint64_t acc, uint64_t value) {
+            acc ^= Round(0, value);
+            return acc * kPrime1 + kPrime4;
+        }
+
+        std::string ToHex(uint64_t value) {
+            static const char kDigits[] = "0123456789abcdef";
+            std::string hex(16, '0');
+            for (int i = 15; i >= 0; --i) {
+                hex[i] = kDigits[value & 0xf];
+                value >>= 4;
+            }
+            return hex;
+        }
+
+        unsigned ResolveThreads(unsigned threads) {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            return threads == 0 ? 4 : threads;
+        }
+
+        // 读取 [offset, offset + size) 到 buffer；读到的字节数不足时返回 false
+        bool ReadFully(int fd, unsigned char* buffer, size_t size, uint64_t offset) {
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = pread(fd, buffer + done, size - done, static_cast<off_t>(offset + done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                done += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        // 计算单个已打开文件的树形摘要；threads 为 1 时在调用线程中完成
+        std::string HashOpenFile(int fd, uint64_t size, unsigned threads) {
+            const uint64_t chunk_count = size == 0 ? 1 : (size + kChunkSize - 1) / kChunkSize;
+            std::vector<uint64_t> leaves(chunk_count);
+            std::atomic<uint64_t> next{0};
+            std::atomic<bool> failed{false};
+
+            auto worker = [&] {
+                std::unique_ptr<unsigned char[]> buffer(new unsigned char[kChunkSize]);
+                for (uint64_t i = next++; i < chunk_count && !failed; i = next++) {
+                    const uint64_t offset = i * kChunkSize;
+                    const size_t length = static_cast<size_t>(std::min<uint64_t>(kChunkSize, size - offset));
+                    if (!ReadFully(fd, buffer.get(), length, offset)) {
+                        failed = true;
+                        return;
+                    }
+                    leaves[i] = Hash64(buffer.get(), length, i);
+                }
+            };
+
+            const unsigned worker_count = static_cast<unsigned>(std::min<uint64_t>(threads, chunk_count));
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < worker_count; ++t) pool.emplace_back(worker);
+            worker();
+            for (auto& thread : pool) thread.join();
+
+            if (failed) return "";
+            if (chunk_count == 1) return ToHex(leaves[0]);
+            return ToHex(Hash64(leaves.data(), leaves.size() * sizeof(uint64_t), size));
+        }
+
+        std::string HashFileWithThreads(const fs::path& path, unsigned threads) {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return "";
+            struct stat st {};
+            std::string hash;
+            if (fstat(fd, &st) == 0) {
+                hash = HashOpenFile(fd, static_cast<uint64_t>(st.st_size), threads);
+            }
+            close(fd);
+            return hash;
+        }
+
+        // 一个可被窃取的任务：遍历目录或计算文件摘要
+        struct WorkItem {
+            fs::path path;
+            bool is_directory = false;
+        };
+
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<WorkItem> items;
+        };
+    }  // namespace
+
+    uint64_t Hash64(const void* data, size_t size, uint64_t seed) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        const unsigned char* const end = p + size;
+        uint64_t hash;
+
+        if (size >= 32) {
+            uint64_t v1 = seed + kPrime1 + kPrime2;
+            uint64_t v2 = seed + kPrime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - kPrime1;
+            const unsigned char* const limit = end - 32;
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+            hash = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = seed + kPrime5;
+        }
+        hash += static_cast<uint64_t>(size);
+
+        for (; p + 8 <= end; p += 8) {
+            hash ^= Round(0, Read64(p));
+            hash = Rotl(hash, 27) * kPrime1 + kPrime4;
+        }
+        if (p + 4 <= end) {
+            hash ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+            hash = Rotl(hash, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            hash ^= (*p) * kPrime5;
+            hash = Rotl(hash, 11) * kPrime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    std::string HashFile(const fs::path& path, unsigned threads) {
+        return HashFileWithThreads(path, ResolveThreads(threads));
+    }
+
+    std::vector<TreeFileHash> HashTree(const fs::path& root, HashCache* cache, unsigned threads) {
+        const unsigned worker_count = ResolveThreads(threads);
+        std::vector<WorkQueue> queues(worker_count);
+        std::atomic<size_t> pending{1};  // 已入队但尚未完成的任务数
+        queues[0].items.push_back({root, true});
+
+        std::mutex results_mutex;
+        std::vector<TreeFileHash> results;
+
+        auto worker = [&](unsigned self) {
+            std::vector<TreeFileHash> local;
+            auto push = [&](WorkItem item) {
+                ++pending;
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                queues[self].items.push_back(std::move(item));
+            };
+
+            while (pending > 0) {
+                std::optional<WorkItem> item;
+                {
+                    std::lock_guard<std::mutex> lock(queues[self].mutex);
+                    if (!queues[self].items.empty()) {
+                        item = std::move(queues[self].items.back());
+                        queues[self].items.pop_back();
+                    }
+                }
+                for (unsigned i = 1; !item && i < worker_count; ++i) {
+                    WorkQueue& victim = queues[(self + i) % worker_count];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.items.empty()) {
+                        item = std::move(victim.items.front());
+                        victim.items.pop_front();
+                    }
+                }
+                if (!item) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if (item->is_directory) {
+                    std::error_code ec;
+                    for (const auto& entry : fs::directory_iterator(item->path, ec)) {
+                        std::error_code entry_ec;
+                        if (entry.is_symlink(entry_ec)) continue;
+                        if (entry.is_directory(entry_ec)) {
+                            push({entry.path(), true});
+                        } else if (entry.is_regular_file(entry_ec)) {
+                            push({entry.path(), false});
+                        }
+                    }
+                } else {
+                    // 树中的文件已经并行处理，单个文件在本线程内计算
+                    auto compute = [](const fs::path& path) { return HashFileWithThreads(path, 1); };
+                    std::string hash = cache ? cache->Get(item->path, "xxh64-tree", compute) : compute(item->path);
+                    if (!hash.empty()) local.push_back({item->path.lexically_relative(root), std::move(hash)});
+                }
+                --pending;
+            }
+
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results.insert(results.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < worker_count; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto& thread : pool) thread.join();
+
+        std::sort(results.begin(), results.end(), [](const TreeFileHash& a, const TreeFileHash& b) {
+            return a.relative_path < b.relative_path;
+        });
+        return results;
+    }
+
+}  // namespace Basic::FileHash
\ No newline at end of file
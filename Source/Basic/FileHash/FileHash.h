@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Basic::FileHash {
+
+    class HashCache;
+
+    // 树形摘要的叶子块大小；小于等于该大小的文件只有一个叶子
+    inline constexpr size_t kChunkSize = 1 << 20;
+
+    /**
+     * @brief 计算一段数据的 64 位 XXH64 摘要。
+     *
+     * 每次处理 32 字节，分成 4 条相互独立的累加链，编译器可以把它们放进 SIMD 寄存器并行计算。
+     * 不具备密码学强度，只用于内容标识和去重。
+     */
+    uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0);
+
+    /**
+     * @brief 计算文件的树形摘要，以 16 位十六进制字符串返回。
+     *
+     * 文件按 kChunkSize 分块，第 i 块的摘要为 Hash64(块, i)，根摘要为 Hash64(所有叶子摘要, 文件大小)；
+     * 只有一块的文件直接使用该块的摘要。摘要与线程数无关，大文件的各块用 pread 并行读取和计算。
+     *
+     * @param path 要读取的文件。
+     * @param threads 使用的线程数，0 表示使用硬件线程数。
+     * @return 十六进制摘要；文件无法读取时返回空字符串。
+     */
+    std::string HashFile(const std::filesystem::path& path, unsigned threads = 0);
+
+    // 目录树中一个普通文件的摘要
+    struct TreeFileHash {
+        std::filesystem::path relative_path;
+        std::string hash;
+    };
+
+    /**
+     * @brief 并行计算目录树中所有普通文件 (不含符号链接) 的摘要。
+     *
+     * 每个线程有自己的工作队列，目录和文件都是可窃取的任务：线程从自己队列的尾部取任务，
+     * 空闲时从其他线程队列的头部窃取，因此单个很大的目录也能被多个线程分摊。
+     *
+     * @param root 目录树的根。
+     * @param cache 不为空时先查询缓存，未变化的文件不会被重新读取。
+     * @param threads 使用的线程数，0 表示使用硬件线程数。
+     * @return 按相对路径排序的摘要列表。
+     */
+    std::vector<TreeFileHash> HashTree(const std::filesystem::path& root,
+                                       HashCache* cache = nullptr,
+                                       unsigned threads = 0);
+
+}  // namespace Basic::FileHash
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Basic/FileHash/HashCache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
+
+namespace fs = std::filesystem;
+
+namespace Basic::FileHash {
+
+    // 修改时间距今不足该值的文件不写入缓存
+    static constexpr int64_t kRacyWindowNs = 2'000'000'000;
+
+    static int64_t MtimeNs(const struct stat& st) {
+        return static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    }
+
+    HashCache::HashCache(fs::path cache_file) : cache_file_(std::move(cache_file)) {}
+
+    void HashCache::Load() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        dirty_ = false;
+
+        std::ifstream file(cache_file_);
+        std::string line;
+        // 每行: <算法>\t<设备>\t<inode>\t<mtime>\t<大小>\t<摘要>\t<路径>
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string algorithm, hash, path;
+            Entry entry;
+            if (!std::getline(fields, algorithm, '\t') || !(fields >> entry.device >> entry.inode >> entry.mtime_ns >>
+                                                            entry.size >> hash)) {
+                continue;
+            }
+            fields.get();  // 路径前的制表符
+            if (!std::getline(fields, path) || path.empty()) continue;
+            entry.hash = std::move(hash);
+            entries_[algorithm + "\t" + path] = std::move(entry);
+        }
+    }
+
+    bool HashCache::Save() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_) return true;
+
+        std::error_code ec;
+        fs::create_directories(cache_file_.parent_path(), ec);
+        fs::path temp_path = cache_file_;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path, std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入文件摘要缓存 " << temp_path << std::endl;
+                return false;
+            }
+            for (auto it = entries_.begin(); it != entries_.end();) {
+                const size_t tab = it->first.find('\t');
+                struct stat st {};
+                if (stat(it->first.c_str() + tab + 1, &st) != 0) {
+                    it = entries_.erase(it);
+                    continue;
+                }
+                const Entry& entry = it->second;
+                file << it->first.substr(0, tab) << '\t' << entry.device << '\t' << entry.inode << '\t'
+                     << entry.mtime_ns << '\t' << entry.size << '\t' << entry.hash << '\t'
+                     << it->first.substr(tab + 1) << '\n';
+                ++it;
+            }
+        }
+        fs::rename(temp_path, cache_file_, ec);
+        if (ec) return false;
+        dirty_ = false;
+        return true;
+    }
+
+    std::string HashCache::Get(const fs::path& path, const std::string& algorithm, const HashFunction& compute) {
+        const fs::path absolute = fs::absolute(path).lexically_normal();
+        struct stat st {};
+        if (stat(absolute.c_str(), &st) != 0) return compute(path);
+
+        static Basic::Metrics::Counter& hits = Basic::Metrics::CacheLookups("file_hash", true);
+        static Basic::Metrics::Counter& misses = Basic::Metrics::CacheLookups("file_hash", false);
+        const std::string key = algorithm + "\t" + absolute.string();
+        Basic::Trace::Span span("cache", "hash cache lookup");
+        span.Arg("path", absolute.string());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end() && it->second.device == static_cast<uint64_t>(st.st_dev) &&
+                it->second.inode == static_cast<uint64_t>(st.st_ino) && it->second.mtime_ns == MtimeNs(st) &&
+                it->second.size == static_cast<uint64_t>(st.st_size)) {
+                span.Arg("hit", 1);
+                hits.Add();
+                return it->second.hash;
+            }
+        }
+
+        // 计算摘要时不持有锁，其他线程可以同时查询和计算
+        span.Arg("hit", int64_t{0});
+        misses.Add();
+        std::string hash = compute(path);
+        const int64_t now_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        if (hash.empty() || now_ns - MtimeNs(st) < kRacyWindowNs) return hash;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key] = {static_cast<uint64_t>(st.st_dev),
+                         static_cast<uint64_t>(st.st_ino),
+                         MtimeNs(st),
+                         static_cast<uint64_t>(st.st_size),
+                         hash};
+        dirty_ = true;
+        return hash;
+    }
+
+}  // namespace Basic::FileHash
\ No newline at end of file
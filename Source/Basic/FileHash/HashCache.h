@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Basic::FileHash {
+
+    /**
+     * @brief 持久化的文件摘要缓存：(路径, inode, mtime, 大小) -> 摘要。
+     *
+     * 文件的 inode、mtime 和大小都未变化时直接返回记录的摘要，不再读取文件内容。
+     * 同一个文件可以按不同的算法分别缓存。最近 2 秒内修改过的文件不写入缓存，
+     * 避免在同一个 mtime 刻度内再次被修改的文件命中过期的记录。所有方法都是线程安全的。
+     */
+    class HashCache {
+      public:
+        using HashFunction = std::function<std::string(const std::filesystem::path&)>;
+
+        explicit HashCache(std::filesystem::path cache_file);
+
+        void Load();
+        // 没有新记录时不写文件；已不存在的文件的记录会被丢弃
+        bool Save();
+
+        /**
+         * @brief 返回文件的摘要；缓存未命中时调用 compute 计算并记录。
+         *
+         * @param algorithm 算法名，用于区分同一文件的不同摘要。
+         * @return 摘要；文件无法读取时返回 compute 的结果 (通常为空字符串)。
+         */
+        std::string Get(const std::filesystem::path& path, const std::string& algorithm, const HashFunction& compute);
+
+      private:
+        struct Entry {
+            uint64_t device = 0;
+            uint64_t inode = 0;
+            int64_t mtime_ns = 0;
+            uint64_t size = 0;
+            std::string hash;
+        };
+
+        std::filesystem::path cache_file_;
+        std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;  // "<算法>\t<绝对路径>" -> 记录
+        bool dirty_ = false;
+    };
+
+}  // namespace Basic::FileHash
\ No newline at end of file
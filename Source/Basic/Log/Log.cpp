@@ -0,0 +1,430 @@
+#include "Basic/Log/Log.h"
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Basic::Log {
+
+    namespace detail {
+        // 一个包的日志目标；文件只由后台线程打开、写入和关闭
+        struct Sink {
+            std::string label;
+            fs::path path;
+            std::ofstream file;
+            std::string last_line;
+            std::chrono::steady_clock::time_point start;
+        };
+    }  // namespace detail
+
+    namespace {
+        using detail::Sink;
+
+        // 没有新行时刷新进度视图的间隔
+        constexpr auto kRefreshInterval = std::chrono::milliseconds(500);
+        // 进度视图两次重绘之间的最短间隔；包开始、结束或有内容输出到终端时立即重绘
+        constexpr auto kMinRedrawInterval = std::chrono::milliseconds(100);
+
+        enum class Kind { Out, Err, Begin, End, Fence };
+
+        struct Record {
+            Kind kind = Kind::Out;
+            std::shared_ptr<Sink> sink;
+            std::string text;
+            std::shared_ptr<std::promise<void>> fence = nullptr;  // Kind::Fence：处理到该记录时兑现
+        };
+
+        /**
+         * 无锁的多生产者单消费者队列 (Vyukov)。
+         * 生产者只做一次原子交换和一次存储；head_ 指向最后入队的节点，tail_ 是消费者持有的哨兵节点。
+         */
+        class RecordQueue {
+          public:
+            RecordQueue() : head_(new Node), tail_(head_.load()) {
+            }
+            ~RecordQueue() {
+                Record record;
+                while (Pop(record)) {
+                }
+                delete tail_;
+            }
+
+            void Push(Record record) {
+                Node* node = new Node;
+                node->record = std::move(record);
+                Node* previous = head_.exchange(node, std::memory_order_seq_cst);
+                previous->next.store(node, std::memory_order_release);
+            }
+
+            // 只能由消费者线程调用；生产者交换了 head_ 但还没链接时暂时返回 false
+            bool Pop(Record& record) {
+                Node* next = tail_->next.load(std::memory_order_acquire);
+                if (!next) return false;
+                record = std::move(next->record);
+                delete tail_;
+                tail_ = next;
+                return true;
+            }
+
+            bool Empty() const {
+                return head_.load(std::memory_order_seq_cst) == tail_;
+            }
+
+          private:
+            struct Node {
+                std::atomic<Node*> next{nullptr};
+                Record record;
+            };
+
+            std::atomic<Node*> head_;
+            Node* tail_;
+        };
+
+        thread_local std::shared_ptr<Sink> t_sink;
+
+        class Logger;
+        std::atomic<Logger*> g_logger{nullptr};
+
+        /**
+         * 替换 std::cout / std::cerr 的缓冲区。不使用 put 区域，每次写入都进入 overflow/xsputn，
+         * 字符先积累在线程局部的缓冲中，遇到换行或 sync (std::endl / flush) 时作为一条记录入队，
+         * 因此多个线程同时写同一个流也不会交错。
+         */
+        class LineBuffer : public std::streambuf {
+          public:
+            explicit LineBuffer(Kind kind) : kind_(kind) {
+            }
+
+          protected:
+            int_type overflow(int_type c) override {
+                if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+                const char ch = traits_type::to_char_type(c);
+                Pending().push_back(ch);
+                if (ch == '\n') Emit(false);
+                return c;
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+                std::string& pending = Pending();
+                pending.append(s, static_cast<size_t>(n));
+                if (pending.find('\n') != std::string::npos) Emit(false);
+                return n;
+            }
+
+            int sync() override {
+                if (!Pending().empty()) Emit(true);
+                return 0;
+            }
+
+          private:
+            std::string& Pending() {
+                thread_local std::string pending[2];
+                return pending[kind_ == Kind::Err ? 1 : 0];
+            }
+
+            // 把缓冲中的完整行逐行入队；partial 为 true 时连同末尾不完整的一行一起入队
+            void Emit(bool partial);
+
+            Kind kind_;
+        };
+
+        class Logger {
+          public:
+            Logger() {
+                const char* term = std::getenv("TERM");
+                live_view_ = isatty(STDOUT_FILENO) && term && std::string(term) != "dumb";
+                winsize size{};
+                if (live_view_ && ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 20) {
+                    columns_ = size.ws_col;
+                }
+                out_ = std::cout.rdbuf(&out_buffer_);
+                err_ = std::cerr.rdbuf(&err_buffer_);
+                // std::cerr 默认每次 << 都刷新，会把一行拆成多条记录；改为与 std::cout 一样按行提交
+                std::cerr.unsetf(std::ios::unitbuf);
+                writer_ = std::thread([this] { Run(); });
+            }
+
+            ~Logger() {
+                stopping_ = true;
+                Wake();
+                writer_.join();
+                std::cout.rdbuf(out_);
+                std::cerr.rdbuf(err_);
+                std::cerr.setf(std::ios::unitbuf);
+            }
+
+            void Push(Record record) {
+                queue_.Push(std::move(record));
+                if (sleeping_.load(std::memory_order_seq_cst)) Wake();
+            }
+
+            void SetTap(Tap tap) {
+                std::lock_guard<std::mutex> lock(tap_mutex_);
+                tap_ = std::move(tap);
+                tap_line_start_[0] = tap_line_start_[1] = true;
+            }
+
+          private:
+            void Wake() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                wake_.notify_one();
+            }
+
+            void Run() {
+                while (true) {
+                    const bool stopping = stopping_.load();
+                    Record record;
+                    bool handled = false;
+                    while (queue_.Pop(record)) {
+                        Handle(record);
+                        handled = true;
+                    }
+                    if (stopping && queue_.Empty()) break;
+                    if (handled || !active_.empty()) DrawStatus();
+                    out_->pubsync();
+                    err_->pubsync();
+
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    sleeping_.store(true, std::memory_order_seq_cst);
+                    if (queue_.Empty() && !stopping_) wake_.wait_for(lock, kRefreshInterval);
+                    sleeping_.store(false, std::memory_order_seq_cst);
+                }
+                EraseStatus();
+                out_->pubsync();
+                err_->pubsync();
+            }
+
+            void Handle(Record& record) {
+                Sink* sink = record.sink.get();
+                switch (record.kind) {
+                    case Kind::Begin: {
+                        std::error_code ec;
+                        fs::create_directories(sink->path.parent_path(), ec);
+                        sink->file.open(sink->path, std::ios::trunc);
+                        sink->start = std::chrono::steady_clock::now();
+                        active_.push_back(record.sink);
+                        active_changed_ = true;
+                        return;
+                    }
+                    case Kind::End:
+                        sink->file.close();
+                        std::erase(active_, record.sink);
+                        active_changed_ = true;
+                        return;
+                    case Kind::Fence:
+                        record.fence->set_value();
+                        return;
+                    case Kind::Out:
+                    case Kind::Err:
+                        break;
+                }
+
+                const int stream = record.kind == Kind::Err ? 1 : 0;
+                CallTap(record, stream);
+                if (sink) {
+                    sink->file << record.text;
+                    if (size_t end = record.text.find_last_not_of("\r\n"); end != std::string::npos) {
+                        sink->last_line = record.text.substr(0, end + 1);
+                    }
+                    // 终端上显示进度视图时，包的普通输出只写入日志文件
+                    if (record.kind == Kind::Out && live_view_) return;
+                }
+
+                EraseStatus();
+                std::streambuf* target = stream == 1 ? err_ : out_;
+                if (sink && at_line_start_[stream]) {
+                    const std::string prefix = "[" + sink->label + "] ";
+                    target->sputn(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+                }
+                target->sputn(record.text.data(), static_cast<std::streamsize>(record.text.size()));
+                at_line_start_[stream] = record.text.ends_with('\n');
+            }
+
+            void CallTap(const Record& record, int stream) {
+                std::lock_guard<std::mutex> lock(tap_mutex_);
+                if (!tap_) return;
+                if (record.sink && tap_line_start_[stream]) {
+                    tap_("[" + record.sink->label + "] " + record.text, stream == 1);
+                } else {
+                    tap_(record.text, stream == 1);
+                }
+                tap_line_start_[stream] = record.text.ends_with('\n');
+            }
+
+            // 截断到终端宽度，避免折行打乱进度视图的行数；CJK 字符按两列计算
+            std::string Fit(const std::string& text) const {
+                size_t width = 0;
+                size_t i = 0;
+                while (i < text.size()) {
+                    const unsigned char c = static_cast<unsigned char>(text[i]);
+                    const size_t length = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+                    const size_t cells = length >= 3 ? 2 : 1;
+                    if (width + cells >= columns_) break;
+                    width += cells;
+                    i += length;
+                }
+                return text.substr(0, std::min(i, text.size()));
+            }
+
+            void EraseStatus() {
+                if (status_lines_ == 0) return;
+                // 光标移到进度视图第一行的行首并清除到屏幕末尾
+                const std::string erase = "\x1b[" + std::to_string(status_lines_) + "F\x1b[J";
+                out_->sputn(erase.data(), static_cast<std::streamsize>(erase.size()));
+                out_->pubsync();
+                status_lines_ = 0;
+            }
+
+            void DrawStatus() {
+                if (!live_view_) return;
+                const auto now = std::chrono::steady_clock::now();
+                if (status_lines_ > 0 && !active_changed_ && now - last_draw_ < kMinRedrawInterval) return;
+                EraseStatus();
+                err_->pubsync();  // 标准错误的内容必须先于进度视图出现在终端上
+
+                std::string view;
+                for (const auto& sink : active_) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - sink->start).count();
+                    view += Fit("  " + sink->label + " [" + std::to_string(elapsed) + "s] " + sink->last_line) + "\n";
+                }
+                out_->sputn(view.data(), static_cast<std::streamsize>(view.size()));
+                status_lines_ = active_.size();
+                active_changed_ = false;
+                last_draw_ = now;
+            }
+
+            RecordQueue queue_;
+            LineBuffer out_buffer_{Kind::Out};
+            LineBuffer err_buffer_{Kind::Err};
+            std::streambuf* out_ = nullptr;
+            std::streambuf* err_ = nullptr;
+
+            std::mutex mutex_;  // 只用于后台线程休眠和唤醒，写入日志不加锁
+            std::condition_variable wake_;
+            std::atomic<bool> sleeping_{false};
+            std::atomic<bool> stopping_{false};
+            std::thread writer_;
+
+            std::mutex tap_mutex_;  // 保护 tap_ 和 tap_line_start_
+            Tap tap_;
+            bool tap_line_start_[2] = {true, true};
+
+            // 以下只由后台线程访问
+            bool live_view_ = false;
+            size_t columns_ = 80;
+            std::vector<std::shared_ptr<Sink>> active_;
+            size_t status_lines_ = 0;
+            bool active_changed_ = false;
+            std::chrono::steady_clock::time_point last_draw_;
+            bool at_line_start_[2] = {true, true};  // 标准输出和标准错误上一次写出的内容是否以换行结尾
+        };
+
+        void LineBuffer::Emit(bool partial) {
+            std::string& pending = Pending();
+            Logger* logger = g_logger.load(std::memory_order_acquire);
+            if (!logger) {
+                pending.clear();
+                return;
+            }
+            size_t begin = 0;
+            while (begin < pending.size()) {
+                size_t end = pending.find('\n', begin);
+                if (end == std::string::npos) {
+                    if (!partial) break;
+                    end = pending.size() - 1;
+                }
+                logger->Push({kind_, t_sink, pending.substr(begin, end - begin + 1)});
+                begin = end + 1;
+            }
+            pending.erase(0, begin);
+        }
+
+        std::mutex g_lifecycle_mutex;
+        std::unique_ptr<Logger> g_instance;
+    }  // namespace
+
+    void Start() {
+        std::lock_guard<std::mutex> lock(g_lifecycle_mutex);
+        if (g_instance) return;
+        g_instance = std::make_unique<Logger>();
+        g_logger.store(g_instance.get(), std::memory_order_release);
+    }
+
+    void Stop() {
+        std::lock_guard<std::mutex> lock(g_lifecycle_mutex);
+        if (!g_instance) return;
+        std::cout.flush();
+        std::cerr.flush();
+        g_logger.store(nullptr, std::memory_order_release);
+        g_instance.reset();
+    }
+
+    void SetTap(Tap tap) {
+        std::lock_guard<std::mutex> lock(g_lifecycle_mutex);
+        if (g_instance) g_instance->SetTap(std::move(tap));
+    }
+
+    void Flush() {
+        std::cout.flush();
+        std::cerr.flush();
+        std::future<void> done;
+        {
+            std::lock_guard<std::mutex> lock(g_lifecycle_mutex);
+            if (!g_instance) return;
+            auto fence = std::make_shared<std::promise<void>>();
+            done = fence->get_future();
+            g_instance->Push({Kind::Fence, nullptr, "", fence});
+        }
+        done.wait();
+    }
+
+    PackageScope::PackageScope(std::string label, const fs::path& log_file) : previous_(t_sink) {
+        Logger* logger = g_logger.load(std::memory_order_acquire);
+        if (!logger) return;
+        sink_ = std::make_shared<Sink>();
+        sink_->label = std::move(label);
+        sink_->path = log_file;
+        logger->Push({Kind::Begin, sink_, ""});
+        t_sink = sink_;
+    }
+
+    PackageScope::~PackageScope() {
+        if (!sink_) return;
+        std::cout.flush();
+        std::cerr.flush();
+        if (Logger* logger = g_logger.load(std::memory_order_acquire)) logger->Push({Kind::End, sink_, ""});
+        t_sink = previous_;
+    }
+
+    void PrintTail(const fs::path& log_file, size_t lines) {
+        std::ifstream file(log_file);
+        if (!file.is_open()) return;
+
+        std::deque<std::string> tail;
+        std::string line;
+        while (std::getline(file, line)) {
+            tail.push_back(std::move(line));
+            if (tail.size() > lines) tail.pop_front();
+        }
+        if (tail.empty()) return;
+
+        std::cerr << "--- Last " << tail.size() << " line(s) of " << log_file.string() << " ---" << std::endl;
+        for (const auto& tail_line : tail) std::cerr << tail_line << "\n";
+        std::cerr << "--- End of " << log_file.filename().string() << " ---" << std::endl;
+    }
+
+}  // namespace Basic::Log
\ No newline at end of file
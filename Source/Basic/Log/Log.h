@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Basic::Log {
+
+    namespace detail {
+        struct Sink;
+    }
+
+    /**
+     * @brief 把 std::cout / std::cerr 接入异步日志。
+     *
+     * 之后各线程写出的每一行 (std::endl 不再触发系统调用) 进入无锁的多生产者单消费者队列，
+     * 由后台线程按顺序写到终端和所属包的日志文件。标准输出是终端时，包内的普通输出只写入日志文件，
+     * 终端底部显示每个正在构建的包的最新一行和已用时间；否则每行带上 "[包名] " 前缀直接输出。
+     */
+    void Start();
+
+    // 写出队列中剩余的所有行并恢复 std::cout / std::cerr 原来的缓冲区；应在所有工作线程结束后调用
+    void Stop();
+
+    /**
+     * @brief 在作用域内把当前线程的输出归属到一个包。
+     *
+     * 该线程写出的所有行都会写入 log_file (作用域开始时清空)，标准错误的行同时显示在终端上。
+     * 日志未启动时不产生任何效果。
+     */
+    class PackageScope {
+      public:
+        PackageScope(std::string label, const std::filesystem::path& log_file);
+        ~PackageScope();
+
+        PackageScope(const PackageScope&) = delete;
+        PackageScope& operator=(const PackageScope&) = delete;
+
+      private:
+        std::shared_ptr<detail::Sink> sink_;
+        std::shared_ptr<detail::Sink> previous_;
+    };
+
+    // 接收终端输出的回调，见 SetTap
+    using Tap = std::function<void(const std::string& text, bool is_error)>;
+
+    /**
+     * @brief 把每一段终端输出同时交给 tap，用于把输出转发到别处 (例如守护进程的客户端)。
+     *
+     * tap 收到的内容与非终端模式下的输出相同：包内的每一行都带 "[包名] " 前缀，不受进度视图影响。
+     * tap 在后台线程中调用，不能写 std::cout / std::cerr；传入空函数取消。日志未启动时不产生任何效果。
+     */
+    void SetTap(Tap tap);
+
+    /**
+     * @brief 等待此前已入队的行全部写出 (包括交给 tap)。
+     *
+     * 只会先刷新调用线程自己未完成的行；其他线程的输出需要在它们结束 (或离开 PackageScope) 后才算入队。
+     */
+    void Flush();
+
+    // 把日志文件的最后 lines 行打印到 std::cerr，用于在步骤失败时给出上下文
+    void PrintTail(const std::filesystem::path& log_file, size_t lines);
+
+}  // namespace Basic::Log
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "Basic/Metrics/Metrics.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace Basic::Metrics {
+
+    namespace {
+        enum class Type { Counter, Histogram };
+
+        struct Family {
+            Type type;
+            std::string help;
+            std::map<std::string, std::unique_ptr<Counter>> counters;      // labels -> 序列
+            std::map<std::string, std::unique_ptr<Histogram>> histograms;  // labels -> 序列
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::map<std::string, Family, std::less<>> families;
+        };
+
+        Registry& GetRegistry() {
+            static Registry registry;
+            return registry;
+        }
+
+        Family& GetFamily(Registry& registry, std::string_view name, std::string_view help, Type type) {
+            auto it = registry.families.find(name);
+            if (it == registry.families.end()) {
+                it = registry.families.emplace(std::string(name), Family{type, std::string(help), {}, {}}).first;
+            }
+            return it->second;
+        }
+
+        // 把 labels 与额外的标签拼接成 {a="1",b="2"}；两者都为空时返回空字符串
+        std::string LabelSet(const std::string& labels, const std::string& extra = "") {
+            if (labels.empty() && extra.empty()) return "";
+            if (labels.empty() || extra.empty()) return "{" + labels + extra + "}";
+            return "{" + labels + "," + extra + "}";
+        }
+
+        std::string EscapeHelp(const std::string& help) {
+            std::string escaped;
+            for (char c : help) {
+                if (c == '\\') {
+                    escaped += "\\\\";
+                } else if (c == '\n') {
+                    escaped += "\\n";
+                } else {
+                    escaped.push_back(c);
+                }
+            }
+            return escaped;
+        }
+
+        std::string Seconds(uint64_t micros) {
+            std::ostringstream out;
+            out.precision(6);
+            out << std::fixed << static_cast<double>(micros) / 1e6;
+            return out.str();
+        }
+    }  // namespace
+
+    // 小于 kSubBucketCount 的值各占一个桶；更大的值按最高位所在的 2 的幂区间分组，每组 kSubBucketCount 个桶
+    size_t Histogram::BucketIndex(uint64_t value) {
+        if (value < kSubBucketCount) return static_cast<size_t>(value);
+        const int shift = std::bit_width(value) - 1 - kSubBucketBits;
+        const uint64_t sub_bucket = (value >> shift) - kSubBucketCount;
+        return static_cast<size_t>(kSubBucketCount + (static_cast<uint64_t>(shift) << kSubBucketBits) + sub_bucket);
+    }
+
+    // 桶中可以表示的最大值
+    uint64_t Histogram::BucketUpperBound(size_t index) {
+        if (index < kSubBucketCount) return index;
+        const uint64_t offset = index - kSubBucketCount;
+        const int shift = static_cast<int>(offset >> kSubBucketBits);
+        const uint64_t lower = (kSubBucketCount + (offset & (kSubBucketCount - 1))) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+    void Histogram::Record(uint64_t micros) {
+        buckets_[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (micros > current && !max_.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    void Histogram::Record(std::chrono::steady_clock::duration elapsed) {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        Record(static_cast<uint64_t>(micros > 0 ? micros : 0));
+    }
+
+    uint64_t Histogram::Count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::SumMicros() const {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::PercentileMicros(double quantile) const {
+        const uint64_t count = Count();
+        if (count == 0) return 0;
+
+        const uint64_t target =
+            std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= target) return std::min(BucketUpperBound(i), max_.load(std::memory_order_relaxed));
+        }
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    Counter& GetCounter(std::string_view name, std::string_view help, std::string_view labels) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto& series = GetFamily(registry, name, help, Type::Counter).counters[std::string(labels)];
+        if (!series) series = std::make_unique<Counter>();
+        return *series;
+    }
+
+    Histogram& GetHistogram(std::string_view name, std::string_view help, std::string_view labels) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto& series = GetFamily(registry, name, help, Type::Histogram).histograms[std::string(labels)];
+        if (!series) series = std::make_unique<Histogram>();
+        return *series;
+    }
+
+    Counter& CacheLookups(std::string_view cache, bool hit) {
+        const std::string labels = "cache=\"" + std::string(cache) + "\",result=\"" + (hit ? "hit" : "miss") + "\"";
+        return GetCounter("gcpkg_cache_lookups_total", "Lookups in gcpkg caches by cache and result.", labels);
+    }
+
+    std::string Render(Format format) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        std::ostringstream out;
+        for (const auto& [name, family] : registry.families) {
+            // OpenMetrics 中计数器族的名称不含 _total 后缀，样本名称仍然带有
+            std::string family_name = name;
+            if (format == Format::OpenMetrics && family.type == Type::Counter && family_name.ends_with("_total")) {
+                family_name.resize(family_name.size() - 6);
+            }
+            out << "# HELP " << family_name << " " << EscapeHelp(family.help) << "\n";
+            out << "# TYPE " << family_name << " " << (family.type == Type::Counter ? "counter" : "summary") << "\n";
+
+            for (const auto& [labels, counter] : family.counters) {
+                out << name << LabelSet(labels) << " " << counter->Value() << "\n";
+            }
+            for (const auto& [labels, histogram] : family.histograms) {
+                for (const char* quantile : {"0.5", "0.9", "0.99"}) {
+                    out << name << LabelSet(labels, std::string("quantile=\"") + quantile + "\"") << " "
+                        << Seconds(histogram->PercentileMicros(std::stod(quantile))) << "\n";
+                }
+                out << name << "_sum" << LabelSet(labels) << " " << Seconds(histogram->SumMicros()) << "\n";
+                out << name << "_count" << LabelSet(labels) << " " << histogram->Count() << "\n";
+            }
+        }
+        if (format == Format::OpenMetrics) out << "# EOF\n";
+        return out.str();
+    }
+
+    bool WriteTextfile(const fs::path& path, Format format) {
+        std::error_code ec;
+        if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+
+        fs::path temp_path = path;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入指标文件 " << temp_path << std::endl;
+                return false;
+            }
+            file << Render(format);
+            if (!file) return false;
+        }
+        fs::rename(temp_path, path, ec);
+        return !ec;
+    }
+
+}  // namespace Basic::Metrics
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Basic::Metrics {
+
+    // 单调递增的计数器；Add 只有一次 relaxed 原子加法
+    class Counter {
+      public:
+        void Add(uint64_t n = 1) {
+            value_.fetch_add(n, std::memory_order_relaxed);
+        }
+        uint64_t Value() const {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+      private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    /**
+     * @brief HDR 风格的对数-线性直方图，记录以微秒为单位的耗时。
+     *
+     * 每个 2 的幂区间再等分为 16 个子桶，任意取值的相对误差不超过 1/16。
+     * 桶计数都是原子变量，Record 不加锁，可以被多个线程并发调用。
+     */
+    class Histogram {
+      public:
+        void Record(uint64_t micros);
+        void Record(std::chrono::steady_clock::duration elapsed);
+
+        uint64_t Count() const;
+        uint64_t SumMicros() const;
+        // 第 quantile (0~1) 分位数所在桶的上界 (不超过记录过的最大值)
+        uint64_t PercentileMicros(double quantile) const;
+
+      private:
+        static constexpr int kSubBucketBits = 4;
+        static constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+        static constexpr size_t kBucketCount = (65 - kSubBucketBits) << kSubBucketBits;
+
+        static size_t BucketIndex(uint64_t value);
+        static uint64_t BucketUpperBound(size_t index);
+
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    // 析构时把经过的时间记入直方图
+    class ScopedTimer {
+      public:
+        explicit ScopedTimer(Histogram& histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {
+        }
+        ~ScopedTimer() {
+            histogram_.Record(std::chrono::steady_clock::now() - start_);
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+      private:
+        Histogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * @brief 获取 (首次调用时注册) 一个计数器。
+     *
+     * 同名的指标组成一个族，labels 区分族中的序列，例如 `cache="file_hash",result="hit"`。
+     * 查找需要加锁，热路径上应把返回的引用保存在静态变量中。返回的引用在进程生命周期内有效。
+     *
+     * @param name 指标名，按 Prometheus 惯例以 _total 结尾。
+     * @param help 指标说明，同一族只取第一次注册时的说明。
+     * @param labels 不含花括号的标签列表，可以为空。
+     */
+    Counter& GetCounter(std::string_view name, std::string_view help, std::string_view labels = "");
+
+    // 获取 (首次调用时注册) 一个耗时直方图；导出时以秒为单位，名称应以 _seconds 结尾
+    Histogram& GetHistogram(std::string_view name, std::string_view help, std::string_view labels = "");
+
+    // 各个缓存共用的命中统计: gcpkg_cache_lookups_total{cache="<cache>",result="hit|miss"}
+    Counter& CacheLookups(std::string_view cache, bool hit);
+
+    enum class Format {
+        Prometheus,   // Prometheus text format 0.0.4
+        OpenMetrics,  // OpenMetrics 1.0，以 "# EOF" 结尾
+    };
+
+    // 以文本格式导出所有已注册的指标；直方图导出为带 0.5/0.9/0.99 分位数的 summary
+    std::string Render(Format format);
+
+    /**
+     * @brief 把所有指标写入文件，供 node exporter 的 textfile collector 采集。
+     *
+     * 先写入同目录的临时文件再重命名，采集器不会读到写了一半的文件。
+     */
+    bool WriteTextfile(const std::filesystem::path& path, Format format);
+
+}  // namespace Basic::Metrics
\ No newline at end of file
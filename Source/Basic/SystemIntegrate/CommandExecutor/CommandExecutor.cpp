@@ -1,6 +1,15 @@
 #include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <thread>
+
 namespace Basic {
     namespace SystemIntegrate {
         namespace CommandExecutor {
@@ -10,7 +19,118 @@ namespace Basic {
                 if (result != 0) {
                     std::cerr << "错误: 命令执行失败，返回值为: " << result << std::endl;
                 }
-                return true;
+                return result == 0;
+            }
+
+            bool executeCommandWithOutput(const std::string& command, std::string& output) {
+                output.clear();
+                FILE* pipe = popen(command.c_str(), "r");
+                if (!pipe) {
+                    std::cerr << "错误: 无法执行命令: " << command << std::endl;
+                    return false;
+                }
+                char buffer[4096];
+                size_t count;
+                while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+                    output.append(buffer, count);
+                }
+                return pclose(pipe) == 0;
+            }
+
+            std::string shellQuote(const std::string& value) {
+                std::string quoted = "'";
+                for (char c : value) {
+                    if (c == '\'') {
+                        quoted += "'\\''";
+                    } else {
+                        quoted += c;
+                    }
+                }
+                return quoted + "'";
+            }
+
+            // 轮询子进程状态和取消请求的间隔
+            static constexpr auto kPollInterval = std::chrono::milliseconds(50);
+            // SIGTERM 之后等待进程组退出的宽限期
+            static constexpr auto kKillGracePeriod = std::chrono::seconds(5);
+
+            // 等待子进程退出，最多等待到 deadline；退出时返回 true
+            static bool WaitUntil(pid_t pid, int& status, std::chrono::steady_clock::time_point deadline) {
+                while (true) {
+                    pid_t ret = waitpid(pid, &status, WNOHANG);
+                    if (ret == pid || (ret < 0 && errno != EINTR)) return true;
+                    if (std::chrono::steady_clock::now() >= deadline) return false;
+                    std::this_thread::sleep_for(kPollInterval);
+                }
+            }
+
+            CommandStatus executeCommandWithLimits(const std::string& command, const CommandLimits& limits) {
+                std::cout << "执行命令: " << command << std::endl;
+
+                // 子进程的输出由内核直接写入日志文件，不经过 gcpkg 进程中转
+                int log_fd = -1;
+                if (!limits.log_file.empty()) {
+                    log_fd = open(limits.log_file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                    if (log_fd < 0) {
+                        std::cerr << "警告: 无法打开日志文件 " << limits.log_file << "，命令输出将显示在终端上。"
+                                  << std::endl;
+                    } else {
+                        const std::string header = "$ " + command + "\n";
+                        [[maybe_unused]] ssize_t written = write(log_fd, header.data(), header.size());
+                    }
+                }
+
+                pid_t pid = fork();
+                if (pid < 0) {
+                    std::cerr << "错误: 无法创建子进程执行命令: " << command << std::endl;
+                    if (log_fd >= 0) close(log_fd);
+                    return CommandStatus::Failed;
+                }
+                if (pid == 0) {
+                    // 子进程成为新进程组的组长，终止时可以一次性杀掉它启动的所有进程
+                    setpgid(0, 0);
+                    if (log_fd >= 0) {
+                        dup2(log_fd, STDOUT_FILENO);
+                        dup2(log_fd, STDERR_FILENO);
+                    }
+                    execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+                    _exit(127);
+                }
+                setpgid(pid, pid);  // 与子进程中的调用竞争，确保 kill 之前进程组已存在
+                if (log_fd >= 0) close(log_fd);
+
+                const auto start = std::chrono::steady_clock::now();
+                CommandStatus abort_status = CommandStatus::Success;
+                int status = 0;
+                while (true) {
+                    pid_t ret = waitpid(pid, &status, WNOHANG);
+                    if (ret == pid || (ret < 0 && errno != EINTR)) break;
+
+                    if (limits.stop_token.stop_requested()) {
+                        abort_status = CommandStatus::Cancelled;
+                    } else if (limits.timeout.count() > 0 &&
+                               std::chrono::steady_clock::now() - start >= limits.timeout) {
+                        abort_status = CommandStatus::TimedOut;
+                    }
+                    if (abort_status != CommandStatus::Success) break;
+                    std::this_thread::sleep_for(kPollInterval);
+                }
+
+                if (abort_status == CommandStatus::Success) {
+                    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return CommandStatus::Success;
+                    std::cerr << "错误: 命令执行失败，返回值为: " << status << std::endl;
+                    return CommandStatus::Failed;
+                }
+
+                std::cerr << "错误: 命令" << (abort_status == CommandStatus::TimedOut ? "超时" : "被取消")
+                          << "，正在终止进程组: " << command << std::endl;
+                if (limits.on_abort) limits.on_abort();
+                kill(-pid, SIGTERM);
+                if (!WaitUntil(pid, status, std::chrono::steady_clock::now() + kKillGracePeriod)) {
+                    kill(-pid, SIGKILL);
+                    waitpid(pid, &status, 0);
+                }
+                return abort_status;
             }
         }  // namespace CommandExecutor
     }  // namespace SystemIntegrate
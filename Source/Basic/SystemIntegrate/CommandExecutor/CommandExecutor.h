@@ -1,10 +1,54 @@
 #pragma once
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <stop_token>
 #include <string>
 namespace Basic {
     namespace SystemIntegrate {
         namespace CommandExecutor {
+            /**
+             * @brief 执行 shell 命令。
+             *
+             * @return 命令退出码为 0 时返回 true。
+             */
             bool executeCommand(const std::string& command);
+
+            /**
+             * @brief 执行命令并捕获其标准输出。
+             *
+             * @param command 要执行的 shell 命令。
+             * @param output 用于接收命令标准输出的字符串（会被覆盖）。
+             * @return 命令退出码为 0 时返回 true。
+             */
+            bool executeCommandWithOutput(const std::string& command, std::string& output);
+
+            // 用单引号包裹参数，使其在 shell 命令中按字面传递
+            std::string shellQuote(const std::string& value);
+
+            // executeCommandWithLimits 的结果
+            enum class CommandStatus { Success, Failed, TimedOut, Cancelled };
+
+            // 命令的执行限制
+            struct CommandLimits {
+                std::chrono::milliseconds timeout{0};  // 0 表示不限时
+                std::stop_token stop_token;            // 请求停止时终止命令
+                // 超时或取消时、在终止本地进程组之前调用，用于清理本地进程组之外的进程 (如容器内的进程)
+                std::function<void()> on_abort;
+                // 非空时命令的标准输出和标准错误直接追加到该文件，而不是继承 gcpkg 的终端
+                std::string log_file;
+            };
+
+            /**
+             * @brief 在独立的进程组中执行命令，超时或被取消时终止整个进程组。
+             *
+             * 先发送 SIGTERM，宽限期后仍未退出则发送 SIGKILL。
+             *
+             * @param command 要执行的 shell 命令。
+             * @param limits 超时时间和取消令牌。
+             * @return 命令的执行结果。
+             */
+            CommandStatus executeCommandWithLimits(const std::string& command, const CommandLimits& limits);
         }  // namespace CommandExecutor
     }  // namespace SystemIntegrate
-}  // namespace Basic
+}  // namespace Basic
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "Basic/SystemIntegrate/GitMirror/GitMirror.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/ContentHash.h"
+
+namespace fs = std::filesystem;
+
+namespace Basic {
+    namespace SystemIntegrate {
+        namespace GitMirror {
+            namespace {
+                using CommandExecutor::shellQuote;
+
+                // 同一个镜像的获取和 worktree 登记在进程内串行执行
+                std::mutex& MirrorMutex(const fs::path& mirror) {
+                    static std::mutex map_mutex;
+                    static std::map<std::string, std::unique_ptr<std::mutex>> mutexes;
+                    std::lock_guard<std::mutex> lock(map_mutex);
+                    auto& mutex = mutexes[mirror.string()];
+                    if (!mutex) mutex = std::make_unique<std::mutex>();
+                    return *mutex;
+                }
+
+                bool Git(const fs::path& repo, const std::string& args) {
+                    return CommandExecutor::executeCommand("git -C " + shellQuote(repo.string()) + " " + args);
+                }
+
+                // 执行 git 命令并返回去掉末尾换行的标准输出
+                bool GitOutput(const fs::path& repo, const std::string& args, std::string& output) {
+                    if (!CommandExecutor::executeCommandWithOutput(
+                            "git -C " + shellQuote(repo.string()) + " " + args + " 2>/dev/null", output)) {
+                        return false;
+                    }
+                    while (!output.empty() && (output.back() == '\n' || output.back() == '\r')) output.pop_back();
+                    return !output.empty();
+                }
+
+                bool IsCommitHash(const std::string& ref) {
+                    if (ref.size() != 40 && ref.size() != 64) return false;
+                    return ref.find_first_not_of("0123456789abcdef") == std::string::npos;
+                }
+
+                std::string LocalRefName(const std::string& ref) {
+                    return "refs/gcpkg/" + (ref.empty() ? std::string("_head") : ref);
+                }
+
+                bool CreateMirror(const fs::path& mirror, const std::string& url) {
+                    std::error_code ec;
+                    fs::create_directories(mirror.parent_path(), ec);
+                    // 不配置 fetch refspec，镜像中只保留 refs/gcpkg/ 下显式获取的 ref
+                    if (CommandExecutor::executeCommand("git init -q --bare " + shellQuote(mirror.string())) &&
+                        Git(mirror, "remote add origin " + shellQuote(url)) &&
+                        Git(mirror, "config --unset-all remote.origin.fetch")) {
+                        return true;
+                    }
+                    std::cerr << "错误: 无法创建 git 镜像 " << mirror << std::endl;
+                    fs::remove_all(mirror, ec);
+                    return false;
+                }
+            }  // namespace
+
+            fs::path MirrorPath(const fs::path& cache_dir, const std::string& url) {
+                std::string name = url;
+                while (!name.empty() && name.back() == '/') name.pop_back();
+                name = name.substr(name.find_last_of("/:") + 1);
+                if (name.size() > 4 && name.ends_with(".git")) name.resize(name.size() - 4);
+                for (char& c : name) {
+                    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') c = '_';
+                }
+                return cache_dir / (name + "-" + Utils::HashString(url).substr(0, 12) + ".git");
+            }
+
+            bool UpdateMirror(const std::string& url,
+                              const std::string& ref,
+                              const GitFetchOptions& options,
+                              std::string& commit) {
+                const fs::path mirror = fs::absolute(MirrorPath(options.cache_dir, url));
+                Trace::Span span("git", "update mirror " + mirror.filename().string());
+                span.Arg("ref", ref);
+                std::lock_guard<std::mutex> lock(MirrorMutex(mirror));
+
+                if (!fs::exists(mirror / "HEAD") && !CreateMirror(mirror, url)) {
+                    return false;
+                }
+
+                // 提交哈希不会变化，镜像中已有时无需访问远端
+                if (IsCommitHash(ref) && GitOutput(mirror, "rev-parse --verify -q " + ref + "^{commit}", commit)) {
+                    std::cout << "--- Git mirror already has " << ref << " ---" << std::endl;
+                    Metrics::CacheLookups("git_mirror", true).Add();
+                    return true;
+                }
+                Metrics::CacheLookups("git_mirror", false).Add();
+
+                const std::string local_ref = LocalRefName(ref);
+                std::string args = "fetch --no-tags --no-write-fetch-head";
+                if (options.depth > 0) {
+                    args += " --depth=" + std::to_string(options.depth);
+                } else if (options.partial && options.mode == CheckoutMode::Worktree) {
+                    // alternates 检出的仓库无法向镜像的远端按需获取对象，只有 worktree 方式使用部分克隆
+                    args += " --filter=blob:none";
+                }
+                args += " origin " + shellQuote("+" + (ref.empty() ? std::string("HEAD") : ref) + ":" + local_ref);
+
+                std::cout << "--- Fetching " << (ref.empty() ? "HEAD" : ref) << " from " << url << " into " << mirror
+                          << " ---" << std::endl;
+                if (!Git(mirror, args)) {
+                    if (!GitOutput(mirror, "rev-parse --verify -q " + local_ref + "^{commit}", commit)) {
+                        std::cerr << "错误: 无法从 " << url << " 获取 '" << ref << "'。" << std::endl;
+                        return false;
+                    }
+                    std::cerr << "警告: 无法更新 " << url << "，使用镜像中缓存的 '" << ref << "' (" << commit << ")。"
+                              << std::endl;
+                    return true;
+                }
+
+                if (!GitOutput(mirror, "rev-parse --verify -q " + local_ref + "^{commit}", commit)) {
+                    std::cerr << "错误: '" << ref << "' 不是一个提交。" << std::endl;
+                    return false;
+                }
+                return true;
+            }
+
+            bool Materialize(const fs::path& mirror,
+                             const std::string& commit,
+                             const fs::path& dest,
+                             CheckoutMode mode) {
+                const fs::path abs_mirror = fs::absolute(mirror);
+                const fs::path abs_dest = fs::absolute(dest);
+                Trace::Span span("git", "checkout " + commit.substr(0, 12));
+                std::lock_guard<std::mutex> lock(MirrorMutex(abs_mirror));
+
+                std::error_code ec;
+                if (fs::exists(abs_dest / ".git", ec)) {
+                    std::string head;
+                    if (GitOutput(abs_dest, "rev-parse HEAD", head) && head == commit) {
+                        std::cout << "--- " << abs_dest << " is already at " << commit << " ---" << std::endl;
+                        return true;
+                    }
+                    // 已有的检出原地切换，只有变化的文件会被改写
+                    if (mode == CheckoutMode::Alternates && fs::exists(abs_mirror / "shallow", ec)) {
+                        fs::copy_file(abs_mirror / "shallow", abs_dest / ".git/shallow",
+                                      fs::copy_options::overwrite_existing, ec);
+                    }
+                    if (Git(abs_dest, "checkout -q -f --detach " + commit) && Git(abs_dest, "clean -q -ffdx")) {
+                        return true;
+                    }
+                    std::cerr << "错误: 无法把 " << abs_dest << " 切换到 " << commit << std::endl;
+                    return false;
+                }
+                if (fs::exists(abs_dest, ec) && !fs::is_empty(abs_dest, ec)) {
+                    std::cerr << "错误: 检出目录 " << abs_dest << " 已存在且不是 git 检出。" << std::endl;
+                    return false;
+                }
+                fs::create_directories(abs_dest.parent_path(), ec);
+
+                std::cout << "--- Checking out " << commit << " to " << abs_dest << " ---" << std::endl;
+                if (mode == CheckoutMode::Worktree) {
+                    // 先清理指向已删除目录的 worktree 登记
+                    return Git(abs_mirror, "worktree prune") &&
+                           Git(abs_mirror,
+                               "worktree add -q -f --detach " + shellQuote(abs_dest.string()) + " " + commit);
+                }
+                // 与 git clone --shared 相同的 alternates 布局；浅镜像不能被 clone，因此手动建立并复制 shallow 文件
+                if (!CommandExecutor::executeCommand("git init -q " + shellQuote(abs_dest.string()))) return false;
+                {
+                    std::ofstream alternates(abs_dest / ".git/objects/info/alternates");
+                    alternates << (abs_mirror / "objects").string() << "\n";
+                    if (!alternates) {
+                        std::cerr << "错误: 无法写入 " << abs_dest / ".git/objects/info/alternates" << std::endl;
+                        return false;
+                    }
+                }
+                if (fs::exists(abs_mirror / "shallow", ec)) {
+                    fs::copy_file(abs_mirror / "shallow", abs_dest / ".git/shallow", ec);
+                }
+                return Git(abs_dest, "checkout -q --detach " + commit);
+            }
+
+            bool FetchGitSource(const std::string& url,
+                                const std::string& ref,
+                                const fs::path& dest,
+                                const GitFetchOptions& options,
+                                std::string* commit) {
+                std::string resolved;
+                if (!UpdateMirror(url, ref, options, resolved) ||
+                    !Materialize(MirrorPath(options.cache_dir, url), resolved, dest, options.mode)) {
+                    return false;
+                }
+                if (commit) *commit = resolved;
+                return true;
+            }
+        }  // namespace GitMirror
+    }  // namespace SystemIntegrate
+}  // namespace Basic
\ No newline at end of file
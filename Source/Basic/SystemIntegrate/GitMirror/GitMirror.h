@@ -0,0 +1,65 @@
+#pragma once
+#include <filesystem>
+#include <string>
+namespace Basic {
+    namespace SystemIntegrate {
+        namespace GitMirror {
+            // 把镜像中的提交检出到构建目录的方式
+            enum class CheckoutMode {
+                Worktree,    // git worktree：检出的目录直接使用镜像的对象库，支持部分克隆的按需获取
+                Alternates,  // git clone --shared：独立的仓库，通过 objects/info/alternates 引用镜像的对象
+            };
+
+            struct GitFetchOptions {
+                std::filesystem::path cache_dir;  // 存放裸镜像的目录
+                int depth = 1;                    // 大于 0 时浅获取；0 表示获取完整历史
+                // 获取完整历史时使用 --filter=blob:none，文件内容在检出时按需获取
+                bool partial = true;
+                CheckoutMode mode = CheckoutMode::Worktree;
+            };
+
+            /**
+             * @brief 返回 url 对应的裸镜像路径：<cache_dir>/<仓库名>-<url 摘要>.git。
+             */
+            std::filesystem::path MirrorPath(const std::filesystem::path& cache_dir, const std::string& url);
+
+            /**
+             * @brief 创建或增量更新 url 的裸镜像，并解析 ref 对应的提交。
+             *
+             * 获取到的 ref 保存在镜像的 refs/gcpkg/ 下。ref 是完整的提交哈希且镜像中已存在该提交时不访问远端；
+             * 远端不可达但镜像中已有该 ref 时，使用缓存的结果并给出警告。url 可以是本地的裸仓库路径。
+             *
+             * @param url 上游仓库地址。
+             * @param ref 分支、标签或提交哈希；为空时使用远端的 HEAD。
+             * @param options 缓存目录和获取方式。
+             * @param commit 用于接收解析出的提交哈希。
+             * @return 成功时返回 true。
+             */
+            bool UpdateMirror(const std::string& url,
+                              const std::string& ref,
+                              const GitFetchOptions& options,
+                              std::string& commit);
+
+            /**
+             * @brief 把镜像中的提交检出到 dest。
+             *
+             * dest 已经是该镜像的检出时原地切换到 commit 并清除未跟踪的文件，否则 dest 必须不存在或为空目录。
+             */
+            bool Materialize(const std::filesystem::path& mirror,
+                             const std::string& commit,
+                             const std::filesystem::path& dest,
+                             CheckoutMode mode);
+
+            /**
+             * @brief 更新镜像并把 ref 检出到 dest，相当于 UpdateMirror 加 Materialize。
+             *
+             * @param commit 不为空时接收检出的提交哈希。
+             */
+            bool FetchGitSource(const std::string& url,
+                                const std::string& ref,
+                                const std::filesystem::path& dest,
+                                const GitFetchOptions& options,
+                                std::string* commit = nullptr);
+        }  // namespace GitMirror
+    }  // namespace SystemIntegrate
+}  // namespace Basic
\ No newline at end of file
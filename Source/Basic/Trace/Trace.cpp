@@ -0,0 +1,236 @@
+#include "Basic/Trace/Trace.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Basic::Trace {
+
+    namespace detail {
+        std::atomic<bool> g_enabled{false};
+    }
+
+    namespace {
+        // 每个线程最多保留的事件数；环按块分配，只记录少量事件的线程只占用一块
+        constexpr size_t kRingCapacity = 1 << 16;
+        constexpr size_t kBlockSize = 256;
+
+        struct Event {
+            const char* category = nullptr;
+            std::string name;
+            std::string args;
+            int64_t start_us = 0;
+            int64_t duration_us = 0;
+        };
+
+        // 只由所属线程写入；written 以 release 语义发布，Flush 以 acquire 语义读取
+        struct ThreadBuffer {
+            int tid = 0;
+            std::string name;
+            std::array<std::atomic<Event*>, kRingCapacity / kBlockSize> blocks{};
+            std::atomic<uint64_t> written{0};
+
+            ThreadBuffer() = default;
+            ThreadBuffer(const ThreadBuffer&) = delete;
+            ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+            ~ThreadBuffer() {
+                for (auto& block : blocks) delete[] block.load(std::memory_order_relaxed);
+            }
+
+            // 第 index 个事件在环中的位置；块在第一次写入时分配，先于 written 发布，因此读取时一定已存在
+            Event& Slot(uint64_t index) {
+                const uint64_t position = index % kRingCapacity;
+                std::atomic<Event*>& block = blocks[position / kBlockSize];
+                Event* events = block.load(std::memory_order_relaxed);
+                if (!events) {
+                    events = new Event[kBlockSize];
+                    block.store(events, std::memory_order_relaxed);
+                }
+                return events[position % kBlockSize];
+            }
+
+            const Event& At(uint64_t index) const {
+                const uint64_t position = index % kRingCapacity;
+                return blocks[position / kBlockSize].load(std::memory_order_relaxed)[position % kBlockSize];
+            }
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;  // 线程结束后缓冲区仍保留到 Flush
+            fs::path output;
+            std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+            int next_tid = 1;
+        };
+
+        Registry& GetRegistry() {
+            static Registry registry;
+            return registry;
+        }
+
+        ThreadBuffer& LocalBuffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+                auto created = std::make_shared<ThreadBuffer>();
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                created->tid = registry.next_tid++;
+                registry.buffers.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+
+        int64_t NowUs() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                         GetRegistry().origin)
+                .count();
+        }
+
+        void Record(Event event) {
+            ThreadBuffer& buffer = LocalBuffer();
+            const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+            buffer.Slot(index) = std::move(event);
+            buffer.written.store(index + 1, std::memory_order_release);
+        }
+
+        void AppendJsonString(std::string& out, std::string_view text) {
+            out += '"';
+            for (char c : text) {
+                switch (c) {
+                    case '"':
+                        out += "\\\"";
+                        break;
+                    case '\\':
+                        out += "\\\\";
+                        break;
+                    case '\n':
+                        out += "\\n";
+                        break;
+                    case '\t':
+                        out += "\\t";
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                            out += escaped;
+                        } else {
+                            out += c;
+                        }
+                }
+            }
+            out += '"';
+        }
+    }  // namespace
+
+    void Start(const fs::path& output) {
+        Registry& registry = GetRegistry();
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.output = output;
+            registry.origin = std::chrono::steady_clock::now();
+        }
+        detail::g_enabled.store(true, std::memory_order_relaxed);
+        SetThreadName("main");
+    }
+
+    bool Flush() {
+        if (!Enabled()) return true;
+        detail::g_enabled.store(false, std::memory_order_relaxed);
+
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        const int pid = static_cast<int>(getpid());
+
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        size_t event_count = 0;
+        bool first = true;
+        auto begin_event = [&] {
+            if (!first) json += ",\n";
+            first = false;
+        };
+
+        for (const auto& buffer : registry.buffers) {
+            if (!buffer->name.empty()) {
+                begin_event();
+                json += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + std::to_string(pid) +
+                        ",\"tid\":" + std::to_string(buffer->tid) + ",\"args\":{\"name\":";
+                AppendJsonString(json, buffer->name);
+                json += "}}";
+            }
+
+            const uint64_t written = buffer->written.load(std::memory_order_acquire);
+            const uint64_t oldest = written > kRingCapacity ? written - kRingCapacity : 0;
+            for (uint64_t i = oldest; i < written; ++i) {
+                const Event& event = buffer->At(i);
+                begin_event();
+                json += "{\"ph\":\"X\",\"cat\":";
+                AppendJsonString(json, event.category ? event.category : "");
+                json += ",\"name\":";
+                AppendJsonString(json, event.name);
+                json += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(buffer->tid) +
+                        ",\"ts\":" + std::to_string(event.start_us) + ",\"dur\":" + std::to_string(event.duration_us);
+                if (!event.args.empty()) json += ",\"args\":{" + event.args + "}";
+                json += "}";
+                ++event_count;
+            }
+        }
+        json += "]}\n";
+
+        std::error_code ec;
+        if (registry.output.has_parent_path()) fs::create_directories(registry.output.parent_path(), ec);
+        std::ofstream file(registry.output, std::ios::trunc);
+        file << json;
+        if (!file) {
+            std::cerr << "警告: 无法写入时间线文件 " << registry.output << std::endl;
+            return false;
+        }
+        std::cout << "--- Trace written to " << registry.output << " (" << event_count << " events) ---" << std::endl;
+        return true;
+    }
+
+    void SetThreadName(const std::string& name) {
+        if (!Enabled()) return;
+        ThreadBuffer& buffer = LocalBuffer();
+        std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+        buffer.name = name;
+    }
+
+    Span::Span(const char* category, std::string_view name) : active_(Enabled()) {
+        if (!active_) return;
+        category_ = category;
+        name_ = name;
+        start_us_ = NowUs();
+    }
+
+    Span::~Span() {
+        if (!active_ || !Enabled()) return;
+        Record({category_, std::move(name_), std::move(args_), start_us_, NowUs() - start_us_});
+    }
+
+    void Span::Arg(std::string_view key, int64_t value) {
+        if (!active_) return;
+        if (!args_.empty()) args_ += ',';
+        AppendJsonString(args_, key);
+        args_ += ':' + std::to_string(value);
+    }
+
+    void Span::Arg(std::string_view key, std::string_view value) {
+        if (!active_) return;
+        if (!args_.empty()) args_ += ',';
+        AppendJsonString(args_, key);
+        args_ += ':';
+        AppendJsonString(args_, value);
+    }
+
+}  // namespace Basic::Trace
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Basic::Trace {
+
+    namespace detail {
+        extern std::atomic<bool> g_enabled;
+    }
+
+    // 是否正在记录；未启用时所有记录操作只有一次原子读取的开销
+    inline bool Enabled() {
+        return detail::g_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 开始记录，Flush 时写入 output。
+     *
+     * 每个线程把事件写入自己的环形缓冲区，写入过程不加锁；缓冲区写满后覆盖最早的事件。
+     */
+    void Start(const std::filesystem::path& output);
+
+    /**
+     * @brief 停止记录并把所有线程的事件以 Chrome trace-event JSON 格式写入文件。
+     *
+     * 应在所有工作线程结束后调用 (通常在进程退出前)。可以用 chrome://tracing 或 Perfetto 打开。
+     */
+    bool Flush();
+
+    // 设置当前线程在时间线上显示的名称 (例如 "build worker 2")
+    void SetThreadName(const std::string& name);
+
+    /**
+     * @brief 一个时间区间：构造时开始，析构时结束并记录为完整事件 ("ph": "X")。
+     */
+    class Span {
+      public:
+        Span(const char* category, std::string_view name);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        // 附加在事件 args 中的参数
+        void Arg(std::string_view key, int64_t value);
+        void Arg(std::string_view key, std::string_view value);
+
+      private:
+        bool active_;
+        const char* category_ = nullptr;
+        std::string name_;
+        std::string args_;  // 已编码的 JSON 键值对，不含外层花括号
+        int64_t start_us_ = 0;
+    };
+
+}  // namespace Basic::Trace
\ No newline at end of file
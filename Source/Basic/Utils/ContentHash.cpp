@@ -0,0 +1,44 @@
+#include "Basic/Utils/ContentHash.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+namespace Basic::Utils {
+
+    static constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+    static constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+    static uint64_t FnvUpdate(uint64_t hash, const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+
+    static std::string ToHex(uint64_t hash) {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+        return std::string(buffer, 16);
+    }
+
+    std::string HashString(std::string_view data) {
+        return ToHex(FnvUpdate(kFnvOffsetBasis, data.data(), data.size()));
+    }
+
+    std::string HashFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return "";
+        }
+
+        uint64_t hash = kFnvOffsetBasis;
+        char buffer[64 * 1024];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+            hash = FnvUpdate(hash, buffer, static_cast<size_t>(file.gcount()));
+        }
+        return ToHex(hash);
+    }
+
+}  // namespace Basic::Utils
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Basic::Utils {
+
+    /**
+     * @brief 计算一段数据的 64 位 FNV-1a 摘要，以 16 位十六进制字符串返回。
+     *
+     * 用于 port 文件等小文本的快速内容标识，不具备密码学强度。
+     */
+    std::string HashString(std::string_view data);
+
+    /**
+     * @brief 计算文件内容的 64 位 FNV-1a 摘要。
+     *
+     * @param path 要读取的文件路径。
+     * @return 十六进制摘要；如果文件无法读取则返回空字符串。
+     */
+    std::string HashFile(const std::filesystem::path& path);
+
+}  // namespace Basic::Utils
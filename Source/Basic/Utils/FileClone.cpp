@@ -0,0 +1,41 @@
+#include "Basic/Utils/FileClone.h"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Basic::Utils {
+
+    bool ReflinkFile(const fs::path& src, const fs::path& dst) {
+#ifdef FICLONE
+        int src_fd = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+        if (src_fd < 0) return false;
+        int dst_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (dst_fd < 0) {
+            close(src_fd);
+            return false;
+        }
+        bool cloned = ioctl(dst_fd, FICLONE, src_fd) == 0;
+        close(src_fd);
+        close(dst_fd);
+        std::error_code ec;
+        if (!cloned) {
+            fs::remove(dst, ec);
+            return false;
+        }
+        fs::permissions(dst, fs::status(src, ec).permissions(), ec);
+        return true;
+#else
+        (void)src;
+        (void)dst;
+        return false;
+#endif
+    }
+
+}  // namespace Basic::Utils
\ No newline at end of file
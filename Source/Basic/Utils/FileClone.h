@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+
+namespace Basic::Utils {
+
+    /**
+     * @brief 用 FICLONE 创建 src 的 reflink 副本：两个文件共享数据块，写入时各自复制。
+     *
+     * 只在支持 reflink 的文件系统 (btrfs、XFS 等) 且位于同一文件系统时成功；失败时不留下 dst，
+     * 由调用方退回硬链接或普通复制。dst 已存在时会被覆盖。
+     */
+    bool ReflinkFile(const std::filesystem::path& src, const std::filesystem::path& dst);
+
+}  // namespace Basic::Utils
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "Basic/Utils/FileLock.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace Basic::Utils {
+
+    namespace detail {
+        struct HeldLock {
+            std::mutex mutex;  // 保护 locked 和 fd；同一进程中请求该锁的线程轮流尝试加锁
+            bool locked = false;
+            int fd = -1;
+
+            ~HeldLock() {
+                if (fd >= 0) close(fd);  // 关闭描述符同时释放 flock
+            }
+        };
+    }  // namespace detail
+
+    namespace {
+        std::mutex g_registry_mutex;
+        std::map<std::string, std::weak_ptr<detail::HeldLock>> g_registry;  // 本进程持有的锁，按绝对路径
+
+        std::string RegistryKey(const fs::path& lock_file) {
+            std::error_code ec;
+            fs::path absolute = fs::absolute(lock_file, ec);
+            return (ec ? lock_file : absolute).lexically_normal().string();
+        }
+
+        int OpenLockFile(const fs::path& lock_file) {
+            std::error_code ec;
+            fs::create_directories(lock_file.parent_path(), ec);
+            return open(lock_file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        }
+
+        // 等待其他进程释放锁时的轮询间隔
+        constexpr auto kPollInterval = std::chrono::milliseconds(100);
+
+        // 尝试一次加锁，锁被其他进程持有时返回 false。无法创建或锁定锁文件时给出警告，按已加锁处理 (不加锁继续)
+        bool TryLock(detail::HeldLock& held, const fs::path& lock_file) {
+            std::lock_guard<std::mutex> lock(held.mutex);
+            if (held.locked) return true;
+            if (held.fd < 0) held.fd = OpenLockFile(lock_file);
+            if (held.fd < 0) {
+                std::cerr << "警告: 无法创建锁文件 " << lock_file << ": " << std::strerror(errno)
+                          << "，在不加锁的情况下继续。" << std::endl;
+                held.locked = true;
+                return true;
+            }
+            if (flock(held.fd, LOCK_EX | LOCK_NB) != 0) {
+                if (errno == EWOULDBLOCK || errno == EINTR) return false;
+                std::cerr << "警告: 无法锁定 " << lock_file << ": " << std::strerror(errno) << std::endl;
+            }
+            held.locked = true;
+            return true;
+        }
+    }  // namespace
+
+    FileLock::FileLock(const fs::path& lock_file, const std::string& description) {
+        Register(lock_file);
+        Wait(lock_file, description, {});
+    }
+
+    std::unique_ptr<FileLock> FileLock::Acquire(const fs::path& lock_file,
+                                                const std::string& description,
+                                                std::stop_token stop_token) {
+        std::unique_ptr<FileLock> file_lock(new FileLock());
+        file_lock->Register(lock_file);
+        if (!file_lock->Wait(lock_file, description, stop_token)) return nullptr;
+        return file_lock;
+    }
+
+    void FileLock::Register(const fs::path& lock_file) {
+        key_ = RegistryKey(lock_file);
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        held_ = g_registry[key_].lock();
+        if (!held_) {
+            held_ = std::make_shared<detail::HeldLock>();
+            g_registry[key_] = held_;
+        }
+    }
+
+    bool FileLock::Wait(const fs::path& lock_file, const std::string& description, std::stop_token stop_token) {
+        bool announced = false;
+        while (!TryLock(*held_, lock_file)) {
+            if (stop_token.stop_requested()) return false;
+            if (!announced) {
+                std::cout << "--- Waiting for " << description << " (locked by another gcpkg process) ---"
+                          << std::endl;
+                announced = true;
+            }
+            std::this_thread::sleep_for(kPollInterval);
+        }
+        return true;
+    }
+
+    FileLock::~FileLock() {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        auto it = g_registry.find(key_);
+        held_.reset();
+        if (it != g_registry.end() && it->second.expired()) g_registry.erase(it);
+    }
+
+    std::unique_ptr<FileLock> FileLock::TryAcquire(const fs::path& lock_file) {
+        std::unique_ptr<FileLock> file_lock(new FileLock());
+        file_lock->key_ = RegistryKey(lock_file);
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        auto& entry = g_registry[file_lock->key_];
+        if (!entry.expired()) return nullptr;
+
+        auto held = std::make_shared<detail::HeldLock>();
+        held->fd = OpenLockFile(lock_file);
+        if (held->fd < 0 || flock(held->fd, LOCK_EX | LOCK_NB) != 0) return nullptr;
+        held->locked = true;
+        entry = held;
+        file_lock->held_ = std::move(held);
+        return file_lock;
+    }
+
+    bool FileLock::IsHeld(const fs::path& lock_file) {
+        {
+            std::lock_guard<std::mutex> lock(g_registry_mutex);
+            auto it = g_registry.find(RegistryKey(lock_file));
+            if (it != g_registry.end() && !it->second.expired()) return true;
+        }
+        const int fd = open(lock_file.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) return false;  // 从未被锁定过
+        const bool held = flock(fd, LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+        close(fd);
+        return held;
+    }
+
+    SharedFileLock::SharedFileLock(const fs::path& lock_file, Mode mode, const std::string& description)
+        : fd_(OpenLockFile(lock_file)) {
+        if (fd_ < 0) {
+            std::cerr << "警告: 无法创建锁文件 " << lock_file << ": " << std::strerror(errno)
+                      << "，在不加锁的情况下继续。" << std::endl;
+            return;
+        }
+        const int operation = mode == Mode::Shared ? LOCK_SH : LOCK_EX;
+        if (flock(fd_, operation | LOCK_NB) == 0) return;
+        std::cout << "--- Waiting for " << description << " ---" << std::endl;
+        while (flock(fd_, operation) != 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "警告: 无法锁定 " << lock_file << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+    }
+
+    SharedFileLock::~SharedFileLock() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    std::unique_ptr<SharedFileLock> SharedFileLock::TryAcquire(const fs::path& lock_file, Mode mode) {
+        std::unique_ptr<SharedFileLock> file_lock(new SharedFileLock());
+        file_lock->fd_ = OpenLockFile(lock_file);
+        const int operation = mode == Mode::Shared ? LOCK_SH : LOCK_EX;
+        if (file_lock->fd_ < 0 || flock(file_lock->fd_, operation | LOCK_NB) != 0) return nullptr;
+        return file_lock;
+    }
+
+}  // namespace Basic::Utils
\ No newline at end of file
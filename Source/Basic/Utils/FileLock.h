@@ -0,0 +1,78 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <stop_token>
+#include <string>
+
+namespace Basic::Utils {
+
+    namespace detail {
+        struct HeldLock;
+    }
+
+    /**
+     * @brief 基于 flock 的跨进程建议锁，作用域结束时释放。
+     *
+     * 锁在进程内按路径共享：同一进程中已持有该锁时直接共享，不会阻塞自己；进程内的互斥由调用方负责。
+     * 锁被其他进程持有时打印一行等待提示并轮询，直到对方释放 (对方进程退出时由内核释放)。
+     * 锁文件本身不会被删除，应放在不会被整体移除的目录中。无法创建锁文件时给出警告并在不加锁的情况下继续。
+     */
+    class FileLock {
+      public:
+        FileLock(const std::filesystem::path& lock_file, const std::string& description);
+        ~FileLock();
+
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+
+        // lock_file 是否正被某个进程 (包括本进程) 持有；不会阻塞
+        static bool IsHeld(const std::filesystem::path& lock_file);
+
+        // 不等待的加锁：锁已被任何进程 (包括本进程) 持有时返回 nullptr
+        static std::unique_ptr<FileLock> TryAcquire(const std::filesystem::path& lock_file);
+
+        // 与构造函数相同的等待加锁，但在轮询之间检查 stop_token；请求停止时放弃等待并返回 nullptr
+        static std::unique_ptr<FileLock> Acquire(const std::filesystem::path& lock_file,
+                                                 const std::string& description,
+                                                 std::stop_token stop_token);
+
+      private:
+        FileLock() = default;
+
+        // 加入本进程中该锁的共享记录
+        void Register(const std::filesystem::path& lock_file);
+        // 轮询直到锁被本进程持有；stop_token 请求停止时返回 false
+        bool Wait(const std::filesystem::path& lock_file, const std::string& description, std::stop_token stop_token);
+
+        std::string key_;
+        std::shared_ptr<detail::HeldLock> held_;
+    };
+
+    /**
+     * @brief 基于 flock 的读写锁：共享锁可以同时持有，独占锁与其他任何锁互斥，作用域结束时释放。
+     *
+     * 与 FileLock 不同，每个实例使用独立的文件描述符，同一进程中的实例之间同样遵守共享 / 独占语义。
+     * 无法创建锁文件时给出警告并在不加锁的情况下继续。
+     */
+    class SharedFileLock {
+      public:
+        enum class Mode { Shared, Exclusive };
+
+        // 等待加锁；需要等待时打印一行提示
+        SharedFileLock(const std::filesystem::path& lock_file, Mode mode, const std::string& description);
+        ~SharedFileLock();
+
+        SharedFileLock(const SharedFileLock&) = delete;
+        SharedFileLock& operator=(const SharedFileLock&) = delete;
+
+        // 不等待的加锁：无法立即加锁时返回 nullptr
+        static std::unique_ptr<SharedFileLock> TryAcquire(const std::filesystem::path& lock_file, Mode mode);
+
+      private:
+        SharedFileLock() = default;
+
+        int fd_ = -1;
+    };
+
+}  // namespace Basic::Utils
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "Benchmark/SyntheticInputs.h"
+#include "MainProcess/GcpkgMetaCommand/DecompressCommand.h"
+
+namespace fs = std::filesystem;
+
+namespace GcpkgBench {
+
+    // 解压耗时主要取决于条目数而不是字节数，因此使用大量小文件
+    static void DecompressArchive(benchmark::State& state, size_t file_count, size_t file_size) {
+        ScratchRoot root("decompress");
+        const fs::path archive = root.Path() / "source.tar.gz";
+        const size_t bytes = WriteSyntheticArchive(archive, file_count, file_size);
+        if (bytes == 0) {
+            state.SkipWithError("archive generation failed");
+            return;
+        }
+
+        const fs::path extract_dir = root.Path() / "buildtree";
+        std::map<std::string, std::string> variables = {{"${source_dir}", extract_dir.string()}};
+        MainProcess::GcpkgMetaCommand::MetaCommandContext context{"", variables, root.Path().string()};
+        for (auto _ : state) {
+            bool decompressed = MainProcess::GcpkgMetaCommand::Decompress(context, archive.string());
+            benchmark::DoNotOptimize(decompressed);
+
+            state.PauseTiming();
+            fs::remove_all(extract_dir);
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * file_count);
+        state.SetBytesProcessed(state.iterations() * bytes);
+    }
+
+    static void BM_Decompress_SmallFiles(benchmark::State& state) {
+        DecompressArchive(state, 2000, 2048);
+    }
+    BENCHMARK(BM_Decompress_SmallFiles);
+
+    static void BM_Decompress_TinyFiles(benchmark::State& state) {
+        DecompressArchive(state, 5000, 256);
+    }
+    BENCHMARK(BM_Decompress_TinyFiles);
+
+}  // namespace GcpkgBench
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <streambuf>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+    // 丢弃所有输出的流缓冲区
+    class NullBuffer : public std::streambuf {
+      protected:
+        int_type overflow(int_type c) override {
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char*, std::streamsize n) override {
+            return n;
+        }
+    };
+
+}  // namespace
+
+// 命令行参数即 Google Benchmark 的参数 (--benchmark_filter、--benchmark_out 等)，
+// 结果可以用 Google Benchmark 的 tools/compare.py 与基线比较。
+// 被测代码的进度输出写入 std::cout，运行期间被丢弃；结果表格直接写入终端。
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    std::ostream console(std::cout.rdbuf());
+    benchmark::ConsoleReporter reporter;
+    reporter.SetOutputStream(&console);
+    reporter.SetErrorStream(&std::cerr);
+
+    NullBuffer null_buffer;
+    std::streambuf* original = std::cout.rdbuf(&null_buffer);
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    std::cout.rdbuf(original);
+
+    benchmark::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <filesystem>
+
+#include <benchmark/benchmark.h>
+
+#include "Benchmark/SyntheticInputs.h"
+#include "MainProcess/BuildPlanner.h"
+#include "MainProcess/BuildSystemAnalysis.h"
+#include "MainProcess/DependenciesAnalysis.h"
+#include "MainProcess/EnvironmentSetup.h"
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace GcpkgBench {
+
+    // 被测包的直接依赖数和每个依赖注入的命令数
+    constexpr size_t kDependencies = 16;
+    constexpr size_t kInjectsPerDependency = 2;
+
+    // 在当前目录写出所有依赖的 port 并返回被测包
+    static SyntheticPort WriteDependents() {
+        std::vector<SyntheticPort> ports = SyntheticDependents(kDependencies, kInjectsPerDependency);
+        for (const auto& port : ports) WriteSyntheticPort(port);
+        return ports.back();
+    }
+
+    static void BM_ParsePortToml(benchmark::State& state) {
+        const std::string text = SyntheticPortToml(SyntheticDependents(kDependencies, kInjectsPerDependency).back());
+        for (auto _ : state) {
+            toml::table port_toml = toml::parse(text);
+            benchmark::DoNotOptimize(port_toml);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * text.size());
+    }
+    BENCHMARK(BM_ParsePortToml);
+
+    // 包含 ApplyInjects，因此每次迭代都会读取并解析所有依赖的 port.toml
+    static void BM_CreateBuildPlan(benchmark::State& state) {
+        ScratchRoot root("plan");
+        const toml::table port_toml = toml::parse_file(WriteSyntheticPort(WriteDependents()).string());
+        auto variables = SyntheticVariables(kDependencies);
+        for (auto _ : state) {
+            MainProcess::BuildPlan plan = MainProcess::CreateBuildPlan(port_toml, variables);
+            benchmark::DoNotOptimize(plan);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_CreateBuildPlan);
+
+    static void BM_ApplyInjects(benchmark::State& state) {
+        ScratchRoot root("injects");
+        const toml::table port_toml = toml::parse_file(WriteSyntheticPort(WriteDependents()).string());
+        for (auto _ : state) {
+            MainProcess::BuildPlan plan;
+            MainProcess::ApplyInjects(plan, port_toml);
+            benchmark::DoNotOptimize(plan);
+        }
+        state.SetItemsProcessed(state.iterations() * kDependencies);
+    }
+    BENCHMARK(BM_ApplyInjects);
+
+    static void BM_ApplyExportedBuildSystem(benchmark::State& state) {
+        std::vector<SyntheticPort> ports = SyntheticDependents(kDependencies, 0);
+        MainProcess::BuildSystemRegistry registry;
+        for (size_t i = 0; i + 1 < ports.size(); ++i) {
+            registry.Register(SpecOf(ports[i]), toml::parse(SyntheticPortToml(ports[i])));
+        }
+        SyntheticPort& package = ports.back();
+        package.build_system = "bench-build-system";
+        const toml::table port_toml = toml::parse(SyntheticPortToml(package));
+        const toml::table build_configs = *port_toml["build_configs"][0].as_table();
+        auto variables = SyntheticVariables(kDependencies);
+
+        for (auto _ : state) {
+            MainProcess::BuildPlan plan;
+            MainProcess::ApplyExportedBuildSystem(plan, build_configs, registry, variables);
+            benchmark::DoNotOptimize(plan);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ApplyExportedBuildSystem);
+
+    // 每个依赖都有完整的安装前缀，PrepareEnvironmentForPackage 逐一检查其标准目录
+    static void BM_PrepareEnvironmentForPackage(benchmark::State& state) {
+        ScratchRoot root("env");
+        const SyntheticPort package = SyntheticDependents(kDependencies, 0).back();
+        for (const auto& dependency : package.dependencies) {
+            const fs::path prefix = fs::path("gcpkg/packages") / dependency.substr(0, dependency.find('@')) /
+                                    package.version;
+            for (const char* dir : {"bin", "include", "lib/pkgconfig", "share/pkgconfig"}) {
+                fs::create_directories(prefix / dir);
+            }
+        }
+        const toml::table gcpkg_toml =
+            toml::parse("[global]\nbuild_type = \"Release\"\n\n[docker]\ndocker_proxy = \"\"\n");
+        const toml::table port_toml = toml::parse(SyntheticPortToml(package));
+
+        for (auto _ : state) {
+            MainProcess::EnvironmentContext environment =
+                MainProcess::PrepareEnvironmentForPackage(gcpkg_toml, port_toml, package.name, package.version);
+            benchmark::DoNotOptimize(environment);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_PrepareEnvironmentForPackage);
+
+}  // namespace GcpkgBench
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include "Basic/Utils/VariableProcessor.h"
+#include "Benchmark/SyntheticInputs.h"
+
+namespace GcpkgBench {
+
+    // 每条命令展开前都要替换一次，变量数随依赖数增长
+    static void ExpandCommand(benchmark::State& state, size_t dependencies) {
+        const auto variables = SyntheticVariables(dependencies);
+        const std::string command = SyntheticCommand(dependencies);
+        for (auto _ : state) {
+            std::string expanded = Basic::Utils::ExpandVariables(command, variables);
+            benchmark::DoNotOptimize(expanded);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * command.size());
+    }
+
+    static void BM_ExpandVariables_FewDependencies(benchmark::State& state) {
+        ExpandCommand(state, 4);
+    }
+    BENCHMARK(BM_ExpandVariables_FewDependencies);
+
+    static void BM_ExpandVariables_ManyDependencies(benchmark::State& state) {
+        ExpandCommand(state, 64);
+    }
+    BENCHMARK(BM_ExpandVariables_ManyDependencies);
+
+    // 没有任何占位符的命令，衡量逐个变量查找的固定开销
+    static void BM_ExpandVariables_NoPlaceholders(benchmark::State& state) {
+        const auto variables = SyntheticVariables(16);
+        const std::string command = "make -j8 install DESTDIR=/tmp/stage V=1";
+        for (auto _ : state) {
+            std::string expanded = Basic::Utils::ExpandVariables(command, variables);
+            benchmark::DoNotOptimize(expanded);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ExpandVariables_NoPlaceholders);
+
+}  // namespace GcpkgBench
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "Benchmark/FakeContainerBackend.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace CommandExecutor = Basic::SystemIntegrate::CommandExecutor;
+
+namespace GcpkgBench {
+
+    FakeContainerBackend::FakeContainerBackend(std::chrono::microseconds command_latency,
+                                               const std::string& record_path)
+        : command_latency_(command_latency) {
+        if (record_path.empty()) return;
+        record_.open(record_path, std::ios::trunc);
+        if (!record_.is_open()) std::cerr << "警告: 无法写入命令记录文件 " << record_path << std::endl;
+    }
+
+    // 容器名称紧跟在 --name 之后
+    bool FakeContainerBackend::Run(const std::vector<std::string>& options) {
+        for (size_t i = 0; i + 1 < options.size(); ++i) {
+            if (options[i] != "--name") continue;
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.insert(options[i + 1]);
+            return true;
+        }
+        std::cerr << "错误: 假执行器只能启动带 --name 的容器。" << std::endl;
+        return false;
+    }
+
+    bool FakeContainerBackend::IsRunning(const std::string& containerName) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_.count(containerName) > 0;
+    }
+
+    void FakeContainerBackend::Remove(const std::string& containerName) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.erase(containerName);
+    }
+
+    CommandExecutor::CommandStatus FakeContainerBackend::Execute(const std::string& containerName,
+                                                                 const std::string& workDir,
+                                                                 const std::string& command,
+                                                                 const CommandExecutor::CommandLimits& limits) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!IsRunning(containerName)) return CommandExecutor::CommandStatus::Failed;
+        commands_.fetch_add(1, std::memory_order_relaxed);
+
+        if (record_.is_open()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            record_ << workDir << "\t" << command << "\n";
+        }
+        if (command_latency_.count() > 0) {
+            // 与真实命令一样响应取消，但不模拟超时
+            const auto deadline = start + command_latency_;
+            while (std::chrono::steady_clock::now() < deadline) {
+                if (limits.stop_token.stop_requested()) return CommandExecutor::CommandStatus::Cancelled;
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                    deadline - std::chrono::steady_clock::now(), std::chrono::milliseconds(10)));
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        command_nanos_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                 std::memory_order_relaxed);
+        return CommandExecutor::CommandStatus::Success;
+    }
+
+}  // namespace GcpkgBench
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef GCPKG_FAKECONTAINERBACKEND_H
+#define GCPKG_FAKECONTAINERBACKEND_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Basic/DockerExecutor/ContainerBackend.h"
+
+namespace GcpkgBench {
+
+    /**
+     * @brief 不启动任何容器的假执行器。
+     *
+     * 每条命令只计数，并按需睡眠固定时长来模拟编译耗时，或把命令追加到记录文件中。
+     * 用于把 gcpkg 自身的解析、调度和元命令开销与编译器耗时分开测量。
+     */
+    class FakeContainerBackend : public Basic::DockerExecutor::ContainerBackend {
+      public:
+        // record_path 非空时把每条命令写入该文件
+        explicit FakeContainerBackend(std::chrono::microseconds command_latency, const std::string& record_path = "");
+
+        bool Run(const std::vector<std::string>& options) override;
+        bool IsRunning(const std::string& containerName) override;
+        void Remove(const std::string& containerName) override;
+        Basic::SystemIntegrate::CommandExecutor::CommandStatus Execute(
+            const std::string& containerName,
+            const std::string& workDir,
+            const std::string& command,
+            const Basic::SystemIntegrate::CommandExecutor::CommandLimits& limits) override;
+
+        uint64_t Commands() const {
+            return commands_.load(std::memory_order_relaxed);
+        }
+        // 所有命令在 Execute 中花费的时间之和 (秒)
+        double CommandSeconds() const {
+            return static_cast<double>(command_nanos_.load(std::memory_order_relaxed)) / 1e9;
+        }
+
+      private:
+        std::chrono::microseconds command_latency_;
+        std::atomic<uint64_t> commands_{0};
+        std::atomic<uint64_t> command_nanos_{0};
+
+        std::mutex mutex_;  // 保护 running_ 和 record_
+        std::set<std::string> running_;
+        std::ofstream record_;
+    };
+
+}  // namespace GcpkgBench
+
+#endif  // GCPKG_FAKECONTAINERBACKEND_H
\ No newline at end of file
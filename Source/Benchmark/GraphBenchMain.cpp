@@ -0,0 +1,262 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Basic/DockerExecutor/ContainerBackend.h"
+#include "Benchmark/FakeContainerBackend.h"
+#include "Benchmark/SyntheticInputs.h"
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/InstallationOrchestrator.h"
+
+namespace fs = std::filesystem;
+
+namespace GcpkgBench {
+
+    // 统计的 port.toml 解析位置，与 PortParses 的 site 标签对应
+    static const char* const kParseSites[] = {"resolve", "expand", "lockfile", "inject", "build_system"};
+
+    struct GraphBenchOptions {
+        std::vector<size_t> sizes = {100, 1000, 10000};
+        SyntheticGraphShape shape;
+        unsigned parallel_builds = 1;
+        std::chrono::microseconds command_latency{0};
+        std::string record_dir;  // 非空时把每次运行的命令记录到 <record_dir>/commands-<N>.txt
+        std::string out;         // JSON 结果文件
+    };
+
+    // 丢弃 gcpkg 的进度输出，只测量其本身的开销
+    class NullBuffer : public std::streambuf {
+      protected:
+        int_type overflow(int_type c) override {
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char*, std::streamsize n) override {
+            return n;
+        }
+    };
+
+    static double SecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief 在当前进程中生成一个 packages 个包的 port 树并完整安装一次，返回 JSON 对象文本。
+     *
+     * resolve_seconds 单独测量依赖图解析 (与 PerformInstallation 内部相同的工作)；
+     * overhead_seconds = install_seconds - command_seconds / parallel_builds，即安装耗时中不能由命令本身解释的部分，
+     * 包括解析、调度、环境准备、元命令 (下载、解压) 和会话记录。parallel_builds 为 1 时该值是精确的。
+     */
+    static std::string RunGraph(const GraphBenchOptions& options, size_t packages) {
+        ScratchRoot root("graph");
+
+        // 所有包共用一个本地源码包，inner_download 通过 file:// 读取
+        const fs::path archive = root.Path() / "sources" / "source.tar.gz";
+        fs::create_directories(archive.parent_path());
+        WriteSyntheticArchive(archive, 16, 512);
+
+        SyntheticGraphShape shape = options.shape;
+        shape.packages = packages;
+        shape.url = "file://" + archive.string();
+        const std::vector<SyntheticPort> ports = SyntheticPortGraph(shape);
+        size_t edges = 0;
+        for (const auto& port : ports) {
+            WriteSyntheticPort(port);
+            edges += port.dependencies.size();
+        }
+        const std::vector<std::string> roots = SyntheticGraphRoots(ports);
+
+        // 资源预算足够小，同时构建的包数只受 parallel_builds 限制
+        std::ofstream("gcpkg.toml") << "[global]\nbuild_type = \"Release\"\n"
+                                    << "parallel_builds = " << options.parallel_builds << "\n\n"
+                                    << "[docker]\nbuild_mirror = \"gcpkg-bench-fake\"\ndocker_proxy = \"\"\n\n"
+                                    << "[resources]\ndefault_memory = \"1M\"\ndefault_cpus = 0.01\n";
+
+        auto start = std::chrono::steady_clock::now();
+        MainProcess::DependencyGraph graph;
+        const bool resolved = MainProcess::ResolveDependencyGraph(roots, graph);
+        MainProcess::ExpandBuildConfigs(graph, "Release");
+        const double resolve_seconds = SecondsSince(start);
+        graph = {};
+
+        std::vector<uint64_t> parses_before;
+        for (const char* site : kParseSites) parses_before.push_back(MainProcess::PortParses(site).Value());
+
+        const std::string record_path =
+            options.record_dir.empty()
+                ? ""
+                : (fs::absolute(options.record_dir) / ("commands-" + std::to_string(packages) + ".txt")).string();
+        FakeContainerBackend backend(options.command_latency, record_path);
+        Basic::DockerExecutor::SetContainerBackend(&backend);
+        start = std::chrono::steady_clock::now();
+        const bool installed = resolved && MainProcess::PerformInstallation(roots);
+        const double install_seconds = SecondsSince(start);
+        Basic::DockerExecutor::SetContainerBackend(nullptr);
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        const double overhead_seconds = install_seconds - backend.CommandSeconds() / options.parallel_builds;
+
+        std::ostringstream json;
+        json << std::setprecision(9) << "{\"packages\": " << packages << ", \"edges\": " << edges
+             << ", \"requested\": " << roots.size() << ", \"success\": " << (installed ? "true" : "false")
+             << ", \"resolve_seconds\": " << resolve_seconds << ", \"install_seconds\": " << install_seconds
+             << ", \"commands\": " << backend.Commands() << ", \"command_seconds\": " << backend.CommandSeconds()
+             << ", \"overhead_seconds\": " << overhead_seconds
+             << ", \"overhead_per_package_ms\": " << overhead_seconds * 1000 / static_cast<double>(packages)
+             << ", \"peak_rss_bytes\": " << static_cast<uint64_t>(usage.ru_maxrss) * 1024 << ", \"port_parses\": {";
+        for (size_t i = 0; i < std::size(kParseSites); ++i) {
+            json << (i ? ", " : "") << "\"" << kParseSites[i]
+                 << "\": " << MainProcess::PortParses(kParseSites[i]).Value() - parses_before[i];
+        }
+        json << "}}";
+        return json.str();
+    }
+
+    // 每个规模在独立的子进程中运行，峰值内存和全局状态 (指标、缓存) 互不影响
+    static bool RunGraphInChild(const GraphBenchOptions& options, size_t packages, std::string& result) {
+        int fds[2];
+        if (pipe(fds) != 0) return false;
+        std::cout.flush();
+        std::cerr.flush();
+
+        const pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            NullBuffer null_buffer;
+            std::cout.rdbuf(&null_buffer);
+            const std::string json = RunGraph(options, packages);
+            [[maybe_unused]] ssize_t written = write(fds[1], json.data(), json.size());
+            close(fds[1]);
+            _exit(0);
+        }
+
+        close(fds[1]);
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) result.append(buffer, static_cast<size_t>(n));
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0 && !result.empty();
+    }
+
+    // 从 RunGraph 生成的 JSON 中取出一个数值字段
+    static double NumberField(const std::string& json, const std::string& key) {
+        const size_t pos = json.find("\"" + key + "\": ");
+        return pos == std::string::npos ? 0.0 : std::strtod(json.c_str() + pos + key.size() + 4, nullptr);
+    }
+
+}  // namespace GcpkgBench
+
+static void PrintUsage() {
+    std::cout << "用法: gcpkg_graph_bench [--sizes=100,1000,10000] [--depth=8] [--fan_out=3] [--inject_every=10]\n"
+                 "                         [--build_systems=4] [--parallel_builds=1] [--command_latency_us=0]\n"
+                 "                         [--record_dir=<目录>] [--out=<结果.json>]"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GcpkgBench::GraphBenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string_view flag = arg.substr(0, eq);
+        const std::string value = eq == std::string_view::npos ? "" : std::string(arg.substr(eq + 1));
+        const size_t number = std::strtoull(value.c_str(), nullptr, 10);
+
+        if (flag == "--sizes") {
+            options.sizes.clear();
+            std::istringstream sizes(value);
+            std::string size;
+            while (std::getline(sizes, size, ',')) {
+                if (std::strtoull(size.c_str(), nullptr, 10) > 0) {
+                    options.sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+                }
+            }
+        } else if (flag == "--depth") {
+            options.shape.depth = number;
+        } else if (flag == "--fan_out") {
+            options.shape.fan_out = number;
+        } else if (flag == "--inject_every") {
+            options.shape.inject_every = number;
+        } else if (flag == "--build_systems") {
+            options.shape.build_systems = number;
+        } else if (flag == "--parallel_builds") {
+            options.parallel_builds = static_cast<unsigned>(std::max<size_t>(1, number));
+        } else if (flag == "--command_latency_us") {
+            options.command_latency = std::chrono::microseconds(number);
+        } else if (flag == "--record_dir") {
+            options.record_dir = value;
+        } else if (flag == "--out") {
+            options.out = value;
+        } else {
+            if (flag != "--help" && flag != "-h") std::cerr << "错误: 未知参数 " << arg << std::endl;
+            PrintUsage();
+            return flag == "--help" || flag == "-h" ? 0 : 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(10) << "Packages" << std::right << std::setw(10) << "Edges" << std::setw(12)
+              << "Resolve" << std::setw(12) << "Install" << std::setw(12) << "Overhead" << std::setw(14)
+              << "Per package" << std::setw(10) << "Parses" << std::setw(12) << "Peak RSS" << std::endl;
+
+    std::vector<std::string> results;
+    bool all_succeeded = true;
+    for (size_t packages : options.sizes) {
+        std::string result;
+        if (!GcpkgBench::RunGraphInChild(options, packages, result)) {
+            std::cerr << "错误: " << packages << " 个包的运行异常退出。" << std::endl;
+            all_succeeded = false;
+            continue;
+        }
+        all_succeeded = all_succeeded && result.find("\"success\": true") != std::string::npos;
+        results.push_back(result);
+
+        using GcpkgBench::NumberField;
+        double parses = 0;
+        for (const char* site : GcpkgBench::kParseSites) parses += NumberField(result, site);
+        std::cout << std::left << std::setw(10) << packages << std::right << std::setw(10)
+                  << NumberField(result, "edges") << std::fixed << std::setprecision(3) << std::setw(11)
+                  << NumberField(result, "resolve_seconds") << "s" << std::setw(11)
+                  << NumberField(result, "install_seconds") << "s" << std::setw(11)
+                  << NumberField(result, "overhead_seconds") << "s" << std::setw(11)
+                  << NumberField(result, "overhead_per_package_ms") << " ms" << std::setprecision(0)
+                  << std::setw(10) << parses << std::setw(9) << NumberField(result, "peak_rss_bytes") / (1 << 20)
+                  << " MB" << std::defaultfloat << std::endl;
+    }
+
+    if (!options.out.empty()) {
+        std::ofstream file(options.out);
+        file << "{\n  \"context\": {\"num_cpus\": " << std::thread::hardware_concurrency()
+             << ", \"depth\": " << options.shape.depth << ", \"fan_out\": " << options.shape.fan_out
+             << ", \"inject_every\": " << options.shape.inject_every
+             << ", \"build_systems\": " << options.shape.build_systems
+             << ", \"parallel_builds\": " << options.parallel_builds
+             << ", \"command_latency_us\": " << options.command_latency.count() << "},\n  \"runs\": [";
+        for (size_t i = 0; i < results.size(); ++i) file << (i ? "," : "") << "\n    " << results[i];
+        file << "\n  ]\n}\n";
+        if (!file) {
+            std::cerr << "错误: 无法写入结果文件 " << options.out << std::endl;
+            return 1;
+        }
+    }
+    return all_succeeded ? 0 : 1;
+}
\ No newline at end of file
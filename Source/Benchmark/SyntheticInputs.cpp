@@ -0,0 +1,235 @@
+#include "Benchmark/SyntheticInputs.h"
+
+#include <archive.h>
+#include <archive_entry.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace GcpkgBench {
+
+    static const char* const kBuildSystemName = "bench-build-system";
+
+    ScratchRoot::ScratchRoot(const std::string& tag) : previous_(fs::current_path()) {
+        std::string pattern = (fs::temp_directory_path() / ("gcpkg_bench_" + tag + "_XXXXXX")).string();
+        if (!mkdtemp(pattern.data())) {
+            std::cerr << "错误: 无法创建基准测试临时目录 " << pattern << std::endl;
+            std::abort();
+        }
+        path_ = pattern;
+        fs::current_path(path_);
+    }
+
+    ScratchRoot::~ScratchRoot() {
+        std::error_code ec;
+        fs::current_path(previous_, ec);
+        fs::remove_all(path_, ec);
+    }
+
+    std::string SpecOf(const SyntheticPort& port) {
+        return port.name + "@" + port.ns + "@" + port.version;
+    }
+
+    std::string SyntheticPortToml(const SyntheticPort& port) {
+        std::ostringstream out;
+        const std::string url =
+            port.url.empty() ? "https://example.com/" + port.ns + "/" + port.name + ".tar.gz" : port.url;
+        out << "[packages]\n"
+            << "url = \"" << url << "\"\n"
+            << "ref = \"v" << port.version << "\"\n\n";
+
+        // PrepareEnvironmentForPackage 从顶层 dependencies 收集依赖的安装目录
+        for (const auto& dependency : port.dependencies) {
+            const std::string name = dependency.substr(0, dependency.find('@'));
+            out << "[[dependencies]]\nname = \"" << name << "\"\nversion = \"" << port.version << "\"\n\n";
+        }
+
+        out << "[[build_configs]]\nbuild_type = \"Release\"\n";
+        if (!port.build_system.empty()) out << "build_system = \"" << port.build_system << "\"\n";
+        out << "dependencies = [";
+        for (size_t i = 0; i < port.dependencies.size(); ++i) {
+            out << (i ? ", " : "") << "\"" << port.dependencies[i] << "\"";
+        }
+        out << "]\n";
+
+        out << "pre_configure = [\"inner_download ${url}\", \"inner_decompress ${last_file}\"]\n";
+        if (port.build_system.empty()) {
+            out << "configure = [";
+            for (size_t i = 0; i < port.commands_per_step; ++i) {
+                out << (i ? ", " : "") << "\"cmake -S ${source_dir} -B ${build_dir} -DCMAKE_BUILD_TYPE=${build_type} "
+                    << "-DCMAKE_INSTALL_PREFIX=${package_install_dir} -DOPTION_" << i << "=ON\"";
+            }
+            out << "]\nbuild = [";
+            for (size_t i = 0; i < port.commands_per_step; ++i) {
+                out << (i ? ", " : "") << "\"cmake --build ${build_dir} --target part_" << i << " -j\"";
+            }
+            out << "]\ninstall = [";
+            for (size_t i = 0; i < port.commands_per_step; ++i) {
+                out << (i ? ", " : "") << "\"cmake --install ${build_dir} --component part_" << i << "\"";
+            }
+            out << "]\n";
+        }
+        out << "post_install = [\"inner_mkdir ${package_install_dir}/share/" << port.name << "\"]\n";
+
+        for (size_t i = 0; i < port.injects; ++i) {
+            out << "\n[[build_configs.inject]]\ntype = \"pre_configure\"\n"
+                << "command = [\"echo inject " << port.name << " " << i << "\"]\n";
+        }
+        if (!port.export_build_system.empty()) {
+            out << "\n[[build_configs.export_build_system]]\n"
+                << "name = \"" << port.export_build_system << "\"\n"
+                << "configure_command = \"cmake -S ${source_dir} -B ${build_dir} -DCMAKE_INSTALL_PREFIX=${string}\"\n"
+                << "configure_option = [\"-DBUILD_SHARED_LIBS=ON\", \"-DBUILD_TESTING=OFF\"]\n"
+                << "build_command = \"cmake --build ${build_dir} -j${Int}\"\n"
+                << "install_command = \"cmake --install ${build_dir}\"\n";
+        }
+        return out.str();
+    }
+
+    fs::path WriteSyntheticPort(const SyntheticPort& port) {
+        fs::path dir = fs::path("gcpkg/port") / port.ns / port.name / port.version;
+        fs::create_directories(dir);
+        fs::path path = dir / "port.toml";
+        std::ofstream(path) << SyntheticPortToml(port);
+        return path;
+    }
+
+    std::vector<SyntheticPort> SyntheticDependents(size_t dependency_count, size_t injects) {
+        std::vector<SyntheticPort> ports;
+        SyntheticPort root;
+        root.name = "root";
+        for (size_t i = 0; i < dependency_count; ++i) {
+            SyntheticPort dependency;
+            dependency.name = "dep" + std::to_string(i);
+            dependency.injects = injects;
+            if (i == 0) dependency.export_build_system = kBuildSystemName;
+            root.dependencies.push_back(SpecOf(dependency));
+            ports.push_back(std::move(dependency));
+        }
+        ports.push_back(std::move(root));
+        return ports;
+    }
+
+    std::vector<SyntheticPort> SyntheticPortGraph(const SyntheticGraphShape& shape) {
+        const size_t depth = std::max<size_t>(1, std::min(shape.depth, shape.packages));
+        std::mt19937 random(shape.seed);
+
+        // 第 i 个包位于第 i * depth / packages 层，每层的包在编号上连续
+        std::vector<size_t> layer_begin(depth + 1, shape.packages);
+        for (size_t layer = 0; layer < depth; ++layer) layer_begin[layer] = layer * shape.packages / depth;
+
+        std::vector<SyntheticPort> ports(shape.packages);
+        for (size_t i = 0; i < shape.packages; ++i) {
+            SyntheticPort& port = ports[i];
+            port.name = "pkg" + std::to_string(i);
+            port.url = shape.url;
+            if (shape.inject_every > 0 && i % shape.inject_every == 0) port.injects = 2;
+            if (i < std::min(shape.build_systems, layer_begin[1])) {
+                port.export_build_system = "bench-build-system-" + std::to_string(i);
+            }
+
+            const size_t layer = i * depth / shape.packages;
+            if (layer == 0) continue;
+            if (shape.build_systems > 0 && i % 5 == 0) {
+                port.build_system = "bench-build-system-" + std::to_string(i % std::min(shape.build_systems,
+                                                                                        layer_begin[1]));
+            }
+            const size_t begin = layer_begin[layer - 1];
+            const size_t count = layer_begin[layer] - begin;
+            std::set<size_t> chosen;
+            std::uniform_int_distribution<size_t> pick(begin, begin + count - 1);
+            while (chosen.size() < std::min(shape.fan_out, count)) chosen.insert(pick(random));
+            for (size_t dependency : chosen) port.dependencies.push_back(SpecOf(ports[dependency]));
+        }
+        return ports;
+    }
+
+    std::vector<std::string> SyntheticGraphRoots(const std::vector<SyntheticPort>& ports) {
+        std::set<std::string> depended;
+        for (const auto& port : ports) depended.insert(port.dependencies.begin(), port.dependencies.end());
+        std::vector<std::string> roots;
+        for (const auto& port : ports) {
+            if (!depended.count(SpecOf(port))) roots.push_back(SpecOf(port));
+        }
+        return roots;
+    }
+
+    std::map<std::string, std::string> SyntheticVariables(size_t extra) {
+        std::map<std::string, std::string> variables = {
+            {"${docker_proxy}", "http://proxy.example.com:3128"},
+            {"${url}", "https://example.com/bench/root.git"},
+            {"${ref}", "v1.0.0"},
+            {"${build_type}", "Release"},
+            {"${build_dir}", "/work/project/gcpkg/buildtrees/root/1.0.0"},
+            {"${source_dir}", "/work/project/gcpkg/buildtrees/root/1.0.0"},
+            {"${package_install_dir}", "/work/project/gcpkg/packages/root/1.0.0"},
+            {"${gcpkg_root}", "/work/project"},
+            {"${last_file}", "/work/project/gcpkg/downloads/root-1.0.0.tar.gz"},
+        };
+        for (size_t i = 0; i < extra; ++i) {
+            variables["${dep" + std::to_string(i) + "_dir}"] = "/work/project/gcpkg/packages/dep" + std::to_string(i) +
+                                                              "/1.0.0";
+        }
+        return variables;
+    }
+
+    std::string SyntheticCommand(size_t extra) {
+        std::string command =
+            "env CC=clang CXX=clang++ cmake -S ${source_dir} -B ${build_dir} -DCMAKE_BUILD_TYPE=${build_type} "
+            "-DCMAKE_INSTALL_PREFIX=${package_install_dir} -DCMAKE_PREFIX_PATH=\"";
+        for (size_t i = 0; i < extra; ++i) {
+            command += (i ? ";" : "") + std::string("${dep") + std::to_string(i) + "_dir}";
+        }
+        return command + "\" -DFETCHCONTENT_BASE_DIR=${gcpkg_root}/gcpkg/downloads";
+    }
+
+    size_t WriteSyntheticArchive(const fs::path& path, size_t file_count, size_t file_size) {
+        struct archive* a = archive_write_new();
+        archive_write_add_filter_gzip(a);
+        archive_write_set_format_pax_restricted(a);
+        if (archive_write_open_filename(a, path.string().c_str()) != ARCHIVE_OK) {
+            std::cerr << "错误: 无法创建压缩包 " << path << ": " << archive_error_string(a) << std::endl;
+            archive_write_free(a);
+            return 0;
+        }
+
+        // 伪源码内容，压缩率接近真实源码
+        std::string content;
+        while (content.size() < file_size) {
+            content += "int function_" + std::to_string(content.size()) + "(int value) { return value * 3 + 1; }\n";
+        }
+        content.resize(file_size);
+
+        size_t total = 0;
+        struct archive_entry* entry = archive_entry_new();
+        for (size_t i = 0; i < file_count; ++i) {
+            const std::string name = "project/src/dir" + std::to_string(i / 1024) + "/sub" +
+                                     std::to_string(i / 32 % 32) + "/file" + std::to_string(i) + ".c";
+            archive_entry_clear(entry);
+            archive_entry_set_pathname(entry, name.c_str());
+            archive_entry_set_filetype(entry, AE_IFREG);
+            archive_entry_set_perm(entry, 0644);
+            archive_entry_set_size(entry, static_cast<la_int64_t>(content.size()));
+            if (archive_write_header(a, entry) != ARCHIVE_OK ||
+                archive_write_data(a, content.data(), content.size()) < 0) {
+                std::cerr << "错误: 写入压缩包 " << path << " 失败: " << archive_error_string(a) << std::endl;
+                total = 0;
+                break;
+            }
+            total += content.size();
+        }
+        archive_entry_free(entry);
+        archive_write_close(a);
+        archive_write_free(a);
+        return total;
+    }
+
+}  // namespace GcpkgBench
\ No newline at end of file
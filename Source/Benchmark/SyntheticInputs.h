@@ -0,0 +1,106 @@
+#ifndef GCPKG_SYNTHETICINPUTS_H
+#define GCPKG_SYNTHETICINPUTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GcpkgBench {
+
+    /**
+     * @brief 基准测试使用的临时 gcpkg 根目录。
+     *
+     * gcpkg 的路径 (gcpkg/port、gcpkg/packages、gcpkg/buildtrees) 都相对于当前工作目录，
+     * 因此构造时创建临时目录并切换进去，析构时切换回原目录并删除临时目录。
+     */
+    class ScratchRoot {
+      public:
+        explicit ScratchRoot(const std::string& tag);
+        ~ScratchRoot();
+
+        ScratchRoot(const ScratchRoot&) = delete;
+        ScratchRoot& operator=(const ScratchRoot&) = delete;
+
+        const std::filesystem::path& Path() const {
+            return path_;
+        }
+
+      private:
+        std::filesystem::path path_;
+        std::filesystem::path previous_;
+    };
+
+    // 生成 port.toml 的参数
+    struct SyntheticPort {
+        std::string name;
+        std::string ns = "bench";
+        std::string version = "1.0.0";
+        std::vector<std::string> dependencies;  // 依赖规格 "name@ns@version"
+        size_t commands_per_step = 3;           // configure / build / install 各自的命令数
+        size_t injects = 0;                     // 该包向依赖它的包注入的 pre_configure 命令数
+        std::string build_system;               // 使用的构建系统；非空时不生成 configure/build/install 命令
+        std::string export_build_system;        // 导出的构建系统名称
+        std::string url;                        // 源码包地址 (inner_download 下载)；为空时使用不可访问的示例地址
+    };
+
+    // 包的规格 "name@ns@version"
+    std::string SpecOf(const SyntheticPort& port);
+
+    // 生成与真实 port 结构相同的 port.toml 文本
+    std::string SyntheticPortToml(const SyntheticPort& port);
+
+    // 把 port.toml 写到当前目录下的 gcpkg/port/<ns>/<name>/<version>/port.toml 并返回其路径
+    std::filesystem::path WriteSyntheticPort(const SyntheticPort& port);
+
+    /**
+     * @brief 生成一组带 dependencies 的包：一个被测包直接依赖其余所有包。
+     *
+     * 依赖包各自导出 injects 条注入命令，第一个依赖包导出名为 "bench-build-system" 的构建系统。
+     * 返回值的最后一项是被测包，调用者决定是否设置其 build_system。
+     */
+    std::vector<SyntheticPort> SyntheticDependents(size_t dependency_count, size_t injects);
+
+    // SyntheticPortGraph 生成的依赖图形状
+    struct SyntheticGraphShape {
+        size_t packages = 100;
+        size_t depth = 8;           // 层数；第 0 层的包没有依赖
+        size_t fan_out = 3;         // 每个包依赖上一层中的包数
+        size_t inject_every = 10;   // 每隔多少个包有一个包导出注入命令，0 表示没有
+        size_t build_systems = 4;   // 第 0 层中导出构建系统的包数，每隔 5 个包有一个包使用它们
+        std::string url;            // 所有包共用的源码包地址
+        uint32_t seed = 1;          // 选择依赖的随机数种子，相同的参数总是生成相同的图
+    };
+
+    /**
+     * @brief 按层生成一棵 port 树：第 L 层的每个包随机依赖第 L-1 层的 fan_out 个包。
+     */
+    std::vector<SyntheticPort> SyntheticPortGraph(const SyntheticGraphShape& shape);
+
+    // 没有被任何包依赖的包，即安装请求
+    std::vector<std::string> SyntheticGraphRoots(const std::vector<SyntheticPort>& ports);
+
+    /**
+     * @brief 生成与 PrepareEnvironmentForPackage 产物规模相当的变量表。
+     *
+     * 除标准变量 (${build_dir}、${source_dir} 等) 外再加入 extra 个依赖目录变量。
+     */
+    std::map<std::string, std::string> SyntheticVariables(size_t extra);
+
+    // 生成一条引用 SyntheticVariables 中变量的典型 configure 命令
+    std::string SyntheticCommand(size_t extra);
+
+    /**
+     * @brief 生成含有 file_count 个小文件的 tar.gz 压缩包，模拟源码包。
+     *
+     * 文件分布在每层最多 32 个条目的目录树中，内容是可压缩的伪源码。
+     *
+     * @return 所有文件未压缩的总字节数；失败时返回 0。
+     */
+    size_t WriteSyntheticArchive(const std::filesystem::path& path, size_t file_count, size_t file_size);
+
+}  // namespace GcpkgBench
+
+#endif  // GCPKG_SYNTHETICINPUTS_H
\ No newline at end of file
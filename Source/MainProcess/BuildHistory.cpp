@@ -0,0 +1,193 @@
+#include "MainProcess/BuildHistory.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    // 新样本在指数加权平均中的权重
+    static constexpr double kSmoothing = 0.5;
+
+    static double Blend(double previous, double current) {
+        return previous * (1.0 - kSmoothing) + current * kSmoothing;
+    }
+
+    static StepRecord ReadStep(const toml::table& table) {
+        StepRecord step;
+        step.wall_seconds = table["wall_seconds"].value_or(0.0);
+        step.cpu_seconds = table["cpu_seconds"].value_or(0.0);
+        step.peak_memory_bytes = static_cast<uint64_t>(table["peak_memory_bytes"].value_or(int64_t{0}));
+        return step;
+    }
+
+    static toml::table WriteStep(const StepRecord& step) {
+        return toml::table{{"wall_seconds", step.wall_seconds},
+                           {"cpu_seconds", step.cpu_seconds},
+                           {"peak_memory_bytes", static_cast<int64_t>(step.peak_memory_bytes)}};
+    }
+
+    fs::path BuildHistory::DefaultPath() {
+        return fs::path("gcpkg/history/build_history.toml");
+    }
+
+    bool BuildHistory::Load(const fs::path& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        records_.clear();
+
+        if (!fs::exists(path)) {
+            return true;
+        }
+
+        toml::table history_toml;
+        try {
+            history_toml = toml::parse_file(path.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 构建历史文件 " << path << " 已损坏，将被重建: " << err << std::endl;
+            return false;
+        }
+
+        // 旧格式的 CPU 时间和内存峰值可能取自整个会话容器，包含了并行的其他构建
+        const bool isolated_usage = history_toml["version"].value_or(int64_t{1}) >= kFormatVersion;
+        for (auto&& [key, node] : history_toml) {
+            auto record_table = node.as_table();
+            if (!record_table) continue;
+
+            BuildRecord record;
+            record.port_hash = std::string(key.str());
+            record.spec = (*record_table)["spec"].value_or("");
+            record.samples = (*record_table)["samples"].value_or(int64_t{1});
+            record.timestamp = (*record_table)["timestamp"].value_or(int64_t{0});
+            record.buildtree_bytes =
+                static_cast<uint64_t>((*record_table)["buildtree_bytes"].value_or(int64_t{0}));
+
+            StepRecord totals = ReadStep(*record_table);
+            record.wall_seconds = totals.wall_seconds;
+            record.cpu_seconds = totals.cpu_seconds;
+            record.peak_memory_bytes = totals.peak_memory_bytes;
+
+            if (auto steps_table = (*record_table)["steps"].as_table()) {
+                for (auto&& [step_name, step_node] : *steps_table) {
+                    if (auto step_table = step_node.as_table()) {
+                        record.steps[std::string(step_name.str())] = ReadStep(*step_table);
+                    }
+                }
+            }
+            if (!isolated_usage) {
+                record.cpu_seconds = 0.0;
+                record.peak_memory_bytes = 0;
+                for (auto& [step_name, step] : record.steps) step = {step.wall_seconds, 0.0, 0};
+            }
+            records_[record.port_hash] = std::move(record);
+        }
+        return true;
+    }
+
+    bool BuildHistory::Save() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (path_.empty()) return false;
+
+        toml::table history_toml{{"version", kFormatVersion}};
+        for (const auto& [port_hash, record] : records_) {
+            toml::table record_table = WriteStep({record.wall_seconds, record.cpu_seconds, record.peak_memory_bytes});
+            record_table.insert_or_assign("spec", record.spec);
+            record_table.insert_or_assign("samples", record.samples);
+            record_table.insert_or_assign("timestamp", record.timestamp);
+            record_table.insert_or_assign("buildtree_bytes", static_cast<int64_t>(record.buildtree_bytes));
+
+            toml::table steps_table;
+            for (const auto& [step_name, step] : record.steps) {
+                steps_table.insert_or_assign(step_name, WriteStep(step));
+            }
+            record_table.insert_or_assign("steps", std::move(steps_table));
+            history_toml.insert_or_assign(port_hash, std::move(record_table));
+        }
+
+        std::error_code ec;
+        fs::create_directories(path_.parent_path(), ec);
+
+        // 先写临时文件再重命名，避免中断时留下半截的数据库
+        fs::path temp_path = path_;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入构建历史文件 " << temp_path << std::endl;
+                return false;
+            }
+            file << history_toml;
+        }
+        fs::rename(temp_path, path_, ec);
+        return !ec;
+    }
+
+    void BuildHistory::Record(const BuildRecord& record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = records_.find(record.port_hash);
+        if (it == records_.end()) {
+            BuildRecord fresh = record;
+            fresh.samples = 1;
+            records_[record.port_hash] = std::move(fresh);
+            return;
+        }
+
+        BuildRecord& existing = it->second;
+        existing.spec = record.spec;
+        existing.wall_seconds = Blend(existing.wall_seconds, record.wall_seconds);
+        // 没有独立 cgroup 的构建不记录 CPU 时间 (为 0)，不参与平均
+        if (record.cpu_seconds > 0) existing.cpu_seconds = Blend(existing.cpu_seconds, record.cpu_seconds);
+        // 内存峰值用于资源规划，保守地取历史最大值
+        existing.peak_memory_bytes = std::max(existing.peak_memory_bytes, record.peak_memory_bytes);
+        existing.buildtree_bytes = std::max(existing.buildtree_bytes, record.buildtree_bytes);
+        existing.timestamp = record.timestamp;
+        existing.samples += 1;
+
+        for (const auto& [step_name, step] : record.steps) {
+            auto step_it = existing.steps.find(step_name);
+            if (step_it == existing.steps.end()) {
+                existing.steps[step_name] = step;
+                continue;
+            }
+            step_it->second.wall_seconds = Blend(step_it->second.wall_seconds, step.wall_seconds);
+            if (step.cpu_seconds > 0) {
+                step_it->second.cpu_seconds = Blend(step_it->second.cpu_seconds, step.cpu_seconds);
+            }
+            step_it->second.peak_memory_bytes = std::max(step_it->second.peak_memory_bytes, step.peak_memory_bytes);
+        }
+    }
+
+    bool BuildHistory::Find(const std::string& spec, const std::string& port_hash, BuildRecord& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = records_.find(port_hash); it != records_.end()) {
+            out = it->second;
+            return true;
+        }
+
+        // port 文件被修改过：使用同一个包最近一次的记录作为近似
+        const BuildRecord* latest = nullptr;
+        for (const auto& [hash, record] : records_) {
+            if (record.spec == spec && (!latest || record.timestamp > latest->timestamp)) {
+                latest = &record;
+            }
+        }
+        if (!latest) return false;
+        out = *latest;
+        return true;
+    }
+
+    double BuildHistory::EstimateSeconds(const std::string& spec, const std::string& port_hash) const {
+        BuildRecord record;
+        if (Find(spec, port_hash, record)) {
+            return record.wall_seconds;
+        }
+        return kDefaultEstimateSeconds;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef MAINPROCESS_BUILDHISTORY_H
+#define MAINPROCESS_BUILDHISTORY_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace MainProcess {
+
+    // 单个构建步骤 (configure, build, ...) 的资源消耗
+    struct StepRecord {
+        double wall_seconds = 0.0;
+        double cpu_seconds = 0.0;
+        uint64_t peak_memory_bytes = 0;
+    };
+
+    using StepRecords = std::map<std::string, StepRecord>;
+
+    // 一个软件包的完整构建记录
+    struct BuildRecord {
+        std::string spec;
+        std::string port_hash;
+        double wall_seconds = 0.0;
+        double cpu_seconds = 0.0;
+        uint64_t peak_memory_bytes = 0;
+        uint64_t buildtree_bytes = 0;  // 构建结束时构建目录的大小，决定能否放在 tmpfs 上
+        int64_t samples = 0;    // 已合并的构建次数
+        int64_t timestamp = 0;  // 最近一次构建完成的 Unix 时间
+        StepRecords steps;
+    };
+
+    /**
+     * @brief 本地构建耗时数据库。
+     *
+     * 以 port.toml 的内容摘要为键，记录每个包及其每个步骤的墙钟时间、CPU 时间和内存峰值。
+     * 数据保存在 gcpkg/history/build_history.toml 中，用于调度时优先执行关键路径，
+     * 以及 `gcpkg plan --estimate` 的耗时预测。所有公共方法都是线程安全的。
+     */
+    class BuildHistory {
+      public:
+        // 没有任何历史数据时假定的单包构建时间 (秒)
+        static constexpr double kDefaultEstimateSeconds = 60.0;
+        // 2：CPU 时间和内存峰值只来自有独立 cgroup 的构建，可以用来设置硬限制
+        static constexpr int64_t kFormatVersion = 2;
+
+        static std::filesystem::path DefaultPath();
+
+        // 从文件加载历史记录；文件不存在时视为空数据库
+        bool Load(const std::filesystem::path& path = DefaultPath());
+        bool Save() const;
+
+        // 合并一次新的构建结果 (指数加权平均，使估计值跟随最近的构建)
+        void Record(const BuildRecord& record);
+
+        /**
+         * @brief 查找构建记录。
+         *
+         * 优先按 port 摘要精确匹配；port 文件修改后摘要变化，此时回退到同一描述符最近的记录。
+         *
+         * @return 是否找到记录。
+         */
+        bool Find(const std::string& spec, const std::string& port_hash, BuildRecord& out) const;
+
+        // 估计构建时间 (秒)，没有记录时返回 kDefaultEstimateSeconds
+        double EstimateSeconds(const std::string& spec, const std::string& port_hash) const;
+
+      private:
+        mutable std::mutex mutex_;
+        std::filesystem::path path_;
+        std::map<std::string, BuildRecord> records_;  // port_hash -> record
+    };
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_BUILDHISTORY_H
\ No newline at end of file
@@ -1,37 +1,95 @@
 #include "MainProcess/BuildPlanner.h"
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 
+#include "Basic/DockerExecutor/ContainerStats.h"
 #include "Basic/DockerExecutor/ExecuteInContainer.h"
+#include "Basic/Log/Log.h"
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/ContentHash.h"
+#include "Basic/Utils/FileLock.h"
 #include "Basic/Utils/VariableProcessor.h"
 #include "MainProcess/BuildSystemAnalysis.h"
-#include "MainProcess/GcpkgMetaCommand/DecompressCommand.h"
-#include "MainProcess/GcpkgMetaCommand/DownloadCommand.h"
+#include "MainProcess/GcpkgMetaCommand/MetaCommandRegistry.h"
+#include "MainProcess/InstallationContext.h"
+#include "MainProcess/PackageStore.h"
+#include "MainProcess/ResourceReport.h"
+#include "MainProcess/StepFingerprint.h"
 
 namespace fs = std::filesystem;
 namespace Utils = Basic::Utils;
 namespace GcpkgMetaCommand = MainProcess::GcpkgMetaCommand;
+namespace CommandExecutor = Basic::SystemIntegrate::CommandExecutor;
 
 namespace MainProcess {
 
-    BuildPlan CreateBuildPlan(const toml::table& port_toml, std::map<std::string, std::string>& variables) {
-        BuildPlan build_plan;
+    // 步骤失败时打印的日志行数
+    static constexpr size_t kFailureLogTailLines = 40;
 
-        // 1. 获取 build_configs 表
-        toml::table build_configs_table;
+    // 返回 build_configs 中指定的条目；不存在时返回空表
+    static toml::table GetBuildConfig(const toml::table& port_toml, size_t config_index) {
         auto build_configs_node = port_toml.get("build_configs");
         if (build_configs_node && build_configs_node->is_array()) {
             if (auto build_configs_array = build_configs_node->as_array()) {
-                if (!build_configs_array->empty()) {
-                    if (auto first_config_node = build_configs_array->get(0)) {
-                        if (auto first_config_table = first_config_node->as_table()) {
-                            build_configs_table = *first_config_table;
-                        }
+                if (config_index < build_configs_array->size()) {
+                    if (auto config_table = build_configs_array->get(config_index)->as_table()) {
+                        return *config_table;
                     }
                 }
             }
         }
+        return {};
+    }
+
+    SharedFetchResult SharedSourceFetches::RunOnce(const std::string& key,
+                                                   const std::function<SharedFetchResult()>& fetch) {
+        std::promise<SharedFetchResult> promise;
+        std::shared_future<SharedFetchResult> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = results_.find(key);
+            if (it != results_.end()) {
+                result = it->second;
+            } else {
+                results_[key] = promise.get_future().share();
+            }
+        }
+        if (result.valid()) {
+            std::cout << "--- Reusing source fetched by another build config ---" << std::endl;
+            Basic::Metrics::CacheLookups("shared_fetch", true).Add();
+            return result.get();
+        }
+        Basic::Metrics::CacheLookups("shared_fetch", false).Add();
+
+        SharedFetchResult value;
+        try {
+            value = fetch();
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        promise.set_value(value);
+        return value;
+    }
+
+    std::shared_mutex& SharedSourceFetches::SourceMutex(const std::string& source_dir) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return source_mutexes_[source_dir];
+    }
+
+    BuildPlan CreateBuildPlan(const toml::table& port_toml,
+                              std::map<std::string, std::string>& variables,
+                              size_t config_index) {
+        BuildPlan build_plan;
+
+        // 1. 获取要构建的 build_configs 条目
+        toml::table build_configs_table = GetBuildConfig(port_toml, config_index);
 
         if (build_configs_table.empty()) {
             std::cout << "--- Note: No valid [build_configs] table found. Proceeding without build steps. ---"
@@ -55,7 +113,10 @@ namespace MainProcess {
 
         // 3. 应用 inject 和 export_build_system
         ApplyInjects(build_plan, port_toml);
-        ApplyExportedBuildSystem(build_plan, build_configs_table, port_toml, variables);
+        static const BuildSystemRegistry kEmptyRegistry;
+        InstallationContext* context = GetCurrentContext();
+        const BuildSystemRegistry& registry = context ? context->buildSystems : kEmptyRegistry;
+        ApplyExportedBuildSystem(build_plan, build_configs_table, registry, variables);
 
         return build_plan;
     }
@@ -64,8 +125,9 @@ namespace MainProcess {
                           const BuildPlan& plan,
                           const toml::table& port_toml,
                           std::map<std::string, std::string>& variables,
-                          const std::string& env_prefix_command) {
-        GcpkgMetaCommand::MetaCommandContext meta_context{"", variables};
+                          const std::string& env_prefix_command,
+                          const ExecuteOptions& options) {
+        GcpkgMetaCommand::MetaCommandContext meta_context{"", variables, ""};
         variables["${last_file}"] = "";  // 初始化
 
         const std::vector<std::string> build_steps = {
@@ -73,71 +135,281 @@ namespace MainProcess {
 
         fs::path gcpkg_root = fs::absolute(fs::current_path());
 
-        // 1. 获取 build_configs 表以查找工作目录
-        toml::table build_configs_table;
-        auto build_configs_node = port_toml.get("build_configs");
-        if (build_configs_node && build_configs_node->is_array()) {
-            if (auto build_configs_array = build_configs_node->as_array()) {
-                if (!build_configs_array->empty()) {
-                    if (auto first_config_node = build_configs_array->get(0)) {
-                        if (auto first_config_table = first_config_node->as_table()) {
-                            build_configs_table = *first_config_table;
-                        }
-                    }
-                }
-            }
+        // 1. 获取 build_configs 条目以查找工作目录
+        toml::table build_configs_table = GetBuildConfig(port_toml, options.config_index);
+
+        // 超时设置 (秒)，0 表示不限时
+        const int64_t command_timeout = build_configs_table["command_timeout"].value_or(int64_t{0});
+
+        // 资源采样需要容器的 cgroup，由协调器在会话开始时解析一次；构建有自己的子 cgroup 时只采样子组
+        InstallationContext* context = GetCurrentContext();
+        Basic::DockerExecutor::ContainerCgroup cgroup = options.cgroup;
+        ResourceReport* report = nullptr;
+        if (context) {
+            if (!cgroup.valid()) cgroup = context->containerCgroup;
+            report = context->resourceReport;
+        }
+
+        // 下载、解压和打补丁的结果在同一个包的各个构建配置之间共享
+        auto fetch_shared = [&](const std::string& cmd, const std::function<SharedFetchResult()>& fetch) {
+            if (!context) return fetch();
+            return context->sharedFetches.RunOnce(
+                variables["${source_dir}"] + "\n" + Utils::ExpandVariables(cmd, variables), fetch);
+        };
+
+        // 2. 加载步骤日志，用于跳过上次已完成的步骤
+        const fs::path build_dir = Utils::ExpandVariables("${build_dir}", variables);
+        BuildStepJournal journal(build_dir);
+        journal.Load();
+        const bool was_complete = journal.complete;
+        journal.complete = false;
+        std::string upstream = ComputeUpstreamFingerprint(port_toml);
+        bool resuming = true;  // 一旦有步骤被执行，之后的步骤都必须执行
+        bool skipped_any = false;
+        // 额外构建配置的源码目录是主配置的构建目录，gc 清理它时只在主配置的步骤日志中做标记
+        const fs::path source_dir = Utils::ExpandVariables("${source_dir}", variables);
+        BuildStepJournal source_journal(source_dir);
+        if (source_dir != build_dir) source_journal.Load();
+        const bool pruned = journal.pruned || source_journal.pruned;
+
+        // 已完成的构建的安装目录被删除时，按存储清单只用链接重建，安装阶段的步骤因此可以跳过
+        const fs::path package_install_dir = Utils::ExpandVariables("${package_install_dir}", variables);
+        const fs::path store_manifest = PackageStore::ManifestPath(build_dir);
+        std::error_code store_ec;
+        if (was_complete && fs::exists(store_manifest, store_ec) &&
+            (!fs::exists(package_install_dir, store_ec) || fs::is_empty(package_install_dir, store_ec)) &&
+            !PackageStore().Restore(store_manifest, package_install_dir)) {
+            // 恢复失败时丢弃不完整的安装目录和清单，安装阶段的步骤因产物缺失而重新执行
+            std::cout << "--- Could not restore from the store. Rebuilding the install tree. ---" << std::endl;
+            fs::remove_all(package_install_dir, store_ec);
+            fs::create_directories(package_install_dir, store_ec);
+            fs::remove(store_manifest, store_ec);
         }
 
         for (const auto& step : build_steps) {
-            if (plan.count(step) && !plan.at(step).empty()) {
-                std::cout << "--- Executing step: " << step << " ---" << std::endl;
+            if (!plan.count(step) || plan.at(step).empty()) {
+                continue;
+            }
 
-                std::string work_dir_key = step + "_work_dir";
-                std::string work_dir = gcpkg_root.string();
+            std::string work_dir_key = step + "_work_dir";
+            std::string work_dir = gcpkg_root.string();
 
-                auto work_dir_node = build_configs_table.get(work_dir_key);
-                if (work_dir_node && work_dir_node->is_array()) {
-                    if (auto work_dir_arr = work_dir_node->as_array()) {
-                        if (!work_dir_arr->empty()) {
-                            work_dir = work_dir_arr->get(0)->value_or(work_dir);
-                        }
+            auto work_dir_node = build_configs_table.get(work_dir_key);
+            if (work_dir_node && work_dir_node->is_array()) {
+                if (auto work_dir_arr = work_dir_node->as_array()) {
+                    if (!work_dir_arr->empty()) {
+                        work_dir = work_dir_arr->get(0)->value_or(work_dir);
                     }
                 }
+            }
+            std::string expanded_work_dir = Utils::ExpandVariables(work_dir, variables);
 
-                for (const auto& cmd : plan.at(step)) {
-                    if (cmd.empty()) continue;
+            // 2.1 计算步骤指纹；指纹未变且产物完好时跳过该步骤
+            std::vector<std::string> expanded_cmds;
+            for (const auto& cmd : plan.at(step)) {
+                expanded_cmds.push_back(Utils::ExpandVariables(cmd, variables));
+            }
+            std::string fingerprint =
+                ComputeStepFingerprint(upstream, step, expanded_cmds, expanded_work_dir, env_prefix_command);
 
-                    if (cmd.rfind("inner_download ", 0) == 0) {
-                        std::string url_arg = cmd.substr(15);
-                        std::string downloaded_file = GcpkgMetaCommand::Download(meta_context, url_arg);
-                        if (downloaded_file.empty()) {
-                            std::cerr << "错误: 元命令 'inner_download' 执行失败。" << std::endl;
-                            return false;
-                        }
-                        variables["${last_file}"] = downloaded_file;
+            const StepState* previous = journal.Find(step);
+            if (resuming && previous && previous->fingerprint == fingerprint &&
+                StepOutputsIntact(step, *previous, package_install_dir)) {
+                std::cout << "--- Step '" << step << "' is up to date. Skipping. ---" << std::endl;
+                Basic::Metrics::CacheLookups("build_step", true).Add();
+                variables["${last_file}"] = previous->last_file;
+                meta_context.last_downloaded_file = previous->last_file;
+                upstream = fingerprint;
+                for (const auto& [file, hash] : previous->downloads) upstream += ":" + hash;
+                skipped_any = true;
+                continue;
+            }
+            if (resuming && pruned && skipped_any) {
+                // gc 删除了构建目录的内容，已跳过的步骤的产物不复存在，只能从第一个步骤重新构建
+                std::cout << "--- Build tree was pruned by gc. Rebuilding from the first step. ---" << std::endl;
+                BuildStepJournal(build_dir).Save();
+                return ExecuteBuildPlan(container_name, plan, port_toml, variables, env_prefix_command, options);
+            }
+            journal.pruned = false;
+            if (resuming && previous) {
+                std::cout << "--- Step '" << step << "' changed since last run. Resuming from here. ---" << std::endl;
+            }
+            if (resuming && fs::exists(store_manifest, store_ec)) {
+                // 安装目录中的文件可能是存储对象的硬链接，重新执行步骤之前先解除共享
+                if (!BreakSharedLinks(package_install_dir)) return false;
+                fs::remove(store_manifest, store_ec);
+            }
+            resuming = false;
+            journal.InvalidateFrom(step, build_steps);
+            journal.Save();
 
-                    } else if (cmd.rfind("inner_decompress ", 0) == 0) {
-                        std::string file_to_decompress = cmd.substr(17);
-                        if (!GcpkgMetaCommand::Decompress(meta_context, file_to_decompress)) {
-                            std::cerr << "错误: 元命令 'inner_decompress' 执行失败。" << std::endl;
-                            return false;
+            // 源码目录被同一个包的各构建配置共享：主配置在源码目录中构建，额外配置的元命令会改写它。
+            // 修改源码的步骤独占源码锁，其余步骤只读取源码，可以在进程内并行；其他 gcpkg 进程整体互斥
+            bool mutates_source = source_dir == build_dir;
+            for (const auto& cmd : plan.at(step)) {
+                std::string meta_args;
+                const auto* meta = GcpkgMetaCommand::MetaCommandRegistry::Instance().Match(cmd, meta_args);
+                if (meta && meta->shares_source) mutates_source = true;
+            }
+            std::unique_ptr<Basic::Utils::FileLock> source_file_lock;
+            if (!options.source_lock.empty()) {
+                source_file_lock = Basic::Utils::FileLock::Acquire(options.source_lock, "sources of " + options.package,
+                                                                   options.stop_token);
+                if (!source_file_lock) {
+                    std::cerr << "错误: 构建已被取消，步骤 '" << step << "' 未完成。" << std::endl;
+                    return false;
+                }
+            }
+            std::unique_lock<std::shared_mutex> source_write_lock;
+            std::shared_lock<std::shared_mutex> source_read_lock;
+            if (context) {
+                std::shared_mutex& source_mutex = context->sharedFetches.SourceMutex(source_dir.string());
+                if (mutates_source) {
+                    source_write_lock = std::unique_lock<std::shared_mutex>(source_mutex);
+                } else {
+                    source_read_lock = std::shared_lock<std::shared_mutex>(source_mutex);
+                }
+            }
+
+            std::cout << "--- Executing step: " << step << " ---" << std::endl;
+            Basic::Metrics::CacheLookups("build_step", false).Add();
+            Basic::Trace::Span step_span("step", step);
+            const auto step_start = std::chrono::steady_clock::now();
+            const int64_t step_timeout = build_configs_table[step + "_timeout"].value_or(int64_t{0});
+            Basic::DockerExecutor::ResourceSampler sampler(cgroup);
+            const fs::path step_log = BuildLogDir(build_dir) / (step + ".log");
+            std::error_code log_ec;
+            fs::create_directories(step_log.parent_path(), log_ec);
+            std::ofstream(step_log, std::ios::trunc);  // 每次执行步骤都重新记录
+            StepState state;
+            state.fingerprint = fingerprint;
+
+            // 每条命令结束时记入资源报告；容器内的命令取采样器的分段读数
+            auto command_start = std::chrono::steady_clock::now();
+            auto record_command =
+                [&](const std::string& command, bool meta, const Basic::DockerExecutor::ResourceUsage& usage) {
+                    const auto now = std::chrono::steady_clock::now();
+                    if (report) {
+                        const double wall_seconds = std::chrono::duration<double>(now - command_start).count();
+                        report->Add({options.package, step, command, meta, wall_seconds, usage});
+                    }
+                    command_start = now;
+                };
+
+            for (const auto& cmd : plan.at(step)) {
+                if (cmd.empty()) continue;
+                if (options.stop_token.stop_requested()) {
+                    std::cerr << "错误: 构建已被取消，步骤 '" << step << "' 未完成。" << std::endl;
+                    return false;
+                }
+
+                std::string meta_args;
+                if (const auto* meta = GcpkgMetaCommand::MetaCommandRegistry::Instance().Match(cmd, meta_args)) {
+                    meta_context.work_dir = expanded_work_dir;
+                    Basic::Trace::Span meta_span("meta", meta->name);
+                    meta_span.Arg("args", meta_args);
+                    const auto thread_start = Basic::DockerExecutor::CurrentThreadUsage();
+                    auto run = [&] {
+                        const std::map<std::string, std::string> before = variables;
+                        SharedFetchResult fetched;
+                        fetched.success = meta->run(meta_context, meta_args);
+                        fetched.last_downloaded_file = meta_context.last_downloaded_file;
+                        for (const auto& [name, value] : variables) {
+                            auto it = before.find(name);
+                            if (it == before.end() || it->second != value) fetched.variables[name] = value;
                         }
+                        return fetched;
+                    };
+                    // 共享源码目录的命令只对包的第一个构建配置执行，其余配置复用结果和它设置的变量
+                    SharedFetchResult result = meta->shares_source ? fetch_shared(cmd, run) : run();
+                    sampler.Lap();  // 元命令不在容器内执行，丢弃这一段的容器读数
+                    const auto thread_end = Basic::DockerExecutor::CurrentThreadUsage();
+                    record_command(meta->name, true, Basic::DockerExecutor::UsageBetween(thread_start, thread_end));
+                    if (!result.success) {
+                        std::cerr << "错误: 元命令 '" << meta->name << "' 执行失败。" << std::endl;
+                        return false;
+                    }
+                    for (const auto& [name, value] : result.variables) variables[name] = value;
+                    if (meta->produces_download) {
+                        std::string downloaded_file = result.last_downloaded_file;
+                        meta_context.last_downloaded_file = downloaded_file;
+                        variables["${last_file}"] = downloaded_file;
+                        state.downloads[downloaded_file] = HashDownload(downloaded_file);
+                    }
 
-                    } else {
-                        std::string expanded_cmd = Utils::ExpandVariables(cmd, variables);
-                        std::string expanded_work_dir = Utils::ExpandVariables(work_dir, variables);
-                        std::string final_command = env_prefix_command + expanded_cmd;
+                } else {
+                    std::string expanded_cmd = Utils::ExpandVariables(cmd, variables);
+                    std::string final_command = options.exec_prefix + env_prefix_command + expanded_cmd;
 
-                        if (!Basic::DockerExecutor::ExecuteInContainer(
-                                container_name, expanded_work_dir, final_command)) {
-                            std::cerr << "错误: 在步骤 '" << step << "' 中执行命令失败: " << final_command << std::endl;
+                    // 单条命令的时限取 command_timeout 与步骤剩余时间中较小的一个
+                    CommandExecutor::CommandLimits limits;
+                    limits.stop_token = options.stop_token;
+                    limits.timeout = std::chrono::seconds(command_timeout);
+                    limits.log_file = step_log.string();
+                    if (step_timeout > 0) {
+                        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            step_start + std::chrono::seconds(step_timeout) - std::chrono::steady_clock::now());
+                        if (remaining.count() <= 0) {
+                            std::cerr << "错误: 步骤 '" << step << "' 超过了 " << step_timeout << " 秒的时限。"
+                                      << std::endl;
                             return false;
                         }
+                        if (limits.timeout.count() == 0 || remaining < limits.timeout) limits.timeout = remaining;
+                    }
+
+                    Basic::Trace::Span command_span("command", expanded_cmd.substr(0, 80));
+                    auto status = Basic::DockerExecutor::ExecuteInContainer(
+                        container_name, expanded_work_dir, final_command, limits);
+                    command_span.Arg("status", static_cast<int64_t>(status));
+                    record_command(expanded_cmd.substr(0, 120), false, sampler.Lap());
+                    if (status != CommandExecutor::CommandStatus::Success) {
+                        std::cerr << "错误: 在步骤 '" << step << "' 中执行命令失败: " << final_command << std::endl;
+                        Basic::Log::PrintTail(step_log, kFailureLogTailLines);
+                        return false;
                     }
                 }
             }
+
+            if (options.step_records) {
+                Basic::DockerExecutor::ResourceUsage usage = sampler.Stop();
+                StepRecord& record = (*options.step_records)[step];
+                record.wall_seconds =
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count();
+                // 没有独立 cgroup 时读数来自整个会话容器，包含并行的其他构建，不能作为本包的资源消耗
+                if (options.cgroup.valid()) {
+                    record.cpu_seconds = usage.cpu_seconds;
+                    record.peak_memory_bytes = usage.peak_memory_bytes;
+                }
+            }
+
+            // 2.2 记录已完成的步骤，下一步骤的上游指纹包含本步骤下载产物的摘要
+            upstream = fingerprint;
+            for (const auto& [file, hash] : state.downloads) upstream += ":" + hash;
+            state.last_file = variables["${last_file}"];
+            journal.MarkCompleted(step, std::move(state));
+            journal.Save();
+        }
+
+        journal.complete = true;
+        journal.final_fingerprint = Basic::Utils::HashString(upstream);
+        journal.port_hash = options.port_hash;
+        journal.Save();
+
+        // 安装树放入按内容寻址的存储，与其他版本和构建配置中相同的文件共享空间
+        if (!fs::exists(store_manifest, store_ec)) {
+            PackageStore().Ingest(package_install_dir, store_manifest);
         }
+        FileHashCache().Save();
         return true;
     }
 
+    fs::path BuildLogDir(const fs::path& build_dir) {
+        return build_dir / ".gcpkg_logs";
+    }
+
+    std::set<std::string> BuildTreeMetadata(const fs::path& build_dir) {
+        return {BuildStepJournal::kFileName, PackageStore::ManifestPath(build_dir).filename().string(),
+                BuildLogDir(build_dir).filename().string(), "_downloads"};
+    }
+
 }  // namespace MainProcess
\ No newline at end of file
@@ -1,16 +1,66 @@
 #ifndef MAINPROCESS_BUILDPLANNER_H
 #define MAINPROCESS_BUILDPLANNER_H
 
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <stop_token>
 #include <string>
 #include <vector>
 
+#include "Basic/DockerExecutor/ContainerStats.h"
+#include "MainProcess/BuildHistory.h"
 #include "toml++/toml.hpp"
 
 namespace MainProcess {
 
     using BuildPlan = std::map<std::string, std::vector<std::string>>;
 
+    // 一次共享的源码获取 (元命令) 的结果
+    struct SharedFetchResult {
+        bool success = false;
+        std::string last_downloaded_file;
+        std::map<std::string, std::string> variables;  // 元命令设置或修改的变量，如 ${git_commit}
+    };
+
+    /**
+     * @brief 会话内共享的源码获取结果。
+     *
+     * 同一个包的多个构建配置执行相同的 inner_download / inner_decompress 时，只有第一个真正执行，
+     * 其余的 (包括并发执行的) 等待并复用它的结果，因此 debug + release 只需一次下载和一次解压。
+     * 结果中包含元命令设置的变量，复用结果的构建配置同样得到这些变量。
+     */
+    class SharedSourceFetches {
+      public:
+        // 以 key 为单位只执行一次 fetch，返回其结果；fetch 抛出的异常同样传给所有等待者
+        SharedFetchResult RunOnce(const std::string& key, const std::function<SharedFetchResult()>& fetch);
+
+        // 源码目录的进程内读写锁：修改源码的步骤独占，只读取源码的步骤共享
+        std::shared_mutex& SourceMutex(const std::string& source_dir);
+
+      private:
+        std::mutex mutex_;
+        std::map<std::string, std::shared_future<SharedFetchResult>> results_;
+        std::map<std::string, std::shared_mutex> source_mutexes_;
+    };
+
+    // ExecuteBuildPlan 的可选参数
+    struct ExecuteOptions {
+        size_t config_index = 0;              // 要构建的 build_configs 条目
+        std::string exec_prefix;              // 加在每条命令最前面、但不参与步骤指纹的前缀 (如 cgroup 进入脚本)
+        StepRecords* step_records = nullptr;  // 用于接收每个已执行步骤的耗时和资源消耗
+        std::string port_hash;                // 记录到步骤日志中，供 outdated/rebuild 判断包是否过期
+        std::stop_token stop_token;           // 请求停止时终止正在执行的命令并返回 false
+        std::string package;                  // 资源报告中记录的包规格
+        std::filesystem::path source_lock;    // 非空时，每个步骤都在该跨进程锁下执行
+        // 命令所在的 cgroup，用于资源采样；无效时采样整个会话容器
+        Basic::DockerExecutor::ContainerCgroup cgroup;
+    };
+
     /**
      * @brief 创建构建计划。
      *
@@ -19,9 +69,12 @@ namespace MainProcess {
      *
      * @param port_toml 当前软件包的配置文件。
      * @param variables 包含已解析变量的映射表，用于可能的替换。
+     * @param config_index 要构建的 build_configs 条目。
      * @return 一个表示构建计划的 map。
      */
-    BuildPlan CreateBuildPlan(const toml::table& port_toml, std::map<std::string, std::string>& variables);
+    BuildPlan CreateBuildPlan(const toml::table& port_toml,
+                              std::map<std::string, std::string>& variables,
+                              size_t config_index = 0);
 
     /**
      * @brief 执行构建计划。
@@ -29,18 +82,35 @@ namespace MainProcess {
      * 按预定顺序（pre_configure, configure, ...）执行构建计划中的所有命令。
      * 命令在指定的 Docker 容器内执行。
      *
+     * 每个步骤的指纹 (展开后的命令、工作目录、环境变量前缀、上游指纹和下载产物摘要) 会记录在
+     * ${build_dir}/.gcpkg_steps.toml 中。重新执行时，指纹未变且产物完好的前缀步骤会被跳过，
+     * 从第一个发生变化或上次失败的步骤继续。
+     *
+     * build_configs 中的 `<step>_timeout` 限制整个步骤的秒数，`command_timeout` 限制每条命令的秒数；
+     * 超时的命令连同它在容器内启动的整个进程树一起被终止。
+     *
+     * 每个步骤中命令的输出写入 BuildLogDir(${build_dir})/<step>.log；步骤失败时打印该日志的末尾。
+     *
      * @param container_name 用于执行命令的 Docker 容器的名称。
      * @param plan 要执行的构建计划。
      * @param port_toml 当前软件包的配置文件，用于获取工作目录等信息。
      * @param variables 包含所有环境变量的映射表。
      * @param env_prefix_command 为命令添加的环境变量前缀（例如 "env PATH=... "）。
+     * @param options 可选参数。
      * @return true 如果所有步骤都成功执行，否则返回 false。
      */
     bool ExecuteBuildPlan(const std::string& container_name,
                           const BuildPlan& plan,
                           const toml::table& port_toml,
                           std::map<std::string, std::string>& variables,
-                          const std::string& env_prefix_command);
+                          const std::string& env_prefix_command,
+                          const ExecuteOptions& options = {});
+
+    // 构建目录中保存包日志 (package.log) 和各步骤日志 (<step>.log) 的目录
+    std::filesystem::path BuildLogDir(const std::filesystem::path& build_dir);
+
+    // 构建目录中构建产物以外的顶层条目：步骤日志、存储清单、日志目录和 _downloads
+    std::set<std::string> BuildTreeMetadata(const std::filesystem::path& build_dir);
 
 }  // namespace MainProcess
 
@@ -0,0 +1,228 @@
+#include "MainProcess/BuildScheduler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+
+#include "Basic/Trace/Trace.h"
+
+namespace MainProcess {
+
+    std::map<std::string, double> ComputeCriticalPathPriorities(const DependencyGraph& graph,
+                                                                const BuildHistory& history) {
+        std::map<std::string, double> priorities;
+        const auto dependents = graph.Dependents();
+
+        std::function<double(const std::string&)> priority_of = [&](const std::string& spec) -> double {
+            if (auto it = priorities.find(spec); it != priorities.end()) {
+                return it->second;
+            }
+            const PackageNode& node = graph.nodes.at(spec);
+            if (node.installed) {
+                return priorities[spec] = 0.0;
+            }
+
+            double longest_tail = 0.0;
+            if (auto it = dependents.find(spec); it != dependents.end()) {
+                for (const auto& dependent : it->second) {
+                    longest_tail = std::max(longest_tail, priority_of(dependent));
+                }
+            }
+            return priorities[spec] = history.EstimateSeconds(node.spec, node.port_hash) + longest_tail;
+        };
+
+        for (const auto& [spec, node] : graph.nodes) {
+            priority_of(spec);
+        }
+        return priorities;
+    }
+
+    namespace {
+
+        // 调度器共用的就绪队列：按优先级降序，优先级相同时按描述符排序以保证结果可复现
+        struct ReadyQueue {
+            const std::map<std::string, double>& priorities;
+            std::set<std::pair<double, std::string>, std::greater<>> queue;
+
+            void Push(const std::string& spec) {
+                queue.emplace(priorities.at(spec), spec);
+            }
+            bool Empty() const {
+                return queue.empty();
+            }
+
+            // 返回优先级最高且能通过准入控制的包；没有时返回空字符串
+            std::string FindAdmissible(const ResourceLedger& ledger,
+                                       const std::map<std::string, ResourceFootprint>& footprints) const {
+                for (const auto& [priority, spec] : queue) {
+                    if (ledger.CanAdmit(footprints.at(spec))) return spec;
+                }
+                return "";
+            }
+            void Erase(const std::string& spec) {
+                queue.erase({priorities.at(spec), spec});
+            }
+        };
+
+        std::map<std::string, ResourceFootprint> EstimateFootprints(const DependencyGraph& graph,
+                                                                    const BuildHistory& history,
+                                                                    const HostBudget& budget) {
+            std::map<std::string, ResourceFootprint> footprints;
+            for (const auto& [spec, node] : graph.nodes) {
+                if (!node.installed) {
+                    footprints[spec] = EstimateFootprint(node, history, budget);
+                }
+            }
+            return footprints;
+        }
+
+        // 统计每个待构建包尚未完成的依赖数量，并把已经就绪的包放入队列
+        std::map<std::string, int> InitPendingCounts(const DependencyGraph& graph, ReadyQueue& ready) {
+            std::map<std::string, int> pending;
+            for (const auto& [spec, node] : graph.nodes) {
+                if (node.installed) continue;
+                int count = 0;
+                for (const auto& dep : node.dependencies) {
+                    if (!graph.nodes.at(dep).installed) ++count;
+                }
+                pending[spec] = count;
+                if (count == 0) ready.Push(spec);
+            }
+            return pending;
+        }
+
+    }  // namespace
+
+    ScheduleEstimate EstimateSchedule(const DependencyGraph& graph,
+                                      const BuildHistory& history,
+                                      unsigned parallel_builds,
+                                      const HostBudget& budget) {
+        ScheduleEstimate estimate;
+        parallel_builds = std::max(1u, parallel_builds);
+
+        const auto priorities = ComputeCriticalPathPriorities(graph, history);
+        const auto footprints = EstimateFootprints(graph, history, budget);
+        const auto dependents = graph.Dependents();
+        ReadyQueue ready{priorities, {}};
+        auto pending = InitPendingCounts(graph, ready);
+        ResourceLedger ledger(budget);
+
+        // (预计完成时间, 描述符)，最早完成的在堆顶
+        using Running = std::pair<double, std::string>;
+        std::priority_queue<Running, std::vector<Running>, std::greater<>> running;
+        double now = 0.0;
+
+        while (!ready.Empty() || !running.empty()) {
+            while (running.size() < parallel_builds) {
+                const std::string spec = ready.FindAdmissible(ledger, footprints);
+                if (spec.empty()) break;
+                ready.Erase(spec);
+                ledger.Acquire(footprints.at(spec));
+                const PackageNode& node = graph.nodes.at(spec);
+
+                BuildRecord record;
+                ScheduleEstimate::Entry entry;
+                entry.spec = spec;
+                entry.start_seconds = now;
+                entry.from_history = history.Find(node.spec, node.port_hash, record);
+                entry.duration_seconds =
+                    entry.from_history ? record.wall_seconds : BuildHistory::kDefaultEstimateSeconds;
+                estimate.entries.push_back(entry);
+                running.emplace(now + entry.duration_seconds, spec);
+            }
+
+            auto [finish_time, finished] = running.top();
+            running.pop();
+            now = finish_time;
+            estimate.total_seconds = std::max(estimate.total_seconds, finish_time);
+            ledger.Release(footprints.at(finished));
+
+            if (auto it = dependents.find(finished); it != dependents.end()) {
+                for (const auto& dependent : it->second) {
+                    if (--pending[dependent] == 0) ready.Push(dependent);
+                }
+            }
+        }
+        return estimate;
+    }
+
+    bool RunBuildSchedule(const DependencyGraph& graph,
+                          const BuildHistory& history,
+                          unsigned parallel_builds,
+                          const HostBudget& budget,
+                          const BuildFunction& build) {
+        parallel_builds = std::max(1u, parallel_builds);
+
+        const auto priorities = ComputeCriticalPathPriorities(graph, history);
+        const auto footprints = EstimateFootprints(graph, history, budget);
+        const auto dependents = graph.Dependents();
+        ReadyQueue ready{priorities, {}};
+        auto pending = InitPendingCounts(graph, ready);
+        ResourceLedger ledger(budget);
+
+        const size_t total = pending.size();
+        size_t finished = 0;
+        bool failed = false;
+        std::stop_source stop;  // 任一包失败时取消其他正在进行的构建
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        auto worker = [&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                std::string spec;
+                cv.wait(lock, [&] {
+                    if (failed || finished == total) return true;
+                    spec = ready.FindAdmissible(ledger, footprints);
+                    return !spec.empty();
+                });
+                if (failed || finished == total) {
+                    return;
+                }
+
+                const ResourceFootprint& footprint = footprints.at(spec);
+                ready.Erase(spec);
+                ledger.Acquire(footprint);
+                lock.unlock();
+                bool ok = build(graph.nodes.at(spec), footprint, stop.get_token());
+                lock.lock();
+                ledger.Release(footprint);
+
+                if (!ok) {
+                    if (!failed) {
+                        std::cerr << "错误: 包 '" << spec << "' 构建失败，正在取消其他构建。" << std::endl;
+                    }
+                    failed = true;
+                    stop.request_stop();
+                } else {
+                    ++finished;
+                    if (auto it = dependents.find(spec); it != dependents.end()) {
+                        for (const auto& dependent : it->second) {
+                            if (--pending[dependent] == 0) ready.Push(dependent);
+                        }
+                    }
+                }
+                cv.notify_all();
+            }
+        };
+
+        const size_t worker_count = std::min<size_t>(parallel_builds, std::max<size_t>(total, 1));
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([&worker, i] {
+                Basic::Trace::SetThreadName("build worker " + std::to_string(i));
+                worker();
+            });
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        return !failed && finished == total;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef MAINPROCESS_BUILDSCHEDULER_H
+#define MAINPROCESS_BUILDSCHEDULER_H
+
+#include <functional>
+#include <map>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "MainProcess/BuildHistory.h"
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/ResourceBudget.h"
+
+namespace MainProcess {
+
+    // 对一次安装会话的耗时预测
+    struct ScheduleEstimate {
+        struct Entry {
+            std::string spec;
+            double start_seconds = 0.0;
+            double duration_seconds = 0.0;
+            bool from_history = false;  // false 表示没有历史记录，使用了默认值
+        };
+        std::vector<Entry> entries;  // 按预计开始时间排序
+        double total_seconds = 0.0;
+    };
+
+    // 构建单个包；stop_token 被请求停止时应尽快终止并返回 false
+    using BuildFunction = std::function<bool(const PackageNode&, const ResourceFootprint&, std::stop_token)>;
+
+    /**
+     * @brief 计算每个待构建包的关键路径优先级。
+     *
+     * 优先级 = 该包自身的预计耗时 + 所有依赖于它的包中最长的剩余链耗时。
+     * 当多个包同时就绪时，优先级高的先开始，从而让 LLVM 这类长依赖链尽早启动。
+     */
+    std::map<std::string, double> ComputeCriticalPathPriorities(const DependencyGraph& graph,
+                                                                const BuildHistory& history);
+
+    /**
+     * @brief 按与实际调度相同的策略模拟一次会话，预测每个包的开始时间和总耗时。
+     *
+     * @param parallel_builds 同时构建的包数量上限。
+     * @param budget 宿主机资源预算，模拟时与实际调度一样进行准入控制。
+     */
+    ScheduleEstimate EstimateSchedule(const DependencyGraph& graph,
+                                      const BuildHistory& history,
+                                      unsigned parallel_builds,
+                                      const HostBudget& budget);
+
+    /**
+     * @brief 按依赖关系和关键路径优先级执行所有待构建的包。
+     *
+     * 一个包只有在它的全部依赖都构建完成后才会就绪。就绪的包按优先级依次尝试准入：
+     * 只有其预计的内存和 CPU 占用能放进剩余预算时才会启动，放不下时让位给优先级较低但
+     * 能放下的包。任一包失败后不再启动新的构建，并通过 stop_token 立即取消正在进行的构建。
+     *
+     * @param parallel_builds 同时构建的包数量上限 (至少为 1)。
+     * @param budget 宿主机资源预算。
+     * @param build 构建单个包的回调，返回是否成功。
+     */
+    bool RunBuildSchedule(const DependencyGraph& graph,
+                          const BuildHistory& history,
+                          unsigned parallel_builds,
+                          const HostBudget& budget,
+                          const BuildFunction& build);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_BUILDSCHEDULER_H
\ No newline at end of file
@@ -2,18 +2,123 @@
 
 #include <filesystem>
 #include <iostream>
+#include <set>
 #include <thread>
 
 #include "Basic/Utils/VariableProcessor.h"
+#include "MainProcess/PortCache.h"
 
 namespace fs = std::filesystem;
 namespace Utils = Basic::Utils;
 
 namespace MainProcess {
 
+    // 步骤 -> export_build_system 中的命令键；install 兼容早期 port 中的拼写错误 "intstall_command"
+    static const std::map<std::string, std::vector<std::string>> kCommandKeys = {
+        {"configure", {"configure_command"}},
+        {"build", {"build_command"}},
+        {"install", {"install_command", "intstall_command"}}};
+
+    static BuildSystemExporter MakeExporter(const std::string& provider, const toml::table& system_table) {
+        BuildSystemExporter exporter;
+        exporter.name = system_table["name"].value_or("");
+        exporter.provider = provider;
+        const std::string jobs = std::to_string(std::thread::hardware_concurrency());
+
+        for (const auto& [step, keys] : kCommandKeys) {
+            for (const auto& key : keys) {
+                auto cmd = system_table[key].value<std::string>();
+                if (!cmd) continue;
+
+                // 处理选项：configure_command -> configure_option
+                std::string command_template = *cmd;
+                std::string option_key = key.substr(0, key.find("_command")) + "_option";
+                if (auto options = system_table[option_key].as_array()) {
+                    for (const auto& opt : *options) {
+                        command_template += " " + opt.value_or(std::string());
+                    }
+                }
+                Utils::ReplaceAll(command_template, "${Int}", jobs);
+                exporter.commands[step] = std::move(command_template);
+                break;
+            }
+        }
+        return exporter;
+    }
+
+    void BuildSystemRegistry::Register(const std::string& provider, const toml::table& port_toml) {
+        auto build_configs = port_toml["build_configs"].as_array();
+        if (!build_configs) return;
+
+        for (const auto& config_node : *build_configs) {
+            auto config_table = config_node.as_table();
+            if (!config_table) continue;
+            auto systems = (*config_table)["export_build_system"].as_array();
+            if (!systems) continue;
+
+            for (const auto& system_node : *systems) {
+                auto system_table = system_node.as_table();
+                if (!system_table) continue;
+
+                BuildSystemExporter exporter = MakeExporter(provider, *system_table);
+                if (exporter.name.empty()) {
+                    std::cerr << "警告: 包 '" << provider << "' 导出了一个没有 name 的构建系统，已忽略。" << std::endl;
+                    continue;
+                }
+                auto [it, inserted] = exporters_.emplace(exporter.name, exporter);
+                if (!inserted && it->second.provider != provider) {
+                    std::cerr << "警告: 构建系统 '" << exporter.name << "' 同时由 '" << it->second.provider
+                              << "' 和 '" << provider << "' 导出，使用前者。" << std::endl;
+                }
+            }
+        }
+    }
+
+    const BuildSystemExporter* BuildSystemRegistry::Find(const std::string& name) const {
+        auto it = exporters_.find(name);
+        return it == exporters_.end() ? nullptr : &it->second;
+    }
+
+    BuildSystemRegistry BuildSystemRegistryForGraph(const DependencyGraph& graph) {
+        BuildSystemRegistry registry;
+        std::set<std::string> registered;
+
+        auto register_spec = [&](const std::string& spec) {
+            if (!registered.insert(spec).second) return;
+
+            auto it = graph.nodes.find(spec);
+            if (it != graph.nodes.end() && !it->second.installed) {
+                registry.Register(spec, it->second.port_toml);
+                return;
+            }
+
+            // 已安装的依赖：与解析依赖图时使用相同的 gcpkg/port 路径
+            PackageSpec id;
+            if (!ParsePackageSpec(spec, id)) return;
+            fs::path port_path = fs::path("gcpkg/port") / id.ns / id.name / id.version / "port.toml";
+            if (!fs::exists(port_path)) return;
+            std::string error;
+            auto port = LoadPortFile(port_path, "build_system", error);
+            if (!port) {
+                std::cerr << "警告: " << error << "，无法读取其导出的构建系统。" << std::endl;
+                return;
+            }
+            registry.Register(spec, port->port_toml);
+        };
+
+        for (const auto& [spec, node] : graph.nodes) {
+            if (node.installed || !node.config_name.empty()) continue;
+            register_spec(spec);
+            for (const auto& dep : node.dependencies) {
+                register_spec(dep);
+            }
+        }
+        return registry;
+    }
+
     void ApplyExportedBuildSystem(BuildPlan& plan,
-                                  toml::table& build_configs,
-                                  const toml::table& port_toml,
+                                  const toml::table& build_configs,
+                                  const BuildSystemRegistry& registry,
                                   std::map<std::string, std::string>& variables) {
         std::string build_system_name = build_configs["build_system"].value_or("");
         if (build_system_name.empty()) {
@@ -21,87 +126,20 @@ namespace MainProcess {
         }
         std::cout << "--- Using build system: " << build_system_name << " ---" << std::endl;
 
-        // 查找提供该构建系统的依赖
-        auto deps_node = port_toml.get("dependencies");
-        if (!deps_node || !deps_node->is_array()) return;
-
-        toml::table exporter_toml;
-        bool found_exporter = false;
-
-        for (const auto& dep_node : *deps_node->as_array()) {
-            std::string dep_spec = dep_node.value_or("");
-            if (dep_spec.empty()) continue;
-
-            std::vector<std::string> parts;
-            std::string part;
-            std::istringstream spec_stream(dep_spec);
-            while (std::getline(spec_stream, part, '@')) parts.push_back(part);
-            if (parts.size() != 3) continue;
-
-            fs::path dep_port_path = fs::path("port") / parts[1] / parts[0] / parts[2] / "port.toml";
-
-            try {
-                toml::table dep_toml = toml::parse_file(dep_port_path.string());
-                if (auto exports = dep_toml.get("build_configs")->as_array()) {
-                    for (const auto& export_node : *exports) {
-                        if (auto export_table = export_node.as_table()) {
-                            if (auto systems = export_table->get("export_build_system")->as_array()) {
-                                for (const auto& system_node : *systems) {
-                                    if (auto system_table = system_node.as_table()) {
-                                        if (system_table->get("name")->value_or("") == build_system_name) {
-                                            exporter_toml = *system_table;
-                                            found_exporter = true;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        if (found_exporter) break;
-                    }
-                }
-            } catch (...) {
-                continue;
-            }
-            if (found_exporter) break;
-        }
-
-        if (!found_exporter) {
+        const BuildSystemExporter* exporter = registry.Find(build_system_name);
+        if (!exporter) {
             std::cerr << "警告: 未找到提供 build_system '" << build_system_name << "' 的依赖。" << std::endl;
             return;
         }
 
-        // 定义映射关系
-        const std::map<std::string, std::string> command_map = {
-            {"configure", "configure_command"}, {"build", "build_command"}, {"install", "intstall_command"}
-            // 注意 port.toml 示例中的拼写错误
-        };
-
         // 如果当前包没有定义命令，则从导出系统继承
-        for (const auto& pair : command_map) {
-            if (plan[pair.first].empty()) {  // 如果没有指定具体命令
-                if (auto cmd = exporter_toml.get(pair.second)) {
-                    std::string command_template = cmd->value_or("");
-
-                    // 处理选项
-                    std::string option_key = pair.second;
-                    option_key.replace(option_key.find("_command"), 8, "_option");
-                    if (auto options = exporter_toml.get(option_key)->as_array()) {
-                        for (const auto& opt : *options) {
-                            command_template = command_template + " " + opt.value_or("");
-                        }
-                    }
-
-                    // 替换变量
-                    // 简单替换，实际可能需要更复杂的模板引擎
-                    Utils::ReplaceAll(command_template, "${string}", variables["${package_install_dir}"]);
-                    Utils::ReplaceAll(command_template, "${Int}", std::to_string(std::thread::hardware_concurrency()));
+        for (const auto& [step, command_template] : exporter->commands) {
+            if (!plan[step].empty()) continue;
 
-                    plan[pair.first].push_back(command_template);
-                    std::cout << "--- Inherited '" << pair.first << "' command: " << command_template << " ---"
-                              << std::endl;
-                }
-            }
+            std::string command = command_template;
+            Utils::ReplaceAll(command, "${string}", variables["${package_install_dir}"]);
+            plan[step].push_back(command);
+            std::cout << "--- Inherited '" << step << "' command: " << command << " ---" << std::endl;
         }
     }
 
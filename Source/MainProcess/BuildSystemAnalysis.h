@@ -1,14 +1,61 @@
 #ifndef GCPKG_BUILDSYSTEMANALYSIS_H
 #define GCPKG_BUILDSYSTEMANALYSIS_H
 
+#include <map>
+#include <string>
+#include <unordered_map>
+
 #include "MainProcess/DependenciesAnalysis.h"  // For BuildPlan
+#include "MainProcess/DependencyGraph.h"
 #include "toml++/toml.hpp"
 
 namespace MainProcess {
 
+    // 一个通过 export_build_system 导出的构建系统
+    struct BuildSystemExporter {
+        std::string name;
+        std::string provider;                         // 导出它的包
+        std::map<std::string, std::string> commands;  // 步骤 (configure/build/install) -> 已拼接选项的命令模板
+    };
+
+    /**
+     * @brief 构建系统名称到导出项的注册表。
+     *
+     * 每个会话构建一次，之后按名称 O(1) 查找。登记时即把命令与 *_option 拼接好，
+     * 并展开与包无关的 ${Int} (并行度)；只有 ${string} (安装目录) 留到使用时按包替换。
+     */
+    class BuildSystemRegistry {
+      public:
+        // 登记 port 中 build_configs[*].export_build_system[*] 的所有条目；同名时保留先登记的
+        void Register(const std::string& provider, const toml::table& port_toml);
+        const BuildSystemExporter* Find(const std::string& name) const;
+        bool Empty() const {
+            return exporters_.empty();
+        }
+
+      private:
+        std::unordered_map<std::string, BuildSystemExporter> exporters_;
+    };
+
+    /**
+     * @brief 为一次安装会话构建注册表。
+     *
+     * 登记图中每个待构建包及其直接依赖导出的构建系统。已安装的依赖在解析依赖图时没有读取
+     * port 文件，这里各读取一次。
+     */
+    BuildSystemRegistry BuildSystemRegistryForGraph(const DependencyGraph& graph);
+
+    /**
+     * @brief 当前包没有定义 configure/build/install 命令时，从 build_system 的导出项继承。
+     *
+     * @param plan 要修改的构建计划。
+     * @param build_configs 当前构建配置。
+     * @param registry 会话的构建系统注册表。
+     * @param variables 包的变量，用于替换模板中的安装目录。
+     */
     void ApplyExportedBuildSystem(BuildPlan& plan,
-                                  toml::table& build_configs,
-                                  const toml::table& port_toml,
+                                  const toml::table& build_configs,
+                                  const BuildSystemRegistry& registry,
                                   std::map<std::string, std::string>& variables);
 
 }  // namespace MainProcess
@@ -27,7 +27,8 @@ namespace MainProcess {
                                 {"platform", ""},
                                 {"project", project_name},
                                 {"build_type", "debug"},
-                                {"jobs", static_cast<int64_t>(core_count)}});
+                                {"jobs", static_cast<int64_t>(core_count)},
+                                {"parallel_builds", int64_t{1}}});
 
         tbl.emplace("docker",
                     toml::table{
@@ -35,6 +36,9 @@ namespace MainProcess {
                         {"docker_proxy", ""},
                     });
 
+        // 清单模式 (gcpkg install --manifest) 安装的依赖，格式为 name = "namespace@version"
+        tbl.emplace("dependencies", toml::table{});
+
         // 写入文件
         std::ofstream file("gcpkg.toml");
         if (!file.is_open()) {
@@ -0,0 +1,551 @@
+#include "MainProcess/Daemon.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "Basic/DockerExecutor/RunContainer.h"
+#include "Basic/Log/Log.h"
+#include "Basic/Utils/ContentHash.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    // 响应帧：1 字节类型 + 4 字节小端长度 + 内容
+    static constexpr char kFrameStdout = 'o';
+    static constexpr char kFrameStderr = 'e';
+    static constexpr char kFrameExit = 'x';  // 内容为十进制退出码，之后守护进程关闭连接
+
+    // 第一个安装请求到达后等待其他客户端的时间，窗口内到达的安装请求合并进同一个会话
+    static constexpr auto kCoalesceWindow = std::chrono::milliseconds(200);
+    // 读取请求和写出输出的超时，避免停止读取的客户端使写线程永远阻塞
+    static constexpr time_t kClientTimeoutSeconds = 10;
+    // 一个客户端积压的输出上限，超过后视为客户端已停止读取
+    static constexpr size_t kMaxQueuedBytes = 64 * 1024 * 1024;
+    static constexpr size_t kMaxRequestBytes = 64 * 1024;
+    static constexpr int kAcceptPollMs = 500;
+
+    static std::atomic<bool> g_stop_signal{false};
+
+    fs::path DaemonSocketPath() {
+        return "gcpkg/daemon/gcpkg.sock";
+    }
+
+    // 请求按 key=value 逐行编码，以空行结束；未知的键被忽略
+    static std::string EncodeRequest(const DaemonRequest& request) {
+        std::ostringstream out;
+        out << "command=" << request.command << "\n";
+        for (const auto& spec : request.specs) out << "spec=" << spec << "\n";
+        out << "manifest=" << request.install.manifest << "\n";
+        out << "resume=" << request.install.resume << "\n";
+        out << "estimate=" << request.estimate << "\n";
+        out << "affected=" << request.affected << "\n";
+        out << "depth=" << request.update.depth << "\n";
+        for (const auto& ns : request.update.namespaces) out << "namespace=" << ns << "\n";
+        out << "\n";
+        return out.str();
+    }
+
+    static bool DecodeRequest(const std::string& text, DaemonRequest& request) {
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line) && !line.empty()) {
+            const size_t eq = line.find('=');
+            if (eq == std::string::npos) return false;
+            const std::string key = line.substr(0, eq);
+            const std::string value = line.substr(eq + 1);
+            if (key == "command") {
+                request.command = value;
+            } else if (key == "spec") {
+                request.specs.push_back(value);
+            } else if (key == "manifest") {
+                request.install.manifest = value == "1";
+            } else if (key == "resume") {
+                request.install.resume = value == "1";
+            } else if (key == "estimate") {
+                request.estimate = value == "1";
+            } else if (key == "affected") {
+                request.affected = value == "1";
+            } else if (key == "depth") {
+                request.update.depth = std::atoi(value.c_str());
+            } else if (key == "namespace") {
+                request.update.namespaces.push_back(value);
+            }
+        }
+        return !request.command.empty();
+    }
+
+    static bool SendAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    static bool RecvAll(int fd, char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t received = recv(fd, data, size, 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0) return false;
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    static bool SendFrame(int fd, char type, const std::string& payload) {
+        char header[5] = {type};
+        const auto size = static_cast<uint32_t>(payload.size());
+        for (int i = 0; i < 4; ++i) header[1 + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+        return SendAll(fd, header, sizeof(header)) && SendAll(fd, payload.data(), payload.size());
+    }
+
+    static sockaddr_un DaemonAddress() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, DaemonSocketPath().c_str(), sizeof(address.sun_path) - 1);
+        return address;
+    }
+
+    // 返回连接到守护进程的套接字，没有守护进程在监听时返回 -1
+    static int ConnectToDaemon() {
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        const sockaddr_un address = DaemonAddress();
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    std::optional<int> ForwardToDaemon(const DaemonRequest& request) {
+        if (!fs::exists(DaemonSocketPath())) return std::nullopt;
+        const int fd = ConnectToDaemon();
+        if (fd < 0) return std::nullopt;  // 守护进程异常退出后残留的套接字文件
+
+        const std::string encoded = EncodeRequest(request);
+        if (!SendAll(fd, encoded.data(), encoded.size())) {
+            close(fd);
+            return std::nullopt;
+        }
+        std::cout << "--- Forwarding '" << request.command << "' to the gcpkg daemon ---" << std::endl;
+
+        char header[5];
+        std::string payload;
+        while (RecvAll(fd, header, sizeof(header))) {
+            uint32_t size = 0;
+            for (int i = 0; i < 4; ++i) {
+                size |= static_cast<uint32_t>(static_cast<unsigned char>(header[1 + i])) << (8 * i);
+            }
+            payload.resize(size);
+            if (!RecvAll(fd, payload.data(), payload.size())) break;
+            if (header[0] == kFrameStdout) {
+                std::cout << payload << std::flush;
+            } else if (header[0] == kFrameStderr) {
+                std::cerr << payload << std::flush;
+            } else if (header[0] == kFrameExit) {
+                close(fd);
+                return std::atoi(payload.c_str());
+            }
+        }
+        close(fd);
+        std::cerr << "错误: 与守护进程的连接意外断开。" << std::endl;
+        return 1;
+    }
+
+    // 等待执行的客户端请求
+    struct PendingClient {
+        int fd = -1;
+        DaemonRequest request;
+    };
+
+    /**
+     * @brief 一个客户端的输出队列和写线程。
+     *
+     * 日志线程只把输出放进队列，由写线程发送，停止读取的客户端不会阻塞日志线程或其他客户端。
+     * 写出失败 (客户端已断开、超时或积压过多) 后丢弃之后的输出。析构时等待队列发送完毕并关闭连接。
+     */
+    class ClientWriter {
+      public:
+        explicit ClientWriter(int fd) : fd_(fd), thread_([this] { WriteLoop(); }) {
+        }
+
+        ~ClientWriter() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closing_ = true;
+            }
+            cv_.notify_one();
+            thread_.join();
+            close(fd_);
+        }
+
+        ClientWriter(const ClientWriter&) = delete;
+        ClientWriter& operator=(const ClientWriter&) = delete;
+
+        void Push(char type, const std::string& payload) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!alive_ || closing_) return;
+                if (queued_bytes_ + payload.size() > kMaxQueuedBytes) {
+                    Abandon();
+                    return;
+                }
+                frames_.push_back({type, payload});
+                queued_bytes_ += payload.size();
+            }
+            cv_.notify_one();
+        }
+
+        // 发送退出码，之后不再接受输出；写线程发送完队列后结束
+        void Finish(int exit_code) {
+            Push(kFrameExit, std::to_string(exit_code));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closing_ = true;
+            }
+            cv_.notify_one();
+        }
+
+        bool IsDone() const {
+            return done_;
+        }
+
+      private:
+        struct Frame {
+            char type;
+            std::string payload;
+        };
+
+        void WriteLoop() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                cv_.wait(lock, [this] { return closing_ || !frames_.empty(); });
+                if (frames_.empty()) break;
+                Frame frame = std::move(frames_.front());
+                frames_.pop_front();
+                queued_bytes_ -= frame.payload.size();
+                lock.unlock();
+                const bool sent = SendFrame(fd_, frame.type, frame.payload);
+                lock.lock();
+                if (!sent) Abandon();
+            }
+            done_ = true;
+        }
+
+        // 调用者持有 mutex_
+        void Abandon() {
+            alive_ = false;
+            frames_.clear();
+            queued_bytes_ = 0;
+        }
+
+        int fd_;
+        std::mutex mutex_;  // 保护 frames_、queued_bytes_、alive_ 和 closing_
+        std::condition_variable cv_;
+        std::deque<Frame> frames_;
+        size_t queued_bytes_ = 0;
+        bool alive_ = true;
+        bool closing_ = false;
+        std::atomic<bool> done_{false};
+        std::thread thread_;  // 最后构造，启动时其他成员已初始化
+    };
+
+    // 恢复会话需要沿用原来请求的包，不与其他请求合并
+    static bool IsCoalescable(const DaemonRequest& request) {
+        return request.command == "install" && !request.install.resume;
+    }
+
+    // 合并后的安装请求：包描述符取并集，任一请求使用清单模式时整个会话也使用
+    static DaemonRequest MergeInstallRequests(const std::vector<const DaemonRequest*>& requests) {
+        DaemonRequest merged;
+        merged.command = "install";
+        std::set<std::string> seen;
+        for (const DaemonRequest* request : requests) {
+            merged.install.manifest = merged.install.manifest || request->install.manifest;
+            for (const auto& spec : request->specs) {
+                if (seen.insert(spec).second) merged.specs.push_back(spec);
+            }
+        }
+        return merged;
+    }
+
+    static bool ReadRequest(int fd, DaemonRequest& request) {
+        std::string text;
+        char buffer[4096];
+        while (text.find("\n\n") == std::string::npos) {
+            const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received < 0 && errno == EINTR) continue;
+            if (received <= 0 || text.size() > kMaxRequestBytes) return false;
+            text.append(buffer, static_cast<size_t>(received));
+        }
+        return DecodeRequest(text, request);
+    }
+
+    class DaemonServer {
+      public:
+        explicit DaemonServer(int listen_fd)
+            : listen_fd_(listen_fd), container_name_("gcpkg-daemon-" + std::to_string(getpid())) {
+        }
+
+        void Run() {
+            std::thread worker([this] { WorkerLoop(); });
+            AcceptLoop();
+            worker.join();
+            finished_writers_.clear();
+            if (Basic::DockerExecutor::IsContainerRunning(container_name_)) {
+                std::cout << "--- Removing daemon container '" << container_name_ << "' ---" << std::endl;
+            }
+            Basic::DockerExecutor::RemoveContainer(container_name_);
+        }
+
+      private:
+        // 主线程只接收请求，所有命令在工作线程中依次执行
+        void AcceptLoop() {
+            while (!g_stop_signal && !IsStopping()) {
+                pollfd listen_poll{listen_fd_, POLLIN, 0};
+                if (poll(&listen_poll, 1, kAcceptPollMs) <= 0) continue;  // 超时或被信号打断
+                const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) continue;
+
+                timeval timeout{kClientTimeoutSeconds, 0};
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                PendingClient client{fd, {}};
+                if (!ReadRequest(fd, client.request)) {
+                    SendFrame(fd, kFrameStderr, "错误: 无法解析转发给守护进程的请求。\n");
+                    SendFrame(fd, kFrameExit, "2");
+                    close(fd);
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(client));
+                cv_.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            cv_.notify_all();
+        }
+
+        void WorkerLoop() {
+            while (true) {
+                std::vector<PendingClient> batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                    if (stopping_) break;
+                    batch.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+
+                // 只合并队首连续的安装请求，不改变它们与 update、rebuild 等命令之间的先后顺序
+                if (IsCoalescable(batch.front().request)) {
+                    std::this_thread::sleep_for(kCoalesceWindow);
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    while (!queue_.empty() && IsCoalescable(queue_.front().request)) {
+                        batch.push_back(std::move(queue_.front()));
+                        queue_.pop_front();
+                    }
+                }
+                Execute(batch);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& client : queue_) {
+                SendFrame(client.fd, kFrameStderr, "错误: 守护进程正在停止，请求未执行。\n");
+                SendFrame(client.fd, kFrameExit, "1");
+                close(client.fd);
+            }
+            queue_.clear();
+        }
+
+        // 把之后的终端输出转发给 targets；先等待日志线程写出已有的输出，避免它们被发给新的接收方
+        static void RouteOutput(const std::vector<ClientWriter*>& targets) {
+            Basic::Log::Flush();
+            Basic::Log::SetTap([targets](const std::string& text, bool is_error) {
+                for (ClientWriter* writer : targets) writer->Push(is_error ? kFrameStderr : kFrameStdout, text);
+            });
+        }
+
+        // 执行一批请求，把会话的输出广播给这批客户端，最后向每个客户端发送它自己的退出码
+        void Execute(std::vector<PendingClient>& batch) {
+            std::vector<std::unique_ptr<ClientWriter>> writers;
+            for (const auto& client : batch) writers.push_back(std::make_unique<ClientWriter>(client.fd));
+            std::vector<int> exit_codes(batch.size(), 1);
+
+            if (batch.size() == 1) {
+                RouteOutput({writers.front().get()});
+                exit_codes.front() = RunRequest(batch.front().request);
+            } else {
+                ExecuteCoalesced(batch, writers, exit_codes);
+            }
+
+            Basic::Log::Flush();
+            Basic::Log::SetTap({});
+            std::erase_if(finished_writers_, [](const auto& writer) { return writer->IsDone(); });
+            for (size_t i = 0; i < writers.size(); ++i) {
+                writers[i]->Finish(exit_codes[i]);
+                finished_writers_.push_back(std::move(writers[i]));
+            }
+        }
+
+        // 合并的安装请求各自解析依赖图：无法解析的请求只向它自己的客户端报告错误，不影响其他请求。
+        // 会话失败时，请求的包 (包括依赖) 都已安装的客户端仍然得到 0
+        void ExecuteCoalesced(std::vector<PendingClient>& batch,
+                              const std::vector<std::unique_ptr<ClientWriter>>& writers,
+                              std::vector<int>& exit_codes) {
+            std::vector<size_t> members;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                RouteOutput({writers[i].get()});
+                const DaemonRequest& request = batch[i].request;
+                bool satisfied = false;
+                if (CheckInstallation(request.specs, request.install, satisfied)) members.push_back(i);
+            }
+            if (members.empty()) return;
+
+            std::vector<const DaemonRequest*> requests;
+            std::vector<ClientWriter*> targets;
+            for (size_t i : members) {
+                requests.push_back(&batch[i].request);
+                targets.push_back(writers[i].get());
+            }
+            RouteOutput(targets);
+            DaemonRequest merged = MergeInstallRequests(requests);
+            if (members.size() > 1) {
+                std::cout << "--- Coalesced " << members.size() << " install requests into one session ---"
+                          << std::endl;
+            }
+            const bool success = RunRequest(merged) == 0;
+
+            for (size_t i : members) {
+                bool satisfied = success;
+                if (!success) {
+                    RouteOutput({writers[i].get()});
+                    CheckInstallation(batch[i].request.specs, batch[i].request.install, satisfied);
+                }
+                exit_codes[i] = satisfied ? 0 : 1;
+            }
+        }
+
+        int RunRequest(DaemonRequest& request) {
+            const std::string& command = request.command;
+            request.install.container_name = container_name_;
+            if (command == "install" || command == "rebuild") RefreshContainer();
+
+            if (command == "install") return PerformInstallation(request.specs, request.install) ? 0 : 1;
+            if (command == "plan") {
+                return ShowInstallationPlan(request.specs, request.install, request.estimate) ? 0 : 1;
+            }
+            if (command == "outdated") return ShowOutdatedPackages() ? 0 : 1;
+            if (command == "rebuild") {
+                return RebuildAffectedPackages(request.specs, request.affected, request.install) ? 0 : 1;
+            }
+            if (command == "update") return UpdatePortTree(request.update) ? 0 : 1;
+            if (command == "stop") {
+                std::cout << "--- Stopping gcpkg daemon ---" << std::endl;
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                return 0;
+            }
+            std::cerr << "错误: 守护进程不支持命令 '" << command << "'。" << std::endl;
+            return 2;
+        }
+
+        // gcpkg.toml 变化后镜像或资源限制可能不同，丢弃常驻容器，由下一个会话按新配置重新创建
+        void RefreshContainer() {
+            const std::string config_hash = Basic::Utils::HashFile("gcpkg.toml");
+            if (!config_hash_.empty() && config_hash != config_hash_ &&
+                Basic::DockerExecutor::IsContainerRunning(container_name_)) {
+                std::cout << "--- gcpkg.toml changed. Recreating daemon container '" << container_name_ << "' ---"
+                          << std::endl;
+                Basic::DockerExecutor::RemoveContainer(container_name_);
+            }
+            config_hash_ = config_hash;
+        }
+
+        bool IsStopping() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return stopping_;
+        }
+
+        int listen_fd_;
+        std::string container_name_;
+        std::string config_hash_;  // 上一个会话使用的 gcpkg.toml 的摘要
+
+        // 已发送退出码、仍在发送剩余输出的客户端，只由工作线程访问
+        std::vector<std::unique_ptr<ClientWriter>> finished_writers_;
+
+        std::mutex mutex_;  // 保护 queue_ 和 stopping_
+        std::condition_variable cv_;
+        std::deque<PendingClient> queue_;
+        bool stopping_ = false;
+    };
+
+    bool RunDaemon() {
+        const fs::path socket_path = DaemonSocketPath();
+        std::error_code ec;
+        fs::create_directories(socket_path.parent_path(), ec);
+        if (fs::exists(socket_path)) {
+            const int fd = ConnectToDaemon();
+            if (fd >= 0) {
+                close(fd);
+                std::cerr << "错误: 当前项目的守护进程已在运行 (" << socket_path.string() << ")。" << std::endl;
+                return false;
+            }
+            fs::remove(socket_path, ec);  // 上一个守护进程异常退出后残留的套接字
+        }
+
+        const int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const sockaddr_un address = DaemonAddress();
+        if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, SOMAXCONN) != 0) {
+            const int error = errno;
+            if (listen_fd >= 0) close(listen_fd);
+            std::cerr << "错误: 无法监听 " << socket_path.string() << ": " << std::strerror(error) << std::endl;
+            return false;
+        }
+        chmod(socket_path.c_str(), 0600);
+
+        // 第一次 SIGINT / SIGTERM 在当前会话结束后退出；SA_RESETHAND 使第二次立即终止
+        struct sigaction action{};
+        action.sa_handler = [](int) { g_stop_signal = true; };
+        action.sa_flags = SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+
+        std::cout << "--- gcpkg daemon listening on " << socket_path.string() << " ---" << std::endl;
+        DaemonServer(listen_fd).Run();
+
+        close(listen_fd);
+        fs::remove(socket_path, ec);
+        std::cout << "--- gcpkg daemon stopped ---" << std::endl;
+        return true;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef MAINPROCESS_DAEMON_H
+#define MAINPROCESS_DAEMON_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MainProcess/InstallationOrchestrator.h"
+#include "MainProcess/PortTreeSync.h"
+
+namespace MainProcess {
+
+    // 转发给守护进程的一条子命令
+    struct DaemonRequest {
+        std::string command;             // install / plan / outdated / rebuild / update / stop
+        std::vector<std::string> specs;  // install / plan / rebuild 的包描述符
+        InstallOptions install;          // install / plan 的选项 (container_name 由守护进程决定)
+        bool estimate = false;           // plan --estimate
+        UpdateOptions update;            // update 的选项
+        bool affected = false;           // rebuild --affected
+    };
+
+    // 守护进程监听的 unix 套接字。sockaddr_un 的路径长度有限，因此使用相对于项目根目录的路径
+    std::filesystem::path DaemonSocketPath();
+
+    /**
+     * @brief 在当前项目中以守护进程方式运行，直到收到 stop 请求或 SIGINT / SIGTERM。
+     *
+     * 进程内常驻的状态在多个会话之间保留：port 解析缓存、文件摘要缓存、下载连接池，
+     * 以及第一次安装时启动的会话容器 (gcpkg.toml 变化后会重新创建)。
+     * 安装请求在短暂的窗口内、或在前一个会话进行期间到达时，会被合并进同一个会话，
+     * 共享的依赖只构建一次；合并的请求共享输出，但各自得到退出码：
+     * 会话失败时，请求的包都已安装的客户端仍然成功。其他命令依次执行。
+     * 不会自行转入后台，需要由调用者 (shell、systemd 等) 负责。
+     *
+     * @return 正常退出时返回 true；套接字已被另一个守护进程占用或无法监听时返回 false。
+     */
+    bool RunDaemon();
+
+    /**
+     * @brief 把子命令转发给当前项目的守护进程，并把它的输出写到本进程的 std::cout / std::cerr。
+     *
+     * 中断客户端不会取消守护进程中的会话，因为该会话可能同时服务于其他客户端。
+     *
+     * @param request 要执行的命令。
+     * @return 守护进程返回的退出码；没有正在运行的守护进程时返回 std::nullopt，调用者应在本进程中执行。
+     */
+    std::optional<int> ForwardToDaemon(const DaemonRequest& request);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_DAEMON_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "MainProcess/DependencyGraph.h"
+
+#include <functional>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "Basic/Utils/FileLock.h"
+#include "MainProcess/PortCache.h"
+#include "MainProcess/StepFingerprint.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    bool ParsePackageSpec(const std::string& spec, PackageSpec& out) {
+        std::vector<std::string> parts;
+        std::string part;
+        std::istringstream spec_stream(spec);
+        while (std::getline(spec_stream, part, '@')) {
+            parts.push_back(part);
+        }
+        if (parts.size() != 3) {
+            return false;
+        }
+        out = {parts[0], parts[1], parts[2]};
+        return true;
+    }
+
+    // 额外构建配置的目录名为 <version>@<config_name>；'@' 不会出现在版本号中
+    static std::string ConfigDirName(const PackageSpec& id, const std::string& config_name) {
+        return config_name.empty() ? id.version : id.version + "@" + config_name;
+    }
+
+    fs::path BuildTreeDir(const PackageSpec& id, const std::string& config_name) {
+        return fs::path("gcpkg/buildtrees") / id.name / ConfigDirName(id, config_name);
+    }
+
+    fs::path PackageInstallDir(const PackageSpec& id, const std::string& config_name) {
+        return fs::path("gcpkg/packages") / id.name / ConfigDirName(id, config_name);
+    }
+
+    fs::path PackageLockFile(const PackageSpec& id, const std::string& config_name) {
+        return fs::path("gcpkg/locks/packages") / id.name / (ConfigDirName(id, config_name) + ".lock");
+    }
+
+    fs::path SourceLockFile(const PackageSpec& id) {
+        return fs::path("gcpkg/locks/sources") / id.name / (id.version + ".lock");
+    }
+
+    bool IsPackageInstalled(const PackageSpec& id, const std::string& config_name) {
+        return fs::exists(PackageInstallDir(id, config_name)) && !IsBuildIncomplete(BuildTreeDir(id, config_name)) &&
+               !Basic::Utils::FileLock::IsHeld(PackageLockFile(id, config_name));
+    }
+
+    std::map<std::string, std::vector<std::string>> DependencyGraph::Dependents() const {
+        std::map<std::string, std::vector<std::string>> dependents;
+        for (const auto& [spec, node] : nodes) {
+            for (const auto& dep : node.dependencies) {
+                dependents[dep].push_back(spec);
+            }
+        }
+        return dependents;
+    }
+
+    std::vector<std::string> CollectPortDependencies(const toml::table& port_toml) {
+        std::vector<std::string> dependencies;
+        std::set<std::string> seen;
+
+        auto build_configs_node = port_toml.get("build_configs");
+        if (!build_configs_node || !build_configs_node->is_array()) {
+            return dependencies;
+        }
+
+        for (const auto& config_node : *build_configs_node->as_array()) {
+            auto config_table = config_node.as_table();
+            if (!config_table) continue;
+
+            auto deps_node = config_table->get("dependencies");
+            if (!deps_node || !deps_node->is_array()) continue;
+
+            for (const auto& dep_node : *deps_node->as_array()) {
+                if (auto dep_spec = dep_node.value<std::string>()) {
+                    if (!dep_spec->empty() && seen.insert(*dep_spec).second) {
+                        dependencies.push_back(*dep_spec);
+                    }
+                }
+            }
+        }
+        return dependencies;
+    }
+
+    Basic::Metrics::Counter& PortParses(const std::string& site) {
+        return Basic::Metrics::GetCounter(
+            "gcpkg_port_parses_total", "port.toml files parsed, by caller.", "site=\"" + site + "\"");
+    }
+
+    bool ResolveDependencyGraph(const std::vector<std::string>& root_specs, DependencyGraph& graph) {
+        // 0 = 未访问, 1 = 正在访问 (在递归栈中), 2 = 已完成
+        std::map<std::string, int> state;
+
+        std::function<bool(const std::string&)> visit = [&](const std::string& spec) -> bool {
+            int& current = state[spec];
+            if (current == 2) return true;
+            if (current == 1) {
+                std::cerr << "错误: 检测到循环依赖，涉及包 '" << spec << "'。" << std::endl;
+                return false;
+            }
+            current = 1;
+
+            PackageNode node;
+            node.spec = spec;
+            if (!ParsePackageSpec(spec, node.id)) {
+                std::cerr << "错误: 包格式无效 '" << spec << "'。应为 'name@namespace@version'。" << std::endl;
+                return false;
+            }
+
+            node.installed = IsPackageInstalled(node.id);
+            node.port_path = fs::path("gcpkg/port") / node.id.ns / node.id.name / node.id.version / "port.toml";
+
+            if (!node.installed) {
+                std::string error;
+                auto port = LoadPortFile(node.port_path, "resolve", error);
+                if (!port) {
+                    std::cerr << "错误: 无法读取包 '" << spec << "' 的 port: " << error << std::endl;
+                    return false;
+                }
+                node.port_toml = port->port_toml;
+                node.port_hash = port->hash;
+                node.dependencies = CollectPortDependencies(node.port_toml);
+
+                for (const auto& dep : node.dependencies) {
+                    if (!visit(dep)) {
+                        std::cerr << "错误: 依赖项 '" << dep << "' 解析失败 (来自 '" << spec << "')。" << std::endl;
+                        return false;
+                    }
+                }
+            }
+
+            graph.nodes[spec] = std::move(node);
+            state[spec] = 2;
+            return true;
+        };
+
+        for (const auto& root : root_specs) {
+            if (!visit(root)) return false;
+            graph.roots.push_back(root);
+        }
+        return true;
+    }
+
+    void ExpandBuildConfigs(DependencyGraph& graph, const std::string& build_type) {
+        std::vector<PackageNode> extra_nodes;
+
+        for (auto& [spec, node] : graph.nodes) {
+            if (!node.config_name.empty()) continue;
+            // 已安装的包在解析时没有读取 port；它的额外配置的安装目录可能已被单独删除，仍需逐个检查
+            std::shared_ptr<const ParsedPort> installed_port;
+            if (node.installed) {
+                std::string error;
+                installed_port = LoadPortFile(node.port_path, "expand", error);
+                if (!installed_port) continue;
+            }
+            const toml::table& port_toml = installed_port ? installed_port->port_toml : node.port_toml;
+            auto configs = port_toml["build_configs"].as_array();
+            if (!configs || configs->size() < 2) continue;
+
+            // 选出主配置
+            node.config_index = 0;
+            for (size_t i = 0; i < configs->size(); ++i) {
+                auto config_table = configs->get(i)->as_table();
+                if (config_table && !build_type.empty() && (*config_table)["build_type"].value_or("") == build_type) {
+                    node.config_index = i;
+                    break;
+                }
+            }
+
+            std::set<std::string> used_names;
+            for (size_t i = 0; i < configs->size(); ++i) {
+                if (i == node.config_index) continue;
+                auto config_table = configs->get(i)->as_table();
+                if (!config_table) continue;
+
+                std::string name = (*config_table)["name"].value_or("");
+                if (name.empty()) name = (*config_table)["build_type"].value_or("");
+                if (name.empty() || !used_names.insert(name).second) name = "config" + std::to_string(i);
+                used_names.insert(name);
+
+                PackageNode unit = node;
+                unit.spec = spec + "#" + name;
+                unit.config_index = i;
+                unit.config_name = name;
+                unit.config_units.clear();
+                unit.installed = IsPackageInstalled(unit.id, name);
+                if (installed_port) {
+                    // 主配置已安装时只加入需要重新构建的配置；它的依赖不在图中时必须已经安装
+                    if (unit.installed) continue;
+                    unit.port_toml = installed_port->port_toml;
+                    unit.port_hash = installed_port->hash;
+                    unit.dependencies = CollectPortDependencies(unit.port_toml);
+                    bool dependencies_ready = true;
+                    for (const auto& dep : unit.dependencies) {
+                        PackageSpec dep_id;
+                        if (graph.nodes.count(dep)) continue;
+                        if (!ParsePackageSpec(dep, dep_id) || !IsPackageInstalled(dep_id)) dependencies_ready = false;
+                    }
+                    std::erase_if(unit.dependencies, [&](const std::string& dep) { return !graph.nodes.count(dep); });
+                    if (!dependencies_ready) {
+                        std::cerr << "警告: " << unit.spec << " 的安装目录不存在，但它的依赖未安装，本次不重新构建。"
+                                  << std::endl;
+                        continue;
+                    }
+                }
+                node.config_units.push_back(unit.spec);
+                extra_nodes.push_back(std::move(unit));
+            }
+        }
+
+        for (auto& unit : extra_nodes) {
+            std::string unit_spec = unit.spec;
+            graph.nodes[unit_spec] = std::move(unit);
+        }
+    }
+
+    std::vector<std::string> TopologicalOrder(const DependencyGraph& graph) {
+        std::vector<std::string> order;
+        std::set<std::string> visited;
+
+        std::function<void(const std::string&)> visit = [&](const std::string& spec) {
+            if (!visited.insert(spec).second) return;
+            auto it = graph.nodes.find(spec);
+            if (it == graph.nodes.end()) return;
+            for (const auto& dep : it->second.dependencies) {
+                visit(dep);
+            }
+            if (!it->second.installed) {
+                order.push_back(spec);
+            }
+            for (const auto& unit : it->second.config_units) {
+                visit(unit);
+            }
+        };
+
+        for (const auto& root : graph.roots) {
+            visit(root);
+        }
+        return order;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
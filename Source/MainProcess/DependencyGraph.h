@@ -0,0 +1,123 @@
+#ifndef MAINPROCESS_DEPENDENCYGRAPH_H
+#define MAINPROCESS_DEPENDENCYGRAPH_H
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Basic/Metrics/Metrics.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // "name@namespace@version" 形式的包描述符
+    struct PackageSpec {
+        std::string name;
+        std::string ns;
+        std::string version;
+    };
+
+    /**
+     * @brief 解析 "name@namespace@version" 形式的包描述符。
+     *
+     * @return 如果描述符恰好包含三个部分则返回 true。
+     */
+    bool ParsePackageSpec(const std::string& spec, PackageSpec& out);
+
+    /**
+     * @brief 收集 port.toml 中 build_configs[*].dependencies 的所有依赖描述符 (去重并保持顺序)。
+     */
+    std::vector<std::string> CollectPortDependencies(const toml::table& port_toml);
+
+    // 按调用位置统计 port.toml 的解析次数 (gcpkg_port_parses_total{site=...})，用于发现重复解析
+    Basic::Metrics::Counter& PortParses(const std::string& site);
+
+    // 依赖图中的单个软件包
+    struct PackageNode {
+        std::string spec;
+        PackageSpec id;
+        std::filesystem::path port_path;
+        std::string port_hash;                  // port.toml 内容摘要，用作历史记录等的键
+        toml::table port_toml;                  // 只在解析阶段读取一次
+        std::vector<std::string> dependencies;  // 直接依赖的描述符
+        bool installed = false;                 // gcpkg/packages 中已存在，无需构建
+        size_t config_index = 0;                // 要构建的 build_configs 条目
+        std::string config_name;                // 非空表示额外的构建配置，使用独立的构建和安装目录
+        std::vector<std::string> config_units;  // 主配置节点上：同一个包其他构建配置的节点
+    };
+
+    /**
+     * @brief 包的构建目录 (gcpkg/buildtrees/<name>/<version>)。
+     *
+     * config_name 非空时返回额外构建配置的独立目录 (<version>@<config_name>)。
+     */
+    std::filesystem::path BuildTreeDir(const PackageSpec& id, const std::string& config_name = "");
+
+    // 包的安装目录，规则与 BuildTreeDir 相同
+    std::filesystem::path PackageInstallDir(const PackageSpec& id, const std::string& config_name = "");
+
+    /**
+     * @brief 构建一个包 (一个构建配置) 期间持有的跨进程锁，保护它的构建目录和安装目录。
+     *
+     * 锁文件集中在 gcpkg/locks 下，不随构建目录或安装目录一起被删除。
+     */
+    std::filesystem::path PackageLockFile(const PackageSpec& id, const std::string& config_name = "");
+
+    // 获取包的源码 (各构建配置共享的 source_dir) 期间持有的跨进程锁
+    std::filesystem::path SourceLockFile(const PackageSpec& id);
+
+    /**
+     * @brief 包是否已经完整安装。
+     *
+     * 安装目录存在、步骤日志没有标记为未完成，且没有其他进程正持有该包的锁。
+     * 其他进程正在构建的包视为未安装，构建时会等待对方完成，然后按步骤日志跳过已完成的步骤。
+     */
+    bool IsPackageInstalled(const PackageSpec& id, const std::string& config_name = "");
+
+    // 一次安装会话的完整依赖图
+    struct DependencyGraph {
+        std::map<std::string, PackageNode> nodes;
+        std::vector<std::string> roots;
+
+        // 返回依赖于 spec 的所有包 (反向边)
+        std::map<std::string, std::vector<std::string>> Dependents() const;
+    };
+
+    /**
+     * @brief 从根包开始解析完整的依赖图。
+     *
+     * 每个 port.toml 只解析一次。已安装的包作为叶子节点加入图中，不再展开其依赖，
+     * 这与之前递归安装时的缓存检查行为一致。安装目录存在但构建目录中留有未完成的
+     * 步骤日志的包不视为已安装。检测到循环依赖时返回 false。
+     *
+     * @param root_specs 要安装的根包描述符。
+     * @param graph 输出的依赖图。
+     * @return true 如果所有 port 文件都成功解析且图中无环。
+     */
+    bool ResolveDependencyGraph(const std::vector<std::string>& root_specs, DependencyGraph& graph);
+
+    /**
+     * @brief 把每个待构建包的 build_configs 展开为独立的调度单元。
+     *
+     * build_type 与 [global].build_type 相同的条目 (没有时为第一个条目) 是主配置，沿用包原来的
+     * 描述符、构建目录和安装目录，依赖于该包的包只等待主配置。其余条目成为描述符为
+     * "spec#配置名" 的节点，拥有独立的构建目录和安装目录，可以与主配置并行构建。
+     * 配置名取自条目的 name，其次是 build_type，否则为 "config<序号>"。
+     * 主配置已安装时，安装目录不存在的额外配置同样成为待构建的节点。
+     *
+     * @param graph 已解析的依赖图。
+     * @param build_type 项目的 [global].build_type。
+     */
+    void ExpandBuildConfigs(DependencyGraph& graph, const std::string& build_type);
+
+    /**
+     * @brief 返回图中未安装节点的一个拓扑序 (依赖在前)。
+     *
+     * 额外构建配置的节点紧跟在其主配置之后。
+     */
+    std::vector<std::string> TopologicalOrder(const DependencyGraph& graph);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_DEPENDENCYGRAPH_H
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <vector>
 
+#include "MainProcess/DependencyGraph.h"
+
 namespace fs = std::filesystem;
 
 namespace MainProcess {
@@ -11,13 +13,17 @@ namespace MainProcess {
     EnvironmentContext PrepareEnvironmentForPackage(const toml::table& gcpkg_toml,
                                                     const toml::table& port_toml,
                                                     const std::string& name,
-                                                    const std::string& version) {
+                                                    const std::string& version,
+                                                    size_t config_index,
+                                                    const std::string& config_name) {
         EnvironmentContext context;
         std::map<std::string, std::string>& variables = context.variables;
 
         // 1. 准备基础路径和变量
-        fs::path build_dir = fs::path("gcpkg/buildtrees") / name / version;
-        fs::path package_dir = fs::path("gcpkg/packages") / name / version;
+        const PackageSpec id{name, "", version};
+        fs::path source_dir = BuildTreeDir(id);
+        fs::path build_dir = BuildTreeDir(id, config_name);
+        fs::path package_dir = PackageInstallDir(id, config_name);
         fs::path gcpkg_root = fs::absolute(fs::current_path());
 
         // 安全地从 gcpkg.toml 获取 docker_proxy
@@ -25,22 +31,38 @@ namespace MainProcess {
             variables["${docker_proxy}"] = docker_table->get("docker_proxy")->value_or("");
         }
 
-        // 安全地从 port_toml 获取 url
+        // 安全地从 port_toml 获取 url 和 ref；create_port 生成的是 [packages] url/ref
         if (auto packages_table = port_toml["packages"].as_table()) {
-            if (auto packages_array = packages_table->get("packages")->as_array()) {
+            variables["${url}"] = (*packages_table)["url"].value_or("");
+            variables["${ref}"] = (*packages_table)["ref"].value_or("");
+            if (auto packages_array = (*packages_table)["packages"].as_array()) {
                 if (!packages_array->empty()) {
                     if (auto first_package = packages_array->get(0)->as_table()) {
-                        variables["${url}"] = first_package->get("url")->value_or("");
+                        variables["${url}"] = (*first_package)["url"].value_or("");
+                        variables["${ref}"] = (*first_package)["ref"].value_or("");
                     }
                 }
             }
         }
 
+        // build_type 优先取自该构建配置，否则使用项目的 [global].build_type
+        std::string build_type = gcpkg_toml["global"]["build_type"].value_or("");
+        if (auto build_configs = port_toml["build_configs"].as_array()) {
+            if (config_index < build_configs->size()) {
+                if (auto config_table = build_configs->get(config_index)->as_table()) {
+                    build_type = (*config_table)["build_type"].value_or(build_type);
+                }
+            }
+        }
+        variables["${build_type}"] = build_type;
+
         variables["${build_dir}"] = fs::absolute(build_dir).string();
+        variables["${source_dir}"] = fs::absolute(source_dir).string();
         variables["${package_install_dir}"] = fs::absolute(package_dir).string();
         variables["${gcpkg_root}"] = gcpkg_root.string();
 
         // 确保目录存在
+        fs::create_directories(source_dir);
         fs::create_directories(build_dir);
         fs::create_directories(package_dir);
 
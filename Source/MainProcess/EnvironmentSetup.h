@@ -18,19 +18,24 @@ namespace MainProcess {
      *
      * 该函数负责填充所有必要的环境变量，包括：
      * - 从 gcpkg.toml 和 port.toml 中提取的变量（如 docker_proxy, url）。
-     * - 基础路径变量（如 build_dir, package_install_dir, gcpkg_root）。
+     * - 基础路径变量（如 build_dir, source_dir, package_install_dir, gcpkg_root）和 build_type。
      * - 从所有依赖项中收集并合并的环境变量（PATH, LD_LIBRARY_PATH 等）。
      *
      * @param gcpkg_toml 全局配置文件。
      * @param port_toml 当前软件包的配置文件。
      * @param name 软件包名称。
      * @param version 软件包版本。
+     * @param config_index 要构建的 build_configs 条目，用于确定 build_type。
+     * @param config_name 额外构建配置的名称；非空时 build_dir 和 package_install_dir 指向该配置的独立目录，
+     *                    source_dir 仍指向包的主构建目录，下载和解压的源码在各配置之间共享。
      * @return 包含环境变量映射表和 env 命令前缀的结构体。
      */
     EnvironmentContext PrepareEnvironmentForPackage(const toml::table& gcpkg_toml,
                                                     const toml::table& port_toml,
                                                     const std::string& name,
-                                                    const std::string& version);
+                                                    const std::string& version,
+                                                    size_t config_index = 0,
+                                                    const std::string& config_name = "");
 
 }  // namespace MainProcess
 
@@ -0,0 +1,582 @@
+#include "MainProcess/GarbageCollector.h"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include "Basic/Utils/FileLock.h"
+#include "MainProcess/BuildPlanner.h"
+#include "MainProcess/Lockfile.h"
+#include "MainProcess/PackageStore.h"
+#include "MainProcess/PortIndex.h"
+#include "MainProcess/ResourceBudget.h"
+#include "MainProcess/SessionJournal.h"
+#include "MainProcess/StepFingerprint.h"
+
+namespace fs = std::filesystem;
+using Basic::Utils::FileLock;
+using Basic::Utils::SharedFileLock;
+
+namespace MainProcess {
+
+    static const fs::path kGcpkgDir = "gcpkg";
+    static const fs::path kAccessIndexPath = "gcpkg/gc/access.tsv";
+    static const fs::path kAccessIndexLock = "gcpkg/locks/gc/access.lock";
+    static const fs::path kGitCacheDir = "gcpkg/cache/git";
+
+    // ioprio_set 的参数，glibc 没有提供对应的头文件
+    static constexpr int kIoprioWhoProcess = 1;
+    static constexpr int kIoprioClassIdle = 3;
+    static constexpr int kIoprioClassShift = 13;
+
+    GcBudget LoadGcBudget(const toml::table& gcpkg_toml) {
+        GcBudget budget;
+        const auto gc = gcpkg_toml["gc"];
+        ReadByteSize(gc["packages_max"], budget.packages_bytes);
+        ReadByteSize(gc["buildtrees_max"], budget.buildtrees_bytes);
+        ReadByteSize(gc["downloads_max"], budget.downloads_bytes);
+        ReadByteSize(gc["git_max"], budget.git_bytes);
+        ReadByteSize(gc["store_max"], budget.store_bytes);
+        budget.automatic = gc["auto"].value_or(false);
+        return budget;
+    }
+
+    // 访问时间索引的每一行：<最后访问的 Unix 时间>\t<相对于 gcpkg/ 的路径>
+    static std::map<std::string, int64_t> LoadAccessIndex() {
+        std::map<std::string, int64_t> index;
+        std::ifstream file(kAccessIndexPath);
+        std::string line;
+        while (std::getline(file, line)) {
+            const size_t tab = line.find('\t');
+            if (tab == std::string::npos) continue;
+            try {
+                index[line.substr(tab + 1)] = std::stoll(line.substr(0, tab));
+            } catch (const std::exception&) {
+                // 忽略损坏的行，该条目退回到使用目录的修改时间
+            }
+        }
+        return index;
+    }
+
+    static bool SaveAccessIndex(const std::map<std::string, int64_t>& index) {
+        std::error_code ec;
+        fs::create_directories(kAccessIndexPath.parent_path(), ec);
+        fs::path temp_path = kAccessIndexPath;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path, std::ios::trunc);
+            for (const auto& [entry, time] : index) file << time << '\t' << entry << '\n';
+            if (!file) {
+                std::cerr << "警告: 无法写入访问时间索引 " << temp_path << std::endl;
+                return false;
+            }
+        }
+        fs::rename(temp_path, kAccessIndexPath, ec);
+        if (ec) {
+            std::cerr << "警告: 无法更新访问时间索引 " << kAccessIndexPath << ": " << ec.message() << std::endl;
+            fs::remove(temp_path, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void RecordAccess(const std::vector<std::string>& entries) {
+        if (entries.empty()) return;
+        FileLock lock(kAccessIndexLock, "the gc access index");
+        auto index = LoadAccessIndex();
+        const auto now = static_cast<int64_t>(std::time(nullptr));
+        for (const auto& entry : entries) index[entry] = now;
+        SaveAccessIndex(index);
+    }
+
+    static std::string IndexKey(const fs::path& path) {
+        return path.lexically_relative(kGcpkgDir).generic_string();
+    }
+
+    fs::path MirrorLockFile(const fs::path& mirror) {
+        return fs::path("gcpkg/locks/git") / (mirror.filename().string() + ".lock");
+    }
+
+    static std::string PackageKey(const PackageSpec& id) {
+        return id.name + "@" + id.version;
+    }
+
+    std::vector<std::string> GraphAccessEntries(const DependencyGraph& graph) {
+        std::vector<std::string> entries;
+        for (const auto& [spec, node] : graph.nodes) {
+            entries.push_back(IndexKey(PackageInstallDir(node.id, node.config_name)));
+            entries.push_back(IndexKey(BuildTreeDir(node.id, node.config_name)));
+            if (node.config_name.empty()) entries.push_back(IndexKey(BuildTreeDir(node.id) / "_downloads"));
+        }
+        return entries;
+    }
+
+    std::set<std::string> GraphPackageKeys(const DependencyGraph& graph) {
+        std::set<std::string> keys;
+        for (const auto& [spec, node] : graph.nodes) keys.insert(PackageKey(node.id));
+        return keys;
+    }
+
+    // 一个可以整体回收的条目
+    struct GcUnit {
+        fs::path path;
+        uint64_t bytes = 0;
+        int64_t last_access = 0;  // 0 表示从访问时间索引或目录的修改时间中获取
+        PackageSpec id;           // 安装目录、构建目录和下载目录所属的包；ns 为空
+        std::string config_name;
+    };
+
+    uint64_t DirectoryBytes(const fs::path& dir, const std::set<std::string>& skip) {
+        uint64_t bytes = 0;
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            std::error_code entry_ec;
+            if (it.depth() == 0 && skip.count(it->path().filename().string())) {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if (it->is_symlink(entry_ec) || !it->is_regular_file(entry_ec)) continue;
+            const auto size = it->file_size(entry_ec);
+            if (!entry_ec) bytes += size;
+        }
+        return bytes;
+    }
+
+    // gcpkg/packages 和 gcpkg/buildtrees 下的 <name>/<version>[@<config>] 目录
+    static std::vector<GcUnit> ListPackageDirs(const fs::path& root) {
+        std::vector<GcUnit> units;
+        std::error_code ec;
+        for (const auto& name_dir : fs::directory_iterator(root, ec)) {
+            std::error_code entry_ec;
+            if (!name_dir.is_directory(entry_ec)) continue;
+            for (const auto& config_dir : fs::directory_iterator(name_dir.path(), entry_ec)) {
+                std::error_code config_ec;
+                if (!config_dir.is_directory(config_ec)) continue;
+                const std::string dir_name = config_dir.path().filename().string();
+                const size_t at = dir_name.find('@');
+                GcUnit unit;
+                unit.path = config_dir.path();
+                unit.id = {name_dir.path().filename().string(), "", dir_name.substr(0, at)};
+                if (at != std::string::npos) unit.config_name = dir_name.substr(at + 1);
+                units.push_back(std::move(unit));
+            }
+        }
+        return units;
+    }
+
+    static uint64_t ToMiB(uint64_t bytes) {
+        return bytes >> 20;
+    }
+
+    class GarbageCollector {
+      public:
+        GarbageCollector(const GcOptions& options, std::stop_token stop);
+
+        bool Run();
+
+      private:
+        using Evict = std::function<bool(const GcUnit&)>;
+
+        void LoadProtected();
+        void LoadDependents();
+        void FindReferencedMirrors();
+        // 按最近最少使用的顺序回收 units，直到总大小不超过 budget
+        void EvictLru(const std::string& area, std::vector<GcUnit> units, uint64_t budget, const Evict& evict);
+        bool RemoveTree(const fs::path& path) const;
+
+        bool EvictPackage(const GcUnit& unit);
+        bool PruneBuildTree(const GcUnit& unit) const;
+        bool EvictDownloads(const GcUnit& unit) const;
+        bool EvictMirror(const GcUnit& unit) const;
+        // 标记所有存储清单引用的对象，回收其余对象；仍超出预算时退役已回收的安装目录的清单
+        void CollectStore(uint64_t budget);
+
+        const GcOptions& options_;
+        std::stop_token stop_;
+        std::map<std::string, int64_t> access_;
+        std::set<std::string> protected_;                           // name@version
+        std::map<std::string, std::set<std::string>> dependents_;  // name@version -> 直接依赖于它的包
+        std::map<std::string, int> installed_configs_;              // name@version -> 安装目录的数量
+        std::set<std::string> referenced_mirrors_;                  // 镜像的目录名
+        size_t evicted_ = 0;
+        uint64_t freed_bytes_ = 0;
+    };
+
+    GarbageCollector::GarbageCollector(const GcOptions& options, std::stop_token stop)
+        : options_(options), stop_(std::move(stop)) {
+        {
+            FileLock lock(kAccessIndexLock, "the gc access index");
+            access_ = LoadAccessIndex();
+        }
+        LoadProtected();
+    }
+
+    void GarbageCollector::LoadProtected() {
+        protected_ = options_.protected_packages;
+        // 锁文件和会话日志中的描述符为 name@ns@version，额外的构建配置带有 #<config> 后缀
+        auto protect = [this](const std::string& spec) {
+            PackageSpec id;
+            if (ParsePackageSpec(spec.substr(0, spec.find('#')), id)) protected_.insert(PackageKey(id));
+        };
+        Lockfile lock;
+        if (lock.Load()) {
+            for (const auto& [spec, package] : lock.packages) protect(spec);
+        }
+        SessionJournal session;
+        if (session.Load()) {
+            for (const auto& [spec, package] : session.packages) protect(spec);
+        }
+        // session.toml 只记录最近的会话，同时进行的其他会话的包来自各自的会话记录 (已是 name@version)
+        for (const auto& key : LiveSession::LoadPackages(!options_.dry_run)) protected_.insert(key);
+    }
+
+    void GarbageCollector::LoadDependents() {
+        PortIndex index;
+        index.Load();
+        index.Refresh();
+        for (const auto& [spec, dependents] : index.ReverseDependencies()) {
+            PackageSpec id;
+            if (!ParsePackageSpec(spec, id)) continue;
+            for (const auto& dependent : dependents) {
+                PackageSpec dependent_id;
+                if (ParsePackageSpec(dependent, dependent_id)) {
+                    dependents_[PackageKey(id)].insert(PackageKey(dependent_id));
+                }
+            }
+        }
+    }
+
+    // 检出目录 (构建目录本身或它的直接子目录) 通过 alternates 文件或 worktree 的 .git 文件引用镜像
+    void GarbageCollector::FindReferencedMirrors() {
+        for (const auto& unit : ListPackageDirs(kGcpkgDir / "buildtrees")) {
+            std::vector<fs::path> checkouts = {unit.path};
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(unit.path, ec)) checkouts.push_back(entry.path());
+            for (const auto& checkout : checkouts) {
+                std::string line;
+                // alternates 中是 <镜像>/objects
+                std::ifstream alternates(checkout / ".git/objects/info/alternates");
+                while (std::getline(alternates, line)) {
+                    referenced_mirrors_.insert(fs::path(line).parent_path().filename().string());
+                }
+                // worktree 的 .git 文件为 "gitdir: <镜像>/worktrees/<名称>"
+                std::ifstream git_file(checkout / ".git");
+                if (std::getline(git_file, line) && line.rfind("gitdir: ", 0) == 0) {
+                    fs::path gitdir = line.substr(8);
+                    referenced_mirrors_.insert(gitdir.parent_path().parent_path().filename().string());
+                }
+            }
+        }
+    }
+
+    bool GarbageCollector::Run() {
+        const GcBudget& budget = options_.budget;
+        if (budget.packages_bytes > 0) {
+            LoadDependents();
+            auto units = ListPackageDirs(kGcpkgDir / "packages");
+            for (auto& unit : units) {
+                unit.bytes = DirectoryBytes(unit.path);
+                ++installed_configs_[PackageKey(unit.id)];
+            }
+            EvictLru("packages", std::move(units), budget.packages_bytes,
+                     [this](const GcUnit& unit) { return EvictPackage(unit); });
+        }
+        if (budget.buildtrees_bytes > 0 && !stop_.stop_requested()) {
+            auto units = ListPackageDirs(kGcpkgDir / "buildtrees");
+            for (auto& unit : units) unit.bytes = DirectoryBytes(unit.path, BuildTreeMetadata(unit.path));
+            EvictLru("buildtrees", std::move(units), budget.buildtrees_bytes,
+                     [this](const GcUnit& unit) { return PruneBuildTree(unit); });
+        }
+        if (budget.downloads_bytes > 0 && !stop_.stop_requested()) {
+            std::vector<GcUnit> units;
+            for (auto& unit : ListPackageDirs(kGcpkgDir / "buildtrees")) {
+                std::error_code ec;
+                if (!unit.config_name.empty() || !fs::is_directory(unit.path / "_downloads", ec)) continue;
+                unit.path /= "_downloads";
+                unit.bytes = DirectoryBytes(unit.path);
+                units.push_back(std::move(unit));
+            }
+            EvictLru("downloads", std::move(units), budget.downloads_bytes,
+                     [this](const GcUnit& unit) { return EvictDownloads(unit); });
+        }
+        if (budget.git_bytes > 0 && !stop_.stop_requested()) {
+            FindReferencedMirrors();
+            std::vector<GcUnit> units;
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(kGitCacheDir, ec)) {
+                std::error_code entry_ec;
+                if (!entry.is_directory(entry_ec)) continue;
+                GcUnit unit;
+                unit.path = entry.path();
+                unit.bytes = DirectoryBytes(unit.path);
+                units.push_back(std::move(unit));
+            }
+            EvictLru("git", std::move(units), budget.git_bytes,
+                     [this](const GcUnit& unit) { return EvictMirror(unit); });
+        }
+        if (budget.store_bytes > 0 && !stop_.stop_requested()) CollectStore(budget.store_bytes);
+
+        std::cout << "--- gc: " << (options_.dry_run ? "would free " : "freed ") << ToMiB(freed_bytes_)
+                  << " MiB in " << evicted_ << " entries ---" << std::endl;
+        if (options_.dry_run) return true;
+
+        // 删除已被回收的条目的访问记录
+        FileLock lock(kAccessIndexLock, "the gc access index");
+        auto index = LoadAccessIndex();
+        for (auto it = index.begin(); it != index.end();) {
+            std::error_code ec;
+            it = fs::exists(kGcpkgDir / it->first, ec) ? std::next(it) : index.erase(it);
+        }
+        return SaveAccessIndex(index);
+    }
+
+    void GarbageCollector::EvictLru(const std::string& area,
+                                    std::vector<GcUnit> units,
+                                    uint64_t budget,
+                                    const Evict& evict) {
+        uint64_t total = 0;
+        for (auto& unit : units) {
+            total += unit.bytes;
+            if (unit.last_access > 0) continue;
+            const auto it = access_.find(IndexKey(unit.path));
+            if (it != access_.end()) {
+                unit.last_access = it->second;
+            } else {
+                struct stat st {};
+                if (stat(unit.path.c_str(), &st) == 0) unit.last_access = st.st_mtim.tv_sec;
+            }
+        }
+        if (total <= budget) return;
+        std::sort(units.begin(), units.end(),
+                  [](const GcUnit& a, const GcUnit& b) { return a.last_access < b.last_access; });
+
+        std::vector<bool> evicted(units.size(), false);
+        // 回收一个安装目录可能使它的依赖变得可以回收，因此重复扫描直到没有进展
+        bool progress = true;
+        while (total > budget && progress && !stop_.stop_requested()) {
+            progress = false;
+            for (size_t i = 0; i < units.size() && total > budget && !stop_.stop_requested(); ++i) {
+                if (evicted[i] || !evict(units[i])) continue;
+                evicted[i] = true;
+                progress = true;
+                total -= units[i].bytes;
+                ++evicted_;
+                freed_bytes_ += units[i].bytes;
+                std::cout << "--- gc: " << (options_.dry_run ? "would evict " : "evicted ") << IndexKey(units[i].path)
+                          << " (" << ToMiB(units[i].bytes) << " MiB) ---" << std::endl;
+            }
+        }
+        if (total > budget && !stop_.stop_requested()) {
+            std::cerr << "警告: " << area << " 仍占用 " << ToMiB(total) << " MiB，超出预算 " << ToMiB(budget)
+                      << " MiB；其余条目正在使用或受到保护。" << std::endl;
+        }
+    }
+
+    bool GarbageCollector::RemoveTree(const fs::path& path) const {
+        if (options_.dry_run) return true;
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        if (ec) {
+            std::cerr << "警告: 无法删除 " << path << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool GarbageCollector::EvictPackage(const GcUnit& unit) {
+        const std::string key = PackageKey(unit.id);
+        if (protected_.count(key)) return false;
+        // 依赖图不会为已安装的包重新解析依赖，仍有已安装的包依赖于它时回收会使依赖方缺少依赖
+        for (const auto& dependent : dependents_[key]) {
+            if (dependent != key && installed_configs_[dependent] > 0) return false;
+        }
+        const auto lock = FileLock::TryAcquire(PackageLockFile(unit.id, unit.config_name));
+        if (!lock || !RemoveTree(unit.path)) return false;
+        --installed_configs_[key];
+        return true;
+    }
+
+    bool GarbageCollector::PruneBuildTree(const GcUnit& unit) const {
+        if (protected_.count(PackageKey(unit.id))) return false;
+        BuildStepJournal journal(unit.path);
+        journal.Load();
+        // 只清理已完成的构建；没有步骤日志的构建无法在之后识别出被清理过
+        if (!journal.complete || journal.pruned || unit.bytes == 0) return false;
+        const auto package_lock = FileLock::TryAcquire(PackageLockFile(unit.id, unit.config_name));
+        if (!package_lock) return false;
+        // 主配置的构建目录同时是所有构建配置共享的源码目录
+        std::unique_ptr<FileLock> source_lock;
+        if (unit.config_name.empty()) {
+            source_lock = FileLock::TryAcquire(SourceLockFile(unit.id));
+            if (!source_lock) return false;
+        }
+        if (options_.dry_run) return true;
+
+        // 先标记再删除：删除中途失败时，下一次构建同样会从第一个步骤开始
+        journal.pruned = true;
+        if (!journal.Save()) return false;
+        const auto keep = BuildTreeMetadata(unit.path);
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(unit.path, ec)) {
+            if (keep.count(entry.path().filename().string())) continue;
+            std::error_code remove_ec;
+            fs::remove_all(entry.path(), remove_ec);
+            if (remove_ec) std::cerr << "警告: 无法删除 " << entry.path() << ": " << remove_ec.message() << std::endl;
+        }
+        return true;
+    }
+
+    bool GarbageCollector::EvictDownloads(const GcUnit& unit) const {
+        if (protected_.count(PackageKey(unit.id))) return false;
+        const auto source_lock = FileLock::TryAcquire(SourceLockFile(unit.id));
+        if (!source_lock) return false;
+        const auto package_lock = FileLock::TryAcquire(PackageLockFile(unit.id));
+        return package_lock && RemoveTree(unit.path);
+    }
+
+    bool GarbageCollector::EvictMirror(const GcUnit& unit) const {
+        const std::string name = unit.path.filename().string();
+        if (referenced_mirrors_.count(name)) return false;
+        const auto lock = FileLock::TryAcquire(MirrorLockFile(unit.path));
+        return lock && RemoveTree(unit.path);
+    }
+
+    void GarbageCollector::CollectStore(uint64_t budget) {
+        // 进行中的 Ingest 持有共享锁，它们已放入存储的对象还没有清单引用；标记和清除之间不能有新的清单写入
+        const auto store_lock = SharedFileLock::TryAcquire(PackageStore::LockFile(), SharedFileLock::Mode::Exclusive);
+        if (!store_lock) {
+            std::cout << "--- gc: the store is being written. Skipping store objects. ---" << std::endl;
+            return;
+        }
+
+        // 对象按进入存储的时间排序
+        const fs::path objects_root = PackageStore::DefaultRoot() / "objects";
+        std::map<std::string, GcUnit> objects;  // 相对于 objects/ 的路径 -> 对象
+        uint64_t total = 0;
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(objects_root, ec);
+             !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            struct stat st {};
+            if (lstat(it->path().c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            GcUnit unit;
+            unit.path = it->path();
+            unit.bytes = static_cast<uint64_t>(st.st_size);
+            unit.last_access = std::max<int64_t>(st.st_ctim.tv_sec, 1);
+            total += unit.bytes;
+            objects[it->path().lexically_relative(objects_root).generic_string()] = std::move(unit);
+        }
+        if (total <= budget) return;
+        const uint64_t before = total;
+
+        // 标记：所有构建目录中的清单引用的对象都是存活的，不论安装目录是否存在
+        std::map<std::string, int> references;
+        std::vector<std::pair<GcUnit, std::vector<std::string>>> retirable;  // 安装目录已不存在的清单
+        for (auto& unit : ListPackageDirs(kGcpkgDir / "buildtrees")) {
+            std::vector<std::string> manifest_objects;
+            if (!PackageStore::ManifestObjects(PackageStore::ManifestPath(unit.path), manifest_objects)) continue;
+            for (const auto& object : manifest_objects) ++references[object];
+            std::error_code install_ec;
+            if (!fs::exists(PackageInstallDir(unit.id, unit.config_name), install_ec)) {
+                retirable.emplace_back(std::move(unit), std::move(manifest_objects));
+            }
+        }
+
+        // 清除：没有被任何清单引用的对象
+        auto remove_object = [&](const GcUnit& object) {
+            std::error_code remove_ec;
+            if (!options_.dry_run && !fs::remove(object.path, remove_ec)) return;
+            total -= object.bytes;
+            ++evicted_;
+            freed_bytes_ += object.bytes;
+        };
+        std::vector<const GcUnit*> garbage;
+        for (const auto& [object, unit] : objects) {
+            if (!references.count(object)) garbage.push_back(&unit);
+        }
+        std::sort(garbage.begin(), garbage.end(),
+                  [](const GcUnit* a, const GcUnit* b) { return a->last_access < b->last_access; });
+        for (const GcUnit* object : garbage) {
+            if (total <= budget || stop_.stop_requested()) break;
+            remove_object(*object);
+        }
+
+        // 仍然超出时按最近最少使用的顺序退役已回收的安装目录的清单，之后这些包需要重新构建而不是只重建链接
+        for (auto& [unit, manifest_objects] : retirable) {
+            const auto it = access_.find(IndexKey(PackageInstallDir(unit.id, unit.config_name)));
+            unit.last_access = it != access_.end() ? it->second : 0;
+        }
+        std::sort(retirable.begin(), retirable.end(),
+                  [](const auto& a, const auto& b) { return a.first.last_access < b.first.last_access; });
+        for (const auto& [unit, manifest_objects] : retirable) {
+            if (total <= budget || stop_.stop_requested()) break;
+            if (protected_.count(PackageKey(unit.id))) continue;
+            const auto package_lock = FileLock::TryAcquire(PackageLockFile(unit.id, unit.config_name));
+            if (!package_lock) continue;
+            std::error_code remove_ec;
+            if (!options_.dry_run && !fs::remove(PackageStore::ManifestPath(unit.path), remove_ec)) continue;
+            for (const auto& object : manifest_objects) {
+                auto object_it = objects.find(object);
+                if (--references[object] == 0 && object_it != objects.end()) remove_object(object_it->second);
+            }
+        }
+
+        std::cout << "--- gc: store " << ToMiB(before) << " MiB -> " << ToMiB(total) << " MiB ---" << std::endl;
+        if (total > budget && !stop_.stop_requested()) {
+            std::cerr << "警告: store 仍占用 " << ToMiB(total) << " MiB，超出预算 " << ToMiB(budget)
+                      << " MiB；其余对象仍被安装目录或受保护的包引用。" << std::endl;
+        }
+    }
+
+    bool CollectGarbage(const GcOptions& options, std::stop_token stop) {
+        std::cout << "--- Collecting garbage" << (options.dry_run ? " (dry run)" : "") << " ---" << std::endl;
+        return GarbageCollector(options, std::move(stop)).Run();
+    }
+
+    bool RunGarbageCollection(bool dry_run) {
+        toml::table gcpkg_toml;
+        try {
+            gcpkg_toml = toml::parse_file("gcpkg.toml");
+        } catch (const toml::parse_error& err) {
+            std::cerr << "错误: 解析 gcpkg.toml 文件失败: " << err << std::endl;
+            return false;
+        }
+        GcOptions options;
+        options.budget = LoadGcBudget(gcpkg_toml);
+        options.dry_run = dry_run;
+        const GcBudget& budget = options.budget;
+        if (budget.packages_bytes == 0 && budget.buildtrees_bytes == 0 && budget.downloads_bytes == 0 &&
+            budget.git_bytes == 0 && budget.store_bytes == 0) {
+            std::cerr << "警告: gcpkg.toml 的 [gc] 中没有设置任何容量上限 (packages_max、buildtrees_max、"
+                         "downloads_max、git_max、store_max)，不会回收任何内容。"
+                      << std::endl;
+            return true;
+        }
+        return CollectGarbage(options);
+    }
+
+    BackgroundGc::BackgroundGc(GcOptions options)
+        : thread_([options = std::move(options)](std::stop_token stop) {
+              // Linux 上 nice 值和 I/O 优先级都是线程级别的，只降低本线程
+              const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+              setpriority(PRIO_PROCESS, tid, 19);
+              syscall(SYS_ioprio_set, kIoprioWhoProcess, tid, kIoprioClassIdle << kIoprioClassShift);
+              CollectGarbage(options, stop);
+          }) {}
+
+    BackgroundGc::~BackgroundGc() {
+        // 等待本轮回收完成，而不是让 jthread 的析构请求停止，否则较短的构建会使回收总是半途而废
+        if (thread_.joinable()) thread_.join();
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef MAINPROCESS_GARBAGECOLLECTOR_H
+#define MAINPROCESS_GARBAGECOLLECTOR_H
+
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MainProcess/DependencyGraph.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // 各区域的容量上限 (字节)，来自 gcpkg.toml 的 [gc] 表；0 表示该区域不回收
+    struct GcBudget {
+        uint64_t packages_bytes = 0;    // packages_max：gcpkg/packages 中的安装目录
+        uint64_t buildtrees_bytes = 0;  // buildtrees_max：构建目录中除下载和步骤元数据以外的内容
+        uint64_t downloads_bytes = 0;   // downloads_max：构建目录中的 _downloads
+        uint64_t git_bytes = 0;         // git_max：gcpkg/cache/git 中的裸镜像
+        uint64_t store_bytes = 0;       // store_max：gcpkg/store 中的对象，只回收没有存储清单引用的对象
+        bool automatic = false;         // auto：需要构建的安装会话开始时在后台回收
+    };
+
+    GcBudget LoadGcBudget(const toml::table& gcpkg_toml);
+
+    struct GcOptions {
+        GcBudget budget;
+        std::set<std::string> protected_packages;  // 额外保护的包 (name@version)，例如进行中的会话的依赖图
+        bool dry_run = false;                      // 只打印会回收的条目
+    };
+
+    /**
+     * @brief 记录一批条目刚被使用过，写入访问时间索引 (gcpkg/gc/access.tsv)。
+     *
+     * 条目是相对于 gcpkg/ 的路径，例如 "packages/zlib/1.3.1"。索引在跨进程锁下合并写入。
+     */
+    void RecordAccess(const std::vector<std::string>& entries);
+
+    // 目录中普通文件的总大小，不跟随符号链接；skip 中的顶层条目不计入
+    uint64_t DirectoryBytes(const std::filesystem::path& dir, const std::set<std::string>& skip = {});
+
+    // git 镜像的跨进程锁：gcpkg/locks/git/<镜像目录名>.lock，获取和检出期间持有，gc 据此跳过正在使用的镜像
+    std::filesystem::path MirrorLockFile(const std::filesystem::path& mirror);
+
+    // 依赖图中每个包用到的安装目录、构建目录和下载目录，供 RecordAccess 使用
+    std::vector<std::string> GraphAccessEntries(const DependencyGraph& graph);
+
+    // 依赖图中所有包的 name@version，供 GcOptions::protected_packages 使用
+    std::set<std::string> GraphPackageKeys(const DependencyGraph& graph);
+
+    /**
+     * @brief 按最近最少使用的顺序回收超出预算的区域。
+     *
+     * 依次处理安装目录、构建目录、下载目录、git 镜像和存储对象。以下条目永远不会被回收：
+     * gcpkg.lock、可以恢复的会话 (gcpkg/session/session.toml) 或任何进行中的会话 (LiveSession) 引用的包、
+     * options.protected_packages、其他进程正持有锁的包和源码、仍有已安装的包依赖于它的安装目录、
+     * 仍被检出目录通过 alternates 引用的镜像。
+     *
+     * 回收的安装目录的文件仍作为对象留在存储中，再次安装时只需按清单重建链接；
+     * 回收的构建目录保留步骤日志，之后需要重新执行步骤时从第一个步骤开始。
+     * 存储对象按标记-清除回收：所有清单引用的对象都是存活的，仍超出预算时才退役已回收的安装目录的清单。
+     * 有 Ingest 正在进行时跳过存储。
+     *
+     * @param options 预算和保护集合。
+     * @param stop 请求停止时在当前条目之后结束。
+     * @return 访问时间索引写入成功时返回 true。
+     */
+    bool CollectGarbage(const GcOptions& options, std::stop_token stop = {});
+
+    /**
+     * @brief `gcpkg gc` 的入口：读取 gcpkg.toml 的 [gc] 预算并执行一次回收。
+     */
+    bool RunGarbageCollection(bool dry_run);
+
+    /**
+     * @brief 在低 CPU 和 I/O 优先级的后台线程中执行 CollectGarbage，不占用构建的关键路径。
+     *
+     * 析构时等待回收结束。
+     */
+    class BackgroundGc {
+      public:
+        explicit BackgroundGc(GcOptions options);
+        ~BackgroundGc();
+
+        BackgroundGc(const BackgroundGc&) = delete;
+        BackgroundGc& operator=(const BackgroundGc&) = delete;
+
+      private:
+        std::jthread thread_;
+    };
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_GARBAGECOLLECTOR_H
\ No newline at end of file
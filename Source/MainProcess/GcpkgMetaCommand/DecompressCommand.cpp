@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <iostream>
 
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
 #include "Basic/Utils/VariableProcessor.h"
 
 namespace fs = std::filesystem;
@@ -33,9 +35,19 @@ namespace MainProcess::GcpkgMetaCommand {
     bool Decompress(MetaCommandContext &context, const std::string &file_arg) {
         std::string archive_path_str = Basic::Utils::ExpandVariables(file_arg, context.variables);
         fs::path archive_path(archive_path_str);
-        fs::path extract_dir = fs::path(Basic::Utils::ExpandVariables("${build_dir}", context.variables));
+        fs::path extract_dir = fs::path(Basic::Utils::ExpandVariables("${source_dir}", context.variables));
 
         std::cout << "--- MetaCommand: Decompressing " << archive_path << " to " << extract_dir << " ---" << std::endl;
+        Basic::Trace::Span span("extract", archive_path.filename().string());
+        std::error_code size_ec;
+        span.Arg("bytes", static_cast<int64_t>(fs::file_size(archive_path, size_ec)));
+
+        // 解压吞吐量 = rate(gcpkg_extract_bytes_total) / rate(gcpkg_extract_duration_seconds_sum)
+        static Basic::Metrics::Histogram &duration =
+            Basic::Metrics::GetHistogram("gcpkg_extract_duration_seconds", "Wall time of inner_decompress.");
+        static Basic::Metrics::Counter &extracted_bytes =
+            Basic::Metrics::GetCounter("gcpkg_extract_bytes_total", "Uncompressed bytes written by inner_decompress.");
+        Basic::Metrics::ScopedTimer timer(duration);
 
         struct archive *a;
         struct archive *ext;
@@ -60,20 +72,26 @@ namespace MainProcess::GcpkgMetaCommand {
             return false;
         }
 
-        // 切换工作目录以在此处解压
-        fs::current_path(extract_dir);
-
         for (;;) {
             r = archive_read_next_header(a, &entry);
             if (r == ARCHIVE_EOF) break;
             if (r < ARCHIVE_OK) fprintf(stderr, "%s\n", archive_error_string(a));
             if (r < ARCHIVE_WARN) return false;
 
+            // 将条目路径重定向到解压目录下。不使用 fs::current_path 切换工作目录，
+            // 因为它是进程级状态，会影响并行构建中的其他包。
+            fs::path entry_path = extract_dir / archive_entry_pathname(entry);
+            archive_entry_set_pathname(entry, entry_path.string().c_str());
+            if (const char *hardlink = archive_entry_hardlink(entry)) {
+                archive_entry_set_hardlink(entry, (extract_dir / hardlink).string().c_str());
+            }
+
             r = archive_write_header(ext, entry);
             if (r < ARCHIVE_OK)
                 fprintf(stderr, "%s\n", archive_error_string(ext));
             else if (archive_entry_size(entry) > 0) {
                 r = copy_data(a, ext);
+                extracted_bytes.Add(static_cast<uint64_t>(archive_entry_size(entry)));
                 if (r < ARCHIVE_OK) fprintf(stderr, "%s\n", archive_error_string(ext));
                 if (r < ARCHIVE_WARN) return false;
             }
@@ -87,9 +105,6 @@ namespace MainProcess::GcpkgMetaCommand {
         archive_write_close(ext);
         archive_write_free(ext);
 
-        // 恢复工作目录
-        fs::current_path(Basic::Utils::ExpandVariables("${gcpkg_root}", context.variables));
-
         std::cout << "--- MetaCommand: Decompression successful ---" << std::endl;
         return true;
     }
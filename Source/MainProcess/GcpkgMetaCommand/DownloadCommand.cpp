@@ -1,11 +1,16 @@
 #include "MainProcess/GcpkgMetaCommand/DownloadCommand.h"
 
 #include <curl/curl.h>
+#include <unistd.h>
 
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
 #include <thread>
 
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
 #include "Basic/Utils/VariableProcessor.h"
 
 namespace fs = std::filesystem;
@@ -18,14 +23,38 @@ namespace MainProcess::GcpkgMetaCommand {
         return written;
     }
 
+    /**
+     * 进程内共享的连接、DNS 和 TLS 会话缓存。同一会话中对同一主机的多次下载复用连接，
+     * 守护进程中的缓存跨会话保留。调用前必须已经执行 curl_global_init。
+     */
+    static CURLSH *SharedCurlHandle() {
+        static std::mutex locks[CURL_LOCK_DATA_LAST];
+        static CURLSH *share = [] {
+            CURLSH *handle = curl_share_init();
+            curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, +[](CURL *, curl_lock_data data, curl_lock_access, void *) {
+                locks[data].lock();
+            });
+            curl_share_setopt(
+                handle, CURLSHOPT_UNLOCKFUNC, +[](CURL *, curl_lock_data data, void *) { locks[data].unlock(); });
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            return handle;
+        }();
+        return share;
+    }
+
     std::string Download(MetaCommandContext &context, const std::string &url_arg) {
         std::string expanded_url = Basic::Utils::ExpandVariables(url_arg, context.variables);
         std::string proxy = Basic::Utils::ExpandVariables("${docker_proxy}", context.variables);
         unsigned int num_threads = std::thread::hardware_concurrency();
         if (num_threads == 0) num_threads = 8;  // 默认值
 
+        // curl_global_init 不是线程安全的，并行构建时只能初始化一次
+        static std::once_flag curl_init_flag;
+        std::call_once(curl_init_flag, [] { curl_global_init(CURL_GLOBAL_ALL); });
+
         CURL *curl_handle;
-        curl_global_init(CURL_GLOBAL_ALL);
         curl_handle = curl_easy_init();
         if (!curl_handle) {
             std::cerr << "错误: cURL 初始化失败。" << std::endl;
@@ -35,13 +64,16 @@ namespace MainProcess::GcpkgMetaCommand {
         fs::path url_path(expanded_url);
         std::string filename = url_path.filename().string();
         fs::path download_dir =
-            fs::path(Basic::Utils::ExpandVariables("${build_dir}", context.variables)) / "_downloads";
+            fs::path(Basic::Utils::ExpandVariables("${source_dir}", context.variables)) / "_downloads";
         fs::create_directories(download_dir);
         fs::path dest_path = download_dir / filename;
+        // 先写入临时文件，成功后再改名，中断的下载不会留下看似完整的文件
+        fs::path part_path = dest_path;
+        part_path += ".part-" + std::to_string(getpid());
 
-        FILE *fp = fopen(dest_path.string().c_str(), "wb");
+        FILE *fp = fopen(part_path.string().c_str(), "wb");
         if (!fp) {
-            std::cerr << "错误: 无法创建文件 " << dest_path << std::endl;
+            std::cerr << "错误: 无法创建文件 " << part_path << std::endl;
             curl_easy_cleanup(curl_handle);
             return "";
         }
@@ -49,6 +81,7 @@ namespace MainProcess::GcpkgMetaCommand {
         std::cout << "--- MetaCommand: Downloading " << expanded_url << " to " << dest_path << " ---" << std::endl;
 
         curl_easy_setopt(curl_handle, CURLOPT_URL, expanded_url.c_str());
+        curl_easy_setopt(curl_handle, CURLOPT_SHARE, SharedCurlHandle());
         curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, write_data);
         curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, fp);
         if (!proxy.empty()) {
@@ -58,13 +91,37 @@ namespace MainProcess::GcpkgMetaCommand {
         // 这里我们仅用一个线程作为示例，但遵循了多线程的配置意图。
         // curl_easy_setopt(curl_handle, CURLOPT_MAXCONNECTS, num_threads);
 
+        static Basic::Metrics::Histogram &duration =
+            Basic::Metrics::GetHistogram("gcpkg_download_duration_seconds", "Wall time of inner_download.");
+        static Basic::Metrics::Counter &bytes_total =
+            Basic::Metrics::GetCounter("gcpkg_download_bytes_total", "Bytes received by inner_download.");
+        static Basic::Metrics::Counter &failures =
+            Basic::Metrics::GetCounter("gcpkg_download_failures_total", "Downloads that failed.");
+
+        Basic::Trace::Span span("download", filename);
+        span.Arg("url", expanded_url);
+        const auto start = std::chrono::steady_clock::now();
         CURLcode res = curl_easy_perform(curl_handle);
+        duration.Record(std::chrono::steady_clock::now() - start);
 
+        curl_off_t downloaded_bytes = 0;
+        curl_easy_getinfo(curl_handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded_bytes);
+        span.Arg("bytes", static_cast<int64_t>(downloaded_bytes));
+        bytes_total.Add(static_cast<uint64_t>(downloaded_bytes));
+        if (res != CURLE_OK) failures.Add();
         fclose(fp);
         curl_easy_cleanup(curl_handle);
 
+        std::error_code ec;
         if (res != CURLE_OK) {
             std::cerr << "错误: 下载失败: " << curl_easy_strerror(res) << std::endl;
+            fs::remove(part_path, ec);
+            return "";
+        }
+        fs::rename(part_path, dest_path, ec);
+        if (ec) {
+            std::cerr << "错误: 无法把下载的文件移动到 " << dest_path << ": " << ec.message() << std::endl;
+            fs::remove(part_path, ec);
             return "";
         }
 
@@ -0,0 +1,188 @@
+#include "MainProcess/GcpkgMetaCommand/FileCommands.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Basic/Utils/ContentHash.h"
+#include "Basic/Utils/FileClone.h"
+#include "Basic/Utils/VariableProcessor.h"
+#include "MainProcess/GcpkgMetaCommand/MetaCommandRegistry.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    // 拆分参数并展开其中的变量
+    static std::vector<std::string> ExpandArguments(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> result = SplitArguments(args);
+        for (auto &arg : result) {
+            arg = Basic::Utils::ExpandVariables(arg, context.variables);
+        }
+        return result;
+    }
+
+    static bool CopyFile(const fs::path &src, const fs::path &dst, bool hardlink) {
+        std::error_code ec;
+        if (fs::exists(dst, ec)) fs::remove(dst, ec);
+
+        if (hardlink) {
+            fs::create_hard_link(src, dst, ec);
+            if (!ec) return true;
+        }
+        if (Basic::Utils::ReflinkFile(src, dst)) return true;
+
+        fs::copy_file(src, dst, fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "错误: 无法复制 " << src << " 到 " << dst << ": " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // src 与 dst 是同一个目录项时，复制前删除 dst 会删掉源文件。dst 不存在时 equivalent 报错，视为不同；
+    // 互为硬链接的两个路径虽然 equivalent，但删除 dst 不影响 src
+    static bool SameFile(const fs::path &src, const fs::path &dst) {
+        std::error_code ec;
+        if (!fs::equivalent(src, dst, ec)) return false;
+        auto entry = [&](fs::path path) {
+            if (!path.has_filename()) path = path.parent_path();  // 去掉目录末尾的 '/'
+            return fs::weakly_canonical(path.parent_path(), ec) / path.filename();
+        };
+        return entry(src) == entry(dst);
+    }
+
+    bool Copy(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> argv = ExpandArguments(context, args);
+        bool hardlink = !argv.empty() && argv.front() == "--hardlink";
+        if (hardlink) argv.erase(argv.begin());
+        if (argv.size() != 2) {
+            std::cerr << "错误: inner_copy 需要两个参数: [--hardlink] <src> <dst>" << std::endl;
+            return false;
+        }
+
+        fs::path src = ResolvePath(context, argv[0]);
+        fs::path dst = ResolvePath(context, argv[1]);
+        std::cout << "--- MetaCommand: Copying " << src << " to " << dst << " ---" << std::endl;
+
+        if (SameFile(src, dst)) {
+            std::cerr << "错误: inner_copy 的源和目标是同一个路径: " << src << std::endl;
+            return false;
+        }
+
+        std::error_code ec;
+        if (fs::is_symlink(src, ec)) {
+            fs::remove(dst, ec);
+            fs::copy_symlink(src, dst, ec);
+            return !ec;
+        }
+        if (!fs::is_directory(src, ec)) {
+            if (!fs::exists(src, ec)) {
+                std::cerr << "错误: 要复制的文件不存在: " << src << std::endl;
+                return false;
+            }
+            if (fs::is_directory(dst, ec)) dst /= src.filename();
+            if (SameFile(src, dst)) {
+                std::cerr << "错误: inner_copy 的源和目标是同一个文件: " << src << std::endl;
+                return false;
+            }
+            fs::create_directories(dst.parent_path(), ec);
+            return CopyFile(src, dst, hardlink);
+        }
+
+        fs::create_directories(dst, ec);
+        for (auto it = fs::recursive_directory_iterator(src, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            fs::path target = dst / fs::relative(it->path(), src);
+            if (it->is_symlink()) {
+                fs::remove(target, ec);
+                fs::copy_symlink(it->path(), target, ec);
+            } else if (it->is_directory()) {
+                fs::create_directories(target, ec);
+            } else {
+                fs::create_directories(target.parent_path(), ec);
+                if (!CopyFile(it->path(), target, hardlink)) return false;
+            }
+            if (ec) break;
+        }
+        if (ec) {
+            std::cerr << "错误: 复制目录 " << src << " 失败: " << ec.message() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool Write(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> argv = ExpandArguments(context, args);
+        bool append = !argv.empty() && argv.front() == "--append";
+        if (append) argv.erase(argv.begin());
+        if (argv.empty() || argv.size() > 2) {
+            std::cerr << "错误: inner_write 需要参数: [--append] <file> [content]" << std::endl;
+            return false;
+        }
+
+        std::string content;
+        const std::string raw = argv.size() == 2 ? argv[1] : "";
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] == '\\' && i + 1 < raw.size() && (raw[i + 1] == 'n' || raw[i + 1] == 't')) {
+                content += raw[++i] == 'n' ? '\n' : '\t';
+            } else {
+                content += raw[i];
+            }
+        }
+
+        fs::path file = ResolvePath(context, argv[0]);
+        std::cout << "--- MetaCommand: Writing " << file << " ---" << std::endl;
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+        std::ofstream out(file, append ? std::ios::binary | std::ios::app : std::ios::binary | std::ios::trunc);
+        out << content;
+        if (!out) {
+            std::cerr << "错误: 无法写入文件 " << file << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool MakeDirectories(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> argv = ExpandArguments(context, args);
+        if (argv.empty()) {
+            std::cerr << "错误: inner_mkdir 需要至少一个目录参数。" << std::endl;
+            return false;
+        }
+        for (const auto &dir : argv) {
+            fs::path path = ResolvePath(context, dir);
+            std::error_code ec;
+            fs::create_directories(path, ec);
+            if (ec) {
+                std::cerr << "错误: 无法创建目录 " << path << ": " << ec.message() << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Hash(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> argv = ExpandArguments(context, args);
+        if (argv.empty() || argv.size() > 2) {
+            std::cerr << "错误: inner_hash 需要参数: <file> [expected]" << std::endl;
+            return false;
+        }
+
+        fs::path file = ResolvePath(context, argv[0]);
+        std::string hash = Basic::Utils::HashFile(file);
+        if (hash.empty()) {
+            std::cerr << "错误: 无法读取文件 " << file << std::endl;
+            return false;
+        }
+        context.variables["${last_hash}"] = hash;
+        std::cout << "--- MetaCommand: " << file.filename().string() << " = " << hash << " ---" << std::endl;
+
+        if (argv.size() == 2 && argv[1] != hash) {
+            std::cerr << "错误: 文件 " << file << " 的摘要不匹配，期望 " << argv[1] << "，实际 " << hash << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+}  // namespace MainProcess::GcpkgMetaCommand
\ No newline at end of file
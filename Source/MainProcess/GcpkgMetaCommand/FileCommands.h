@@ -0,0 +1,24 @@
+#ifndef GCPKG_FILECOMMANDS_H
+#define GCPKG_FILECOMMANDS_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    // inner_copy [--hardlink] <src> <dst>：优先使用 reflink 复制，目录递归复制
+    bool Copy(MetaCommandContext &context, const std::string &args);
+
+    // inner_write [--append] <file> <content>：content 中的 \n 和 \t 会被转义为换行和制表符
+    bool Write(MetaCommandContext &context, const std::string &args);
+
+    // inner_mkdir <dir>...
+    bool MakeDirectories(MetaCommandContext &context, const std::string &args);
+
+    // inner_hash <file> [expected]：摘要写入 ${last_hash}；给出 expected 时不一致即失败
+    bool Hash(MetaCommandContext &context, const std::string &args);
+
+}  // namespace MainProcess::GcpkgMetaCommand
+
+#endif  // GCPKG_FILECOMMANDS_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "MainProcess/GcpkgMetaCommand/GitFetchCommand.h"
+
+#include <charconv>
+#include <filesystem>
+#include <iostream>
+
+#include "Basic/SystemIntegrate/GitMirror/GitMirror.h"
+#include "Basic/Utils/FileLock.h"
+#include "Basic/Utils/VariableProcessor.h"
+#include "MainProcess/GarbageCollector.h"
+#include "MainProcess/GcpkgMetaCommand/MetaCommandRegistry.h"
+
+namespace fs = std::filesystem;
+namespace GitMirror = Basic::SystemIntegrate::GitMirror;
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    bool GitFetch(MetaCommandContext &context, const std::string &args) {
+        GitMirror::GitFetchOptions options;
+        options.cache_dir = fs::absolute("gcpkg/cache/git");
+
+        std::vector<std::string> positional;
+        for (const auto &arg : SplitArguments(args)) {
+            if (arg.rfind("--depth=", 0) == 0) {
+                auto [end, ec] = std::from_chars(arg.data() + 8, arg.data() + arg.size(), options.depth);
+                if (ec != std::errc() || end != arg.data() + arg.size() || options.depth < 0) {
+                    std::cerr << "错误: inner_git_fetch 的参数无效: " << arg << std::endl;
+                    return false;
+                }
+            } else if (arg == "--alternates") {
+                options.mode = GitMirror::CheckoutMode::Alternates;
+            } else {
+                positional.push_back(Basic::Utils::ExpandVariables(arg, context.variables));
+            }
+        }
+        if (positional.size() > 3) {
+            std::cerr << "错误: inner_git_fetch 需要参数: [--depth=N] [--alternates] [url] [ref] [dest]" << std::endl;
+            return false;
+        }
+
+        std::string url = positional.size() > 0 ? positional[0] : context.variables["${url}"];
+        std::string ref = positional.size() > 1 ? positional[1] : context.variables["${ref}"];
+        std::string dest = positional.size() > 2
+                               ? ResolvePath(context, positional[2])
+                               : (fs::path(context.variables["${source_dir}"]) / "source").string();
+        if (url.empty()) {
+            std::cerr << "错误: inner_git_fetch 没有可用的 url，请在 port 的 [packages] 中设置。" << std::endl;
+            return false;
+        }
+
+        const fs::path mirror = GitMirror::MirrorPath(options.cache_dir, url);
+        Basic::Utils::FileLock mirror_lock(MirrorLockFile(mirror), "git mirror " + mirror.filename().string());
+        RecordAccess({"cache/git/" + mirror.filename().string()});
+        std::string commit;
+        if (!GitMirror::FetchGitSource(url, ref, dest, options, &commit)) {
+            return false;
+        }
+        context.variables["${git_commit}"] = commit;
+        return true;
+    }
+
+}  // namespace MainProcess::GcpkgMetaCommand
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef GCPKG_GITFETCHCOMMAND_H
+#define GCPKG_GITFETCHCOMMAND_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    /**
+     * @brief inner_git_fetch [--depth=N] [--alternates] [url] [ref] [dest]：从共享的裸镜像检出 git 源码。
+     *
+     * url 和 ref 默认取 port 的 [packages] url/ref，dest 默认为 ${source_dir}/source。
+     * 镜像保存在 gcpkg/cache/git 下，所有包和版本共用；检出的提交哈希写入 ${git_commit}。
+     */
+    bool GitFetch(MetaCommandContext &context, const std::string &args);
+
+}  // namespace MainProcess::GcpkgMetaCommand
+
+#endif  // GCPKG_GITFETCHCOMMAND_H
\ No newline at end of file
@@ -10,6 +10,7 @@ namespace MainProcess::GcpkgMetaCommand {
     struct MetaCommandContext {
         std::string last_downloaded_file;               // 用于 ${last_file}
         std::map<std::string, std::string>& variables;  // 引用变量映射以进行扩展
+        std::string work_dir;                           // 当前步骤的工作目录，相对路径以此为基准
     };
 
 }  // namespace MainProcess::GcpkgMetaCommand
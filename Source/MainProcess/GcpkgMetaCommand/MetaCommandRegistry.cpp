@@ -0,0 +1,102 @@
+#include "MainProcess/GcpkgMetaCommand/MetaCommandRegistry.h"
+
+#include <filesystem>
+#include <string_view>
+
+#include "MainProcess/GcpkgMetaCommand/DecompressCommand.h"
+#include "MainProcess/GcpkgMetaCommand/DownloadCommand.h"
+#include "MainProcess/GcpkgMetaCommand/FileCommands.h"
+#include "MainProcess/GcpkgMetaCommand/GitFetchCommand.h"
+#include "MainProcess/GcpkgMetaCommand/PatchCommand.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    MetaCommandRegistry &MetaCommandRegistry::Instance() {
+        static MetaCommandRegistry registry;
+        return registry;
+    }
+
+    MetaCommandRegistry::MetaCommandRegistry() {
+        Register({"inner_download",
+                  [](MetaCommandContext &context, const std::string &args) {
+                      context.last_downloaded_file = Download(context, args);
+                      return !context.last_downloaded_file.empty();
+                  },
+                  true,
+                  true});
+        Register({"inner_decompress",
+                  [](MetaCommandContext &context, const std::string &args) { return Decompress(context, args); },
+                  true,
+                  false});
+        Register({"inner_git_fetch", GitFetch, true, false});
+        Register({"inner_copy", Copy});
+        Register({"inner_patch", Patch, true, false});
+        Register({"inner_write", Write});
+        Register({"inner_mkdir", MakeDirectories});
+        Register({"inner_hash", Hash});
+    }
+
+    void MetaCommandRegistry::Register(MetaCommand command) {
+        std::string name = command.name;
+        commands_[name] = std::move(command);
+    }
+
+    const MetaCommand *MetaCommandRegistry::Match(const std::string &command, std::string &args) const {
+        size_t name_end = command.find_first_of(" \t");
+        auto it = commands_.find(command.substr(0, name_end));
+        if (it == commands_.end()) return nullptr;
+
+        size_t args_begin =
+            name_end == std::string::npos ? std::string::npos : command.find_first_not_of(" \t", name_end);
+        args = args_begin == std::string::npos ? "" : command.substr(args_begin);
+        return &it->second;
+    }
+
+    std::vector<std::string> SplitArguments(const std::string &args) {
+        std::vector<std::string> result;
+        std::string current;
+        bool in_token = false;
+        char quote = 0;
+
+        for (size_t i = 0; i < args.size(); ++i) {
+            char c = args[i];
+            if (quote) {
+                if (c == quote) {
+                    quote = 0;
+                } else if (c == '\\' && quote == '"' && i + 1 < args.size() &&
+                           std::string_view("\"\\$`").find(args[i + 1]) != std::string_view::npos) {
+                    // 与 sh 相同，双引号内只有 \" \\ \$ \` 是转义，其他反斜杠原样保留 (如 Windows 路径)
+                    current += args[++i];
+                } else {
+                    current += c;
+                }
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+                in_token = true;
+            } else if (c == '\\' && i + 1 < args.size()) {
+                current += args[++i];
+                in_token = true;
+            } else if (c == ' ' || c == '\t') {
+                if (in_token) result.push_back(std::move(current));
+                current.clear();
+                in_token = false;
+            } else {
+                current += c;
+                in_token = true;
+            }
+        }
+        if (in_token) result.push_back(std::move(current));
+        return result;
+    }
+
+    std::string ResolvePath(const MetaCommandContext &context, const std::string &path) {
+        fs::path resolved(path);
+        if (resolved.is_relative() && !context.work_dir.empty()) {
+            resolved = fs::path(context.work_dir) / resolved;
+        }
+        return resolved.lexically_normal().string();
+    }
+
+}  // namespace MainProcess::GcpkgMetaCommand
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef GCPKG_METACOMMANDREGISTRY_H
+#define GCPKG_METACOMMANDREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MetaCommand.h"
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    // 元命令的处理函数；args 为命令名之后的参数文本 (已展开变量)
+    using MetaCommandHandler = std::function<bool(MetaCommandContext &context, const std::string &args)>;
+
+    struct MetaCommand {
+        std::string name;
+        MetaCommandHandler run;
+        bool shares_source = false;      // 修改包的共享源码目录，同一个包的各构建配置只执行一次 (按展开后的命令)
+        bool produces_download = false;  // 执行后 last_downloaded_file 是新下载的文件，需要记录到步骤日志
+    };
+
+    /**
+     * @brief 在宿主机进程内执行的元命令 (inner_*) 注册表。
+     *
+     * 构建计划中以已登记的名称开头的命令不再通过 docker exec 执行，而是直接调用处理函数。
+     * 内置命令在第一次使用时登记；新的元命令只需调用 Register。
+     */
+    class MetaCommandRegistry {
+      public:
+        static MetaCommandRegistry &Instance();
+
+        void Register(MetaCommand command);
+
+        // command 是已登记的元命令时返回它，并把参数文本写入 args；否则返回 nullptr
+        const MetaCommand *Match(const std::string &command, std::string &args) const;
+
+      private:
+        MetaCommandRegistry();
+
+        std::unordered_map<std::string, MetaCommand> commands_;
+    };
+
+    /**
+     * @brief 按 shell 的规则拆分参数：支持单引号、双引号和反斜杠转义，不做变量展开。
+     */
+    std::vector<std::string> SplitArguments(const std::string &args);
+
+    // 相对路径以 context.work_dir 为基准解析
+    std::string ResolvePath(const MetaCommandContext &context, const std::string &path);
+
+}  // namespace MainProcess::GcpkgMetaCommand
+
+#endif  // GCPKG_METACOMMANDREGISTRY_H
\ No newline at end of file
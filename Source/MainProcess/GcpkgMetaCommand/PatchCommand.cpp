@@ -0,0 +1,320 @@
+#include "MainProcess/GcpkgMetaCommand/PatchCommand.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+#include "Basic/Utils/VariableProcessor.h"
+#include "MainProcess/GcpkgMetaCommand/MetaCommandRegistry.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    namespace {
+
+        struct Hunk {
+            size_t old_start = 0;
+            std::vector<std::string> old_lines;  // 上下文与删除的行
+            std::vector<std::string> new_lines;  // 上下文与新增的行
+            bool old_no_newline = false;
+            bool new_no_newline = false;
+        };
+
+        struct FilePatch {
+            std::string old_path;
+            std::string new_path;
+            std::vector<Hunk> hunks;
+        };
+
+        struct TextFile {
+            std::vector<std::string> lines;
+            bool trailing_newline = true;
+            std::string line_ending = "\n";  // 按第一行的换行符写回，CRLF 文件打补丁后仍是 CRLF
+        };
+
+        // 取 "--- a/foo.c\t2024-01-01" 中的路径部分
+        std::string HeaderPath(const std::string &line) {
+            std::string path = line.substr(4);
+            size_t tab = path.find('\t');
+            if (tab != std::string::npos) path.resize(tab);
+            while (!path.empty() && (path.back() == ' ' || path.back() == '\r')) path.pop_back();
+            return path;
+        }
+
+        std::optional<std::string> StripComponents(const std::string &path, int strip) {
+            if (path == "/dev/null") return path;
+            size_t pos = 0;
+            for (int i = 0; i < strip; ++i) {
+                pos = path.find('/', pos);
+                if (pos == std::string::npos) return std::nullopt;
+                ++pos;
+            }
+            return path.substr(pos);
+        }
+
+        bool ParseHunkHeader(const std::string &line, Hunk &hunk, size_t &old_count, size_t &new_count) {
+            // @@ -l[,s] +l[,s] @@
+            size_t old_start = 0, new_start = 0;
+            old_count = 1;
+            new_count = 1;
+            std::istringstream in(line.substr(2));
+            char sign = 0;
+            if (!(in >> sign >> old_start) || sign != '-') return false;
+            if (in.peek() == ',') {
+                in.get();
+                if (!(in >> old_count)) return false;
+            }
+            if (!(in >> sign >> new_start) || sign != '+') return false;
+            if (in.peek() == ',') {
+                in.get();
+                if (!(in >> new_count)) return false;
+            }
+            // 行号从 1 开始；空的旧区间表示插入到该行之后
+            if (old_count > 0 && old_start == 0) return false;
+            hunk.old_start = old_count == 0 ? old_start : old_start - 1;
+            return true;
+        }
+
+        bool ParsePatch(std::istream &in, std::vector<FilePatch> &patches) {
+            std::string line;
+            FilePatch *current = nullptr;
+            std::string pending_old;
+
+            while (std::getline(in, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+
+                if (line.rfind("--- ", 0) == 0) {
+                    pending_old = HeaderPath(line);
+                } else if (line.rfind("+++ ", 0) == 0 && !pending_old.empty()) {
+                    patches.push_back({pending_old, HeaderPath(line), {}});
+                    current = &patches.back();
+                    pending_old.clear();
+                } else if (line.rfind("@@ ", 0) == 0 && current) {
+                    Hunk hunk;
+                    size_t old_count = 0, new_count = 0;
+                    if (!ParseHunkHeader(line, hunk, old_count, new_count)) {
+                        std::cerr << "错误: 无法解析 hunk 头: " << line << std::endl;
+                        return false;
+                    }
+                    char last = 0;
+                    while ((old_count > 0 || new_count > 0 || in.peek() == '\\') && std::getline(in, line)) {
+                        if (!line.empty() && line.back() == '\r') line.pop_back();
+                        char kind = line.empty() ? ' ' : line[0];
+                        std::string text = line.empty() ? "" : line.substr(1);
+                        if ((kind == ' ' && (old_count == 0 || new_count == 0)) || (kind == '-' && old_count == 0) ||
+                            (kind == '+' && new_count == 0)) {
+                            std::cerr << "错误: hunk 的行数与头部不一致: " << line << std::endl;
+                            return false;
+                        }
+                        if (kind == ' ') {
+                            hunk.old_lines.push_back(text);
+                            hunk.new_lines.push_back(text);
+                            --old_count;
+                            --new_count;
+                        } else if (kind == '-') {
+                            hunk.old_lines.push_back(text);
+                            --old_count;
+                        } else if (kind == '+') {
+                            hunk.new_lines.push_back(text);
+                            --new_count;
+                        } else if (kind == '\\') {
+                            // "\ No newline at end of file" 作用于上一行
+                            if (last != '+') hunk.old_no_newline = true;
+                            if (last != '-') hunk.new_no_newline = true;
+                            continue;
+                        } else {
+                            std::cerr << "错误: hunk 中出现无法识别的行: " << line << std::endl;
+                            return false;
+                        }
+                        last = kind;
+                    }
+                    current->hunks.push_back(std::move(hunk));
+                }
+            }
+            return true;
+        }
+
+        bool ReadTextFile(const fs::path &path, TextFile &file) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) return false;
+            std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            file.lines.clear();
+            file.trailing_newline = content.empty() || content.back() == '\n';
+            const size_t first_newline = content.find('\n');
+            file.line_ending = "\n";
+            if (first_newline != std::string::npos && first_newline > 0 && content[first_newline - 1] == '\r') {
+                file.line_ending = "\r\n";
+            }
+            size_t begin = 0;
+            while (begin < content.size()) {
+                size_t end = content.find('\n', begin);
+                if (end == std::string::npos) end = content.size();
+                std::string line = content.substr(begin, end - begin);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                file.lines.push_back(std::move(line));
+                begin = end + 1;
+            }
+            return true;
+        }
+
+        bool Matches(const std::vector<std::string> &lines, size_t at, const std::vector<std::string> &expected) {
+            if (at + expected.size() > lines.size()) return false;
+            for (size_t i = 0; i < expected.size(); ++i) {
+                if (lines[at + i] != expected[i]) return false;
+            }
+            return true;
+        }
+
+        // 从 hunk 声明的位置向两侧搜索上下文完全一致的位置
+        std::optional<size_t> FindHunk(const std::vector<std::string> &lines, const Hunk &hunk, size_t min_pos) {
+            size_t expected = std::max(hunk.old_start, min_pos);
+            size_t max_offset = lines.size() + 1;
+            for (size_t offset = 0; offset <= max_offset; ++offset) {
+                if (expected + offset <= lines.size() && Matches(lines, expected + offset, hunk.old_lines)) {
+                    return expected + offset;
+                }
+                if (offset > 0 && offset <= expected && expected - offset >= min_pos &&
+                    Matches(lines, expected - offset, hunk.old_lines)) {
+                    return expected - offset;
+                }
+            }
+            return std::nullopt;
+        }
+
+        bool ApplyHunks(TextFile &file, const FilePatch &patch, const std::string &display) {
+            std::vector<std::string> result;
+            size_t cursor = 0;
+            for (size_t i = 0; i < patch.hunks.size(); ++i) {
+                const Hunk &hunk = patch.hunks[i];
+                auto pos = FindHunk(file.lines, hunk, cursor);
+                if (!pos) {
+                    std::cerr << "错误: " << display << " 的第 " << i + 1 << " 个 hunk 无法应用。" << std::endl;
+                    return false;
+                }
+                if (*pos != hunk.old_start) {
+                    std::cout << "--- MetaCommand: Hunk #" << i + 1 << " of " << display << " applied with offset "
+                              << static_cast<long long>(*pos) - static_cast<long long>(hunk.old_start) << " ---"
+                              << std::endl;
+                }
+                result.insert(result.end(), file.lines.begin() + cursor, file.lines.begin() + *pos);
+                result.insert(result.end(), hunk.new_lines.begin(), hunk.new_lines.end());
+                cursor = *pos + hunk.old_lines.size();
+                if (cursor == file.lines.size()) {
+                    if (hunk.new_no_newline) file.trailing_newline = false;
+                    else if (hunk.old_no_newline) file.trailing_newline = true;
+                }
+            }
+            result.insert(result.end(), file.lines.begin() + cursor, file.lines.end());
+            file.lines = std::move(result);
+            return true;
+        }
+
+        bool WriteTextFileAtomically(const fs::path &path, const TextFile &file) {
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            fs::path temp = path;
+            temp += ".gcpkg-patch.tmp";
+            {
+                std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+                for (size_t i = 0; i < file.lines.size(); ++i) {
+                    out << file.lines[i];
+                    if (i + 1 < file.lines.size() || file.trailing_newline) out << file.line_ending;
+                }
+                if (!out) return false;
+            }
+            if (fs::exists(path, ec)) fs::permissions(temp, fs::status(path).permissions(), ec);
+            fs::rename(temp, path, ec);
+            return !ec;
+        }
+
+    }  // namespace
+
+    bool Patch(MetaCommandContext &context, const std::string &args) {
+        std::vector<std::string> argv = SplitArguments(args);
+        int strip = 1;
+        for (auto it = argv.begin(); it != argv.end();) {
+            if (it->rfind("-p", 0) == 0 && it->size() > 2) {
+                auto [end, ec] = std::from_chars(it->data() + 2, it->data() + it->size(), strip);
+                if (ec != std::errc() || end != it->data() + it->size() || strip < 0) {
+                    std::cerr << "错误: inner_patch 的参数无效: " << *it << std::endl;
+                    return false;
+                }
+                it = argv.erase(it);
+            } else {
+                *it = Basic::Utils::ExpandVariables(*it, context.variables);
+                ++it;
+            }
+        }
+        if (argv.empty() || argv.size() > 2) {
+            std::cerr << "错误: inner_patch 需要参数: [-pN] <patch_file> [dir]" << std::endl;
+            return false;
+        }
+
+        fs::path patch_file = ResolvePath(context, argv[0]);
+        fs::path target_dir = argv.size() == 2 ? fs::path(ResolvePath(context, argv[1])) : fs::path(context.work_dir);
+        std::cout << "--- MetaCommand: Applying " << patch_file << " in " << target_dir << " ---" << std::endl;
+
+        std::ifstream in(patch_file);
+        if (!in) {
+            std::cerr << "错误: 无法打开补丁文件 " << patch_file << std::endl;
+            return false;
+        }
+        std::vector<FilePatch> patches;
+        if (!ParsePatch(in, patches)) return false;
+        if (patches.empty()) {
+            std::cerr << "错误: 补丁文件 " << patch_file << " 中没有可应用的内容。" << std::endl;
+            return false;
+        }
+
+        // 先在内存中应用全部补丁，全部成功后再写回
+        struct Result {
+            fs::path path;
+            TextFile file;
+            bool remove = false;
+        };
+        std::vector<Result> results;
+        for (const auto &patch : patches) {
+            auto old_path = StripComponents(patch.old_path, strip);
+            auto new_path = StripComponents(patch.new_path, strip);
+            if (!old_path || !new_path) {
+                std::cerr << "错误: 无法对补丁中的路径应用 -p" << strip << ": " << patch.new_path << std::endl;
+                return false;
+            }
+            const bool creates = *old_path == "/dev/null";
+            const bool removes = *new_path == "/dev/null";
+            fs::path relative = removes ? *old_path : *new_path;
+            fs::path path = (target_dir / relative).lexically_normal();
+
+            Result result{path, {}, removes};
+            // 同一个文件可能在补丁中出现多次，后面的补丁基于前面的结果
+            auto earlier =
+                std::find_if(results.rbegin(), results.rend(), [&](const Result &r) { return r.path == path; });
+            if (earlier != results.rend()) {
+                result.file = earlier->file;
+            } else if (!creates && !ReadTextFile(path, result.file)) {
+                std::cerr << "错误: 补丁要修改的文件不存在: " << path << std::endl;
+                return false;
+            }
+            if (!ApplyHunks(result.file, patch, relative.string())) return false;
+            results.push_back(std::move(result));
+        }
+
+        for (const auto &result : results) {
+            std::error_code ec;
+            if (result.remove) {
+                fs::remove(result.path, ec);
+            } else if (!WriteTextFileAtomically(result.path, result.file)) {
+                std::cerr << "错误: 无法写回文件 " << result.path << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+}  // namespace MainProcess::GcpkgMetaCommand
\ No newline at end of file
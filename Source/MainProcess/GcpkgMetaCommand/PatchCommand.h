@@ -0,0 +1,20 @@
+#ifndef GCPKG_PATCHCOMMAND_H
+#define GCPKG_PATCHCOMMAND_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace MainProcess::GcpkgMetaCommand {
+
+    /**
+     * @brief inner_patch [-pN] <patch_file> [dir]：在宿主机进程内应用 unified diff。
+     *
+     * 默认 -p1，dir 默认为步骤的工作目录。hunk 的位置允许偏移，上下文必须完全一致；
+     * 所有文件都能应用后才统一写回，任何 hunk 失败时源码树保持不变。
+     */
+    bool Patch(MetaCommandContext &context, const std::string &args);
+
+}  // namespace MainProcess::GcpkgMetaCommand
+
+#endif  // GCPKG_PATCHCOMMAND_H
\ No newline at end of file
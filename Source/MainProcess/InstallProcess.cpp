@@ -1,100 +1,149 @@
 #include "MainProcess/InstallProcess.h"
 
-#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <vector>
 
+#include "Basic/DockerExecutor/CgroupLimits.h"
+#include "Basic/DockerExecutor/ContainerStats.h"
+#include "Basic/Log/Log.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/FileLock.h"
+#include "MainProcess/BuildHistory.h"
 #include "MainProcess/BuildPlanner.h"
-#include "MainProcess/DependenciesAnalysis.h"
+#include "MainProcess/DependencyGraph.h"
 #include "MainProcess/EnvironmentSetup.h"
-#include "MainProcess/InstallationContext.h"       // 【新】引入上下文
-#include "MainProcess/InstallationOrchestrator.h"  // 【新】引入协调器
+#include "MainProcess/GarbageCollector.h"
+#include "MainProcess/InstallationContext.h"
+#include "MainProcess/InstallationOrchestrator.h"
+#include "MainProcess/StepFingerprint.h"
+#include "MainProcess/TmpfsBuildTree.h"
 #include "toml++/toml.hpp"
 
-namespace fs = std::filesystem;
-
 namespace MainProcess {
 
     // 公共入口函数，接口不变，委托给协调器
     bool InstallPackage(const std::string& packageSpec) {
-        return PerformInstallation(packageSpec);
+        return PerformInstallation({packageSpec});
     }
 
-    // 内部递归安装函数，接口不变
-    bool InstallPackage(const std::string& packageSpec, std::set<std::string>& processed_packages) {
-        // 1. 检查此会话中是否已处理过
-        if (processed_packages.count(packageSpec)) {
-            std::cout << "--- Package '" << packageSpec << "' already processed in this session. Skipping. ---"
-                      << std::endl;
-            return true;
-        }
+    bool InstallPackages(const std::vector<std::string>& packageSpecs, const InstallOptions& options) {
+        return PerformInstallation(packageSpecs, options);
+    }
+
+    // 在已经确定位置的构建目录中构建；package.log 在返回前关闭，之后才能把构建目录移出 tmpfs
+    static bool BuildPackageInPlace(const PackageNode& node,
+                                    const ResourceFootprint& footprint,
+                                    std::stop_token stop_token) {
+        const std::string& packageSpec = node.spec;
+        // 该包的所有输出写入构建目录中的 package.log，并行构建时终端上只显示各包的进度
+        Basic::Log::PackageScope log_scope(packageSpec,
+                                           BuildLogDir(BuildTreeDir(node.id, node.config_name)) / "package.log");
 
         std::cout << "=================================================" << std::endl;
         std::cout << "--- Installing package: " << packageSpec << " ---" << std::endl;
         std::cout << "=================================================" << std::endl;
 
-        // 2. 解析包描述符
-        std::vector<std::string> parts;
-        std::string part;
-        std::istringstream spec_stream(packageSpec);
-        while (std::getline(spec_stream, part, '@')) {
-            parts.push_back(part);
-        }
-        if (parts.size() != 3) {
-            std::cerr << "错误: 包格式无效。应为 'name@namespace@version'。" << std::endl;
-            return false;
-        }
-        const std::string name = parts[0];
-        const std::string ns = parts[1];
-        const std::string version = parts[2];
-
-        // 3. 【新增】持久化缓存检查
-        fs::path package_dir = fs::path("gcpkg/packages") / name / version;
-        if (fs::exists(package_dir)) {
-            std::cout << "--- Package '" << packageSpec << "' found in cache. Skipping installation. ---" << std::endl;
-            processed_packages.insert(packageSpec);
-            return true;
-        }
+        // 步骤日志先于安装目录创建，锁释放前中断的构建不会被当作已安装
+        MarkBuildStarted(BuildTreeDir(node.id, node.config_name));
+
+        InstallationContext* context = GetCurrentContext();
+        const auto start_time = std::chrono::steady_clock::now();
+        Basic::Trace::Span span("package", packageSpec);
+
+        // 1. 准备环境变量 (委托给 EnvironmentSetup 模块)
+        EnvironmentContext env_context =
+            PrepareEnvironmentForPackage(context->gcpkgToml,
+                                         node.port_toml,
+                                         node.id.name,
+                                         node.id.version,
+                                         node.config_index,
+                                         node.config_name);
+        auto& variables = env_context.variables;
 
-        // 4. 加载配置文件
-        toml::table gcpkg_toml, port_toml;
-        try {
-            gcpkg_toml = toml::parse_file("gcpkg.toml");
-            fs::path port_path = fs::path("gcpkg/port") / ns / name / version / "port.toml";
-            port_toml = toml::parse_file(port_path.string());
-        } catch (const toml::parse_error& err) {
-            std::cerr << "错误: 解析 TOML 文件失败: " << err << std::endl;
-            return false;
+        // 2. 构建“构建计划” (委托给 BuildPlanner 模块)
+        BuildPlan build_plan = CreateBuildPlan(node.port_toml, variables, node.config_index);
+
+        // 3. 执行“构建计划” (委托给 BuildPlanner 模块)，同时记录每个步骤的资源消耗。
+        //    让该包的所有命令运行在自己的 cgroup 中，避免一个构建耗尽内存时波及并行的其他构建。
+        StepRecords step_records;
+        ExecuteOptions options;
+        options.exec_prefix = Basic::DockerExecutor::CgroupEnterPrefix(
+            context->cgroupEnterScript, node.spec, footprint.memory_limit_bytes, footprint.cpu_limit);
+        if (!options.exec_prefix.empty()) {
+            options.cgroup = Basic::DockerExecutor::ChildCgroup(context->containerCgroup,
+                                                                Basic::DockerExecutor::BuildCgroupPath(node.spec));
         }
-
-        // 5. 递归安装依赖项 (调用接口不变)
-        // InstallDependencies 内部调用的 InstallPackage 会自动获取正确的上下文
-        if (!InstallDependencies(packageSpec, port_toml, processed_packages)) {
+        options.step_records = &step_records;
+        options.port_hash = node.port_hash;
+        options.stop_token = stop_token;
+        options.config_index = node.config_index;
+        options.package = packageSpec;
+        options.source_lock = SourceLockFile(node.id);
+        if (!ExecuteBuildPlan(context->containerName,
+                              build_plan,
+                              node.port_toml,
+                              variables,
+                              env_context.env_prefix_command,
+                              options)) {
+            std::cerr << "错误: " << packageSpec << " 的构建过程失败。" << std::endl;
             return false;
         }
 
-        // 6. 【核心修改】从全局上下文中获取容器名
-        std::string containerName = GetCurrentContext()->containerName;
-
-        // 7. 准备环境变量 (委托给 EnvironmentSetup 模块)
-        EnvironmentContext env_context = PrepareEnvironmentForPackage(gcpkg_toml, port_toml, name, version);
-        auto& variables = env_context.variables;
+        // 4. 写入构建历史
+        if (context->history) {
+            BuildRecord record;
+            record.spec = packageSpec;
+            record.port_hash = node.port_hash;
+            record.wall_seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            record.timestamp = static_cast<int64_t>(std::time(nullptr));
+            for (const auto& [step, step_record] : step_records) {
+                record.cpu_seconds += step_record.cpu_seconds;
+                record.peak_memory_bytes = std::max(record.peak_memory_bytes, step_record.peak_memory_bytes);
+            }
+            record.steps = std::move(step_records);
+            record.buildtree_bytes = DirectoryBytes(BuildTreeDir(node.id, node.config_name));
+            context->history->Record(record);
+        }
 
-        // 8. 构建“构建计划” (委托给 BuildPlanner 模块)
-        BuildPlan build_plan = CreateBuildPlan(port_toml, variables);
+        std::cout << "--- Build process for " << packageSpec << " completed successfully! ---" << std::endl;
+        return true;
+    }
 
-        // 9. 执行“构建计划” (委托给 BuildPlanner 模块)
-        if (!ExecuteBuildPlan(containerName, build_plan, port_toml, variables, env_context.env_prefix_command)) {
-            std::cerr << "错误: " << packageSpec << " 的构建过程失败。" << std::endl;
+    bool BuildPackage(const PackageNode& node, const ResourceFootprint& footprint, std::stop_token stop_token) {
+        // 另一个 gcpkg 进程正在构建同一个包时等待它结束，之后已完成的步骤会按步骤日志跳过
+        const auto package_lock = Basic::Utils::FileLock::Acquire(PackageLockFile(node.id, node.config_name),
+                                                                  "package " + node.spec, stop_token);
+        if (!package_lock) {
+            std::cerr << "错误: 构建已被取消，" << node.spec << " 在等待其他 gcpkg 进程时停止。" << std::endl;
             return false;
         }
 
-        processed_packages.insert(packageSpec);
-        std::cout << "--- Build process for " << packageSpec << " completed successfully! ---" << std::endl;
+        InstallationContext* context = GetCurrentContext();
+        BuildTreePlacement placement(context->tmpfs, node, context->history);
 
-        return true;
+        // tmpfs 的页面计入构建的内存 cgroup：内存限制加上预留的容量，构建期间的 OOM kill 也视为 tmpfs 不够用
+        ResourceFootprint placed_footprint = footprint;
+        if (placement.OnTmpfs() && placed_footprint.memory_limit_bytes > 0) {
+            placed_footprint.memory_limit_bytes += placement.Reserved();
+        }
+        const Basic::DockerExecutor::ContainerCgroup cgroup =
+            context->cgroupEnterScript.empty()
+                ? context->containerCgroup
+                : Basic::DockerExecutor::ChildCgroup(context->containerCgroup,
+                                                     Basic::DockerExecutor::BuildCgroupPath(node.spec));
+        const uint64_t oom_kills = Basic::DockerExecutor::ReadOomKills(cgroup);
+        bool built = BuildPackageInPlace(node, placed_footprint, stop_token);
+        const bool oom_killed = Basic::DockerExecutor::ReadOomKills(cgroup) > oom_kills;
+        if (!built && placement.Exhausted(oom_killed) && !stop_token.stop_requested()) {
+            placement.SpillToDisk();
+            built = BuildPackageInPlace(node, footprint, stop_token);
+        }
+        placement.Finish(built);
+        return built;
     }
 
 }  // namespace MainProcess
\ No newline at end of file
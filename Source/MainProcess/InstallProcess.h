@@ -1,8 +1,13 @@
 #ifndef MAINPROCESS_INSTALLPROCESS_H
 #define MAINPROCESS_INSTALLPROCESS_H
 
-#include <set>
+#include <stop_token>
 #include <string>
+#include <vector>
+
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/InstallationOrchestrator.h"
+#include "MainProcess/ResourceBudget.h"
 
 namespace MainProcess {
 
@@ -18,17 +23,28 @@ namespace MainProcess {
     bool InstallPackage(const std::string& packageSpec);
 
     /**
-     * @brief 递归地安装一个软件包及其依赖项 (内部实现)。
+     * @brief 在同一个安装会话中安装多个软件包 (公共入口)。
      *
-     * 接口与原始代码完全相同。
-     * 实现上，它现在从全局上下文中获取共享的 Docker 容器名，
-     * 而不是通过参数接收。
+     * 所有包被解析进同一张依赖图，共享的依赖只构建一次，会话容器也只启动一次。
      *
-     * @param packageSpec 要安装的包，格式为 "name@namespace@version"。
-     * @param processed_packages 一个集合，用于跟踪在此次安装会话中已处理的包。
-     * @return true 如果安装成功，否则返回 false。
+     * @param packageSpecs 要安装的包，格式为 "name@namespace@version"。
+     * @param options 会话选项，例如是否同时安装 gcpkg.toml 中声明的依赖。
+     * @return true 如果全部安装成功，否则返回 false。
+     */
+    bool InstallPackages(const std::vector<std::string>& packageSpecs, const InstallOptions& options);
+
+    /**
+     * @brief 构建依赖图中的单个软件包 (内部实现)。
+     *
+     * 由调度器在该包的所有依赖都完成后调用。它从全局上下文中获取共享的 Docker 容器名、
+     * gcpkg.toml 和构建历史，并把本次构建的耗时记录到历史中。
+     *
+     * @param node 已解析的包节点。
+     * @param footprint 调度器为该构建预留的资源；启用了独立 cgroup 时按其中的限制运行。
+     * @param stop_token 调度器取消会话时终止正在执行的命令。
+     * @return true 如果构建成功，否则返回 false。
      */
-    bool InstallPackage(const std::string& packageSpec, std::set<std::string>& processed_packages);
+    bool BuildPackage(const PackageNode& node, const ResourceFootprint& footprint, std::stop_token stop_token = {});
 
 }  // namespace MainProcess
 
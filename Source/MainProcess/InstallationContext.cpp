@@ -1,17 +1,19 @@
 #include "MainProcess/InstallationContext.h"
 
+#include <atomic>
+
 namespace MainProcess {
 
-    // 使用 thread_local 确保在多线程环境下（如果未来支持）每个线程有自己的上下文，
-    // 避免数据竞争。对于单线程应用，其行为与静态变量相同。
-    thread_local InstallationContext* g_current_context = nullptr;
+    // 上下文在会话开始时设置一次，之后由调度器的所有工作线程共享读取，
+    // 因此使用进程级的原子指针而不是 thread_local。
+    std::atomic<InstallationContext*> g_current_context = nullptr;
 
     InstallationContext* GetCurrentContext() {
-        return g_current_context;
+        return g_current_context.load();
     }
 
     void SetCurrentContext(InstallationContext* context) {
-        g_current_context = context;
+        g_current_context.store(context);
     }
 
 }  // namespace MainProcess
\ No newline at end of file
@@ -3,11 +3,28 @@
 
 #include <string>
 
+#include "Basic/DockerExecutor/ContainerStats.h"
+#include "MainProcess/BuildPlanner.h"
+#include "MainProcess/BuildSystemAnalysis.h"
+#include "toml++/toml.hpp"
+
 namespace MainProcess {
 
+    class BuildHistory;
+    class ResourceReport;
+    class TmpfsBuildTrees;
+
     // 保存单次安装会话期间共享状态的结构体
     struct InstallationContext {
         std::string containerName;
+        toml::table gcpkgToml;                                   // 会话开始时解析一次的 gcpkg.toml
+        BuildHistory* history = nullptr;                         // 构建耗时数据库
+        ResourceReport* resourceReport = nullptr;                // 每条构建命令的资源消耗
+        Basic::DockerExecutor::ContainerCgroup containerCgroup;  // 用于采样资源消耗
+        std::string cgroupEnterScript;                           // 非空时每个构建运行在独立的 cgroup 中
+        SharedSourceFetches sharedFetches;                       // 多个构建配置共享的下载、解压和源码锁
+        BuildSystemRegistry buildSystems;                        // 构建系统名称 -> 导出项，会话开始时构建一次
+        TmpfsBuildTrees* tmpfs = nullptr;                        // 非空时构建目录可以放在 tmpfs 上
     };
 
     /**
@@ -1,31 +1,57 @@
 #include "MainProcess/InstallationOrchestrator.h"
 
+#include <algorithm>
 #include <ctime>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
+#include "Basic/DockerExecutor/CgroupLimits.h"
+#include "Basic/DockerExecutor/ContainerStats.h"
 #include "Basic/DockerExecutor/RunContainer.h"
-#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
-#include "MainProcess/InstallProcess.h"  // 引用 InstallPackage(spec, processed_set)
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/ContentHash.h"
+#include "Basic/Utils/FileLock.h"
+#include "MainProcess/BuildHistory.h"
+#include "MainProcess/BuildScheduler.h"
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/GarbageCollector.h"
+#include "MainProcess/InstallProcess.h"  // 引用 BuildPackage(node)
 #include "MainProcess/InstallationContext.h"
+#include "MainProcess/Lockfile.h"
+#include "MainProcess/PortIndex.h"
+#include "MainProcess/ResourceBudget.h"
+#include "MainProcess/ResourceReport.h"
+#include "MainProcess/SessionJournal.h"
+#include "MainProcess/StepFingerprint.h"
+#include "MainProcess/TmpfsBuildTree.h"
 #include "toml++/toml.hpp"
 
 namespace fs = std::filesystem;
-namespace CommandExecutor = Basic::SystemIntegrate::CommandExecutor;
 
 namespace MainProcess {
 
+    // 会话结束时资源摘要中每个排名打印的命令数
+    static constexpr size_t kResourceSummaryTopN = 5;
+
     // RAII 守卫，用于管理 Docker 容器的生命周期
     struct DockerContainerGuard {
         std::string containerName;
+        bool keep = false;  // 保留容器供 install --resume 或之后的守护进程会话重新连接
         DockerContainerGuard(std::string name) : containerName(std::move(name)) {
         }
         ~DockerContainerGuard() {
+            if (keep) {
+                std::cout << "--- Keeping session container '" << containerName << "' ---" << std::endl;
+                return;
+            }
             std::cout << "--- Cleaning up session container '" << containerName << "' ---" << std::endl;
-            CommandExecutor::executeCommand("docker stop " + containerName);
-            CommandExecutor::executeCommand("docker rm " + containerName);
+            Basic::DockerExecutor::RemoveContainer(containerName);
         }
     };
 
@@ -39,25 +65,130 @@ namespace MainProcess {
         }
     };
 
-    bool PerformInstallation(const std::string& packageSpec) {
-        // 1. 加载 gcpkg.toml 以获取 Docker 镜像信息
-        toml::table gcpkg_toml;
-        try {
-            gcpkg_toml = toml::parse_file("gcpkg.toml");
-        } catch (const toml::parse_error& err) {
-            std::cerr << "错误: 解析 gcpkg.toml 文件失败: " << err << std::endl;
+    // 同时构建的包数量，来自 [global].parallel_builds，默认为 1
+    static unsigned GetParallelBuilds(const toml::table& gcpkg_toml) {
+        int64_t parallel_builds = gcpkg_toml["global"]["parallel_builds"].value_or(int64_t{1});
+        return static_cast<unsigned>(std::max<int64_t>(1, parallel_builds));
+    }
+
+    // 会话结束时写出指标，路径和格式来自 [global].metrics_file / metrics_format ("prometheus" 或 "openmetrics")
+    static void WriteSessionMetrics(const toml::table& gcpkg_toml) {
+        const std::string path = gcpkg_toml["global"]["metrics_file"].value_or("gcpkg/metrics/gcpkg.prom");
+        const std::string format = gcpkg_toml["global"]["metrics_format"].value_or("prometheus");
+        if (format != "prometheus" && format != "openmetrics") {
+            std::cerr << "警告: 未知的 metrics_format '" << format << "'，使用 prometheus。" << std::endl;
+        }
+        Basic::Metrics::WriteTextfile(
+            path, format == "openmetrics" ? Basic::Metrics::Format::OpenMetrics : Basic::Metrics::Format::Prometheus);
+    }
+
+    bool ReadManifestDependencies(const toml::table& gcpkg_toml, std::vector<std::string>& specs) {
+        auto deps_node = gcpkg_toml.get("dependencies");
+        if (!deps_node) return true;
+
+        if (auto deps_array = deps_node->as_array()) {
+            for (const auto& dep_node : *deps_array) {
+                auto dep_spec = dep_node.value<std::string>();
+                if (!dep_spec || dep_spec->empty()) {
+                    std::cerr << "错误: gcpkg.toml 的 dependencies 数组只能包含包描述符字符串。" << std::endl;
+                    return false;
+                }
+                specs.push_back(*dep_spec);
+            }
+            return true;
+        }
+
+        auto deps_table = deps_node->as_table();
+        if (!deps_table) {
+            std::cerr << "错误: gcpkg.toml 中的 dependencies 必须是数组或表。" << std::endl;
+            return false;
+        }
+        for (auto&& [key, value_node] : *deps_table) {
+            const std::string name(key.str());
+            std::string ns_and_version;
+            if (auto text = value_node.value<std::string>()) {
+                ns_and_version = *text;
+            } else if (auto entry = value_node.as_table()) {
+                std::string ns = (*entry)["namespace"].value_or("");
+                std::string version = (*entry)["version"].value_or("latest");
+                if (!ns.empty()) ns_and_version = ns + "@" + version;
+            }
+
+            PackageSpec parsed;
+            if (!ParsePackageSpec(name + "@" + ns_and_version, parsed)) {
+                std::cerr << "错误: gcpkg.toml 中依赖 '" << name << "' 的格式无效。应为 \"namespace@version\"。"
+                          << std::endl;
+                return false;
+            }
+            specs.push_back(name + "@" + ns_and_version);
+        }
+        return true;
+    }
+
+    // 合并命令行指定的包与清单中声明的包 (去重并保持顺序)
+    static bool CollectRequestedSpecs(const toml::table& gcpkg_toml,
+                                      const std::vector<std::string>& packageSpecs,
+                                      const InstallOptions& options,
+                                      std::vector<std::string>& requested) {
+        std::vector<std::string> all_specs = packageSpecs;
+        if (options.manifest && !ReadManifestDependencies(gcpkg_toml, all_specs)) {
             return false;
         }
 
-        // 2. 准备并启动唯一的 Docker 容器
+        std::set<std::string> seen;
+        for (const auto& spec : all_specs) {
+            if (seen.insert(spec).second) requested.push_back(spec);
+        }
+        if (requested.empty()) {
+            std::cerr << "错误: 没有要安装的包。请指定包描述符，或在 gcpkg.toml 的 [dependencies] 中声明依赖。"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    static void PrintCachedPackages(const DependencyGraph& graph) {
+        for (const auto& [spec, node] : graph.nodes) {
+            if (node.installed) {
+                std::cout << "--- Package '" << spec << "' found in cache. Skipping installation. ---" << std::endl;
+            }
+        }
+    }
+
+    // 锁文件仍然有效时直接由它重建依赖图，否则完整解析所有 port 文件
+    // 之后把每个待构建包的多个 build_configs 展开为独立的调度单元
+    static bool LoadOrResolveGraph(const toml::table& gcpkg_toml,
+                                   const std::vector<std::string>& requested,
+                                   const std::string& config_hash,
+                                   Lockfile& lock,
+                                   DependencyGraph& graph,
+                                   bool& from_lock) {
+        Basic::Trace::Span span("resolve", "resolve dependency graph");
+        from_lock = lock.Load() && ValidateLockfile(lock, requested, config_hash) && LoadGraphFromLockfile(lock, graph);
+        if (from_lock) {
+            std::cout << "--- Lockfile is up to date. Skipping dependency resolution. ---" << std::endl;
+        } else {
+            graph = DependencyGraph{};
+            if (!ResolveDependencyGraph(requested, graph)) return false;
+        }
+        ExpandBuildConfigs(graph, gcpkg_toml["global"]["build_type"].value_or(""));
+        span.Arg("from_lock", from_lock ? 1 : 0);
+        span.Arg("packages", static_cast<int64_t>(graph.nodes.size()));
+        return true;
+    }
+
+    // 启动本次会话使用的容器，资源限制选项必须位于镜像名之前
+    static bool StartSessionContainer(const toml::table& gcpkg_toml,
+                                      const HostBudget& budget,
+                                      const std::string& container_name,
+                                      const fs::path& gcpkg_root,
+                                      const TmpfsConfig& tmpfs) {
+        Basic::Trace::Span span("container", "start " + container_name);
         std::string image = "gcc:latest";
         if (auto docker_table = gcpkg_toml["docker"].as_table()) {
             image = docker_table->get("build_mirror")->value_or("gcc:latest");
         }
 
-        std::string container_name = "gcpkg-session-" + std::to_string(std::time(nullptr));
-        fs::path gcpkg_root = fs::absolute(fs::current_path());
-
         std::vector<std::string> docker_opts = {"-itd",
                                                 "--name",
                                                 container_name,
@@ -73,33 +204,345 @@ namespace MainProcess {
                                                 "sleep",
                                                 "infinity"};
 
+        std::vector<std::string> limit_opts;
+        if (budget.explicit_memory) {
+            limit_opts.insert(limit_opts.end(), {"--memory", std::to_string(budget.memory_bytes)});
+        }
+        if (budget.explicit_cpus) {
+            limit_opts.insert(limit_opts.end(), {"--cpus", std::to_string(budget.cpus)});
+        }
+        if (budget.per_build_cgroup) {
+            limit_opts.insert(limit_opts.end(), {"--cgroupns=private", "--cap-add=SYS_ADMIN"});
+        }
+        docker_opts.insert(docker_opts.end() - 3, limit_opts.begin(), limit_opts.end());
+        const std::vector<std::string> mount_opts = TmpfsMountOptions(tmpfs);
+        docker_opts.insert(docker_opts.end() - 3, mount_opts.begin(), mount_opts.end());
+
         std::cout << "--- Starting installation session container '" << container_name << "' ---" << std::endl;
-        CommandExecutor::executeCommand("docker rm -f " + container_name);
+        Basic::DockerExecutor::RemoveContainer(container_name);
         if (!Basic::DockerExecutor::RunContainer(docker_opts)) {
             std::cerr << "错误: 启动 Docker 容器失败。" << std::endl;
             return false;
         }
+        return true;
+    }
+
+    bool PerformInstallation(const std::vector<std::string>& packageSpecs, const InstallOptions& options) {
+        // 1. 加载 gcpkg.toml 以获取 Docker 镜像信息和清单
+        toml::table gcpkg_toml;
+        try {
+            gcpkg_toml = toml::parse_file("gcpkg.toml");
+        } catch (const toml::parse_error& err) {
+            std::cerr << "错误: 解析 gcpkg.toml 文件失败: " << err << std::endl;
+            return false;
+        }
+
+        // 2. 把所有请求的包一次性解析进同一张依赖图；恢复会话时沿用上一次会话请求的包
+        SessionJournal session;
+        std::vector<std::string> requested;
+        bool update_lock = options.update_lock;
+        if (options.resume) {
+            if (!session.Load()) {
+                std::cerr << "错误: 没有可以恢复的安装会话。" << std::endl;
+                return false;
+            }
+            std::cout << "--- Resuming installation session " << session.session_id << " ---" << std::endl;
+            requested = session.requested;
+            update_lock = session.update_lock;
+            for (const auto& spec : packageSpecs) {
+                if (std::find(requested.begin(), requested.end(), spec) == requested.end()) requested.push_back(spec);
+            }
+        } else if (!CollectRequestedSpecs(gcpkg_toml, packageSpecs, options, requested)) {
+            return false;
+        }
+        const std::string config_hash = Basic::Utils::HashFile("gcpkg.toml");
+        Lockfile lock;
+        DependencyGraph graph;
+        bool from_lock = false;
+        if (!LoadOrResolveGraph(gcpkg_toml, requested, config_hash, lock, graph, from_lock)) {
+            return false;
+        }
+        PrintCachedPackages(graph);
+        RecordAccess(GraphAccessEntries(graph));
+
+        if (TopologicalOrder(graph).empty()) {
+            if (!from_lock && update_lock) {
+                BuildLockfile(graph, requested, config_hash, gcpkg_toml, &lock).Save();
+            }
+            if (options.resume) session.Finish();
+            std::cout << "--- All packages are already installed. Nothing to do. ---" << std::endl;
+            return true;
+        }
+
+        BuildHistory history;
+        history.Load();
+
+        // 3. 准备唯一的 Docker 容器：指定了常驻容器时重新连接它；恢复会话时优先重新连接仍在运行的旧容器
+        fs::path gcpkg_root = fs::absolute(fs::current_path());
+        HostBudget budget = LoadHostBudget(gcpkg_toml);
+        TmpfsConfig tmpfs_config = LoadTmpfsConfig(gcpkg_toml, gcpkg_root, budget);
+        const bool persistent = !options.container_name.empty();
+        const std::string session_name = "gcpkg-session-" + std::to_string(std::time(nullptr));
+        bool reattach = false;
+        std::string container_name = session_name;
+        if (persistent) {
+            reattach = Basic::DockerExecutor::IsContainerRunning(options.container_name);
+            container_name = options.container_name;
+        } else if (options.resume && !session.container_name.empty() &&
+                   Basic::DockerExecutor::IsContainerRunning(session.container_name)) {
+            reattach = true;
+            container_name = session.container_name;
+        }
+
+        if (reattach) {
+            std::cout << "--- Reattaching to session container '" << container_name << "' ---" << std::endl;
+        } else if (!StartSessionContainer(gcpkg_toml, budget, container_name, gcpkg_root, tmpfs_config)) {
+            return false;
+        }
+        if (reattach && !tmpfs_config.root.empty() && !IsTmpfsMounted(container_name, tmpfs_config)) {
+            std::cerr << "警告: 容器 '" << container_name << "' 启动时没有挂载 " << tmpfs_config.root
+                      << "，本次会话的构建目录仍放在磁盘上。" << std::endl;
+            tmpfs_config.root.clear();
+        }
+        std::optional<TmpfsBuildTrees> tmpfs;
+        if (!tmpfs_config.root.empty()) tmpfs.emplace(tmpfs_config);
+        // 容器已按完整的内存预算启动，之后的准入和每个构建的内存限制只使用扣除 tmpfs 容量后的部分
+        ChargeTmpfsToBudget(tmpfs_config, budget);
 
         // 使用 RAII 守卫确保容器最终被清理
         DockerContainerGuard containerGuard(container_name);
+        containerGuard.keep = persistent;
+
+        // 会话日志先于任何构建落盘，这样即使进程被 Ctrl-C 终止也能恢复
+        if (!options.resume) session.session_id = session_name;
+        session.container_name = container_name;
+        session.requested = requested;
+        session.update_lock = update_lock;
+        for (const auto& [spec, node] : graph.nodes) {
+            session.packages[spec].state = node.installed ? SessionPackageState::Done : SessionPackageState::Pending;
+        }
+        session.Save();
+        // session.toml 可能被之后的会话覆盖，会话进行期间由会话记录保护依赖图中的包不被任何 gc 回收
+        LiveSession live_session(session.session_id, GraphPackageKeys(graph));
 
-        // 3. 创建并设置上下文
+        // 自动回收在后台与构建并行进行，本次会话依赖图中的包都不会被回收
+        std::optional<BackgroundGc> background_gc;
+        if (const GcBudget gc_budget = LoadGcBudget(gcpkg_toml); gc_budget.automatic) {
+            background_gc.emplace(GcOptions{gc_budget, GraphPackageKeys(graph)});
+        }
+
+        // 4. 创建并设置上下文
+        ResourceReport resource_report;
         InstallationContext context;
         context.containerName = container_name;
+        context.gcpkgToml = gcpkg_toml;
+        context.history = &history;
+        context.resourceReport = &resource_report;
+        context.buildSystems = BuildSystemRegistryForGraph(graph);
+        context.tmpfs = tmpfs ? &*tmpfs : nullptr;
+        context.containerCgroup = Basic::DockerExecutor::ResolveContainerCgroup(container_name);
+        if (budget.per_build_cgroup) {
+            context.cgroupEnterScript =
+                Basic::DockerExecutor::EnableCgroupDelegation(container_name, (gcpkg_root / "gcpkg/session").string());
+        }
         ContextGuard contextGuard(&context);  // RAII 守卫确保上下文被清理
 
-        // 4. 开始递归安装
-        std::set<std::string> processed_packages;
-        // 调用原始的、未改变接口的内部安装函数
-        bool success = InstallPackage(packageSpec, processed_packages);
+        // 5. 按关键路径优先的顺序调度构建
+        auto build = [&session](const PackageNode& node, const ResourceFootprint& footprint, std::stop_token stop) {
+            session.SetPackageState(node.spec, SessionPackageState::Building);
+            bool built = BuildPackage(node, footprint, stop);
+            if (built) {
+                BuildStepJournal journal(BuildTreeDir(node.id, node.config_name));
+                journal.Load();
+                session.SetPackageDownloads(node.spec, journal.Downloads());
+            }
+            session.SetPackageState(node.spec, built ? SessionPackageState::Done : SessionPackageState::Failed);
+            Basic::Metrics::GetCounter("gcpkg_packages_built_total",
+                                       "Packages built in install sessions by result.",
+                                       built ? "result=\"success\"" : "result=\"failure\"")
+                .Add();
+            return built;
+        };
+        bool success = RunBuildSchedule(graph, history, GetParallelBuilds(gcpkg_toml), budget, build);
+
+        // 失败的会话中已完成的包同样有参考价值，因此总是保存历史和资源报告
+        history.Save();
+        resource_report.Save(session.session_id);
+        resource_report.PrintSummary(kResourceSummaryTopN);
+        WriteSessionMetrics(gcpkg_toml);
 
         if (success) {
+            // 成功后步骤日志中已有下载文件的摘要，重新生成锁文件
+            if (update_lock) {
+                BuildLockfile(graph, requested, config_hash, gcpkg_toml, &lock).Save();
+            }
+            session.Finish();
             std::cout << "--- Installation session completed successfully! ---" << std::endl;
         } else {
-            std::cerr << "--- Installation session failed. Cleaning up. ---" << std::endl;
+            containerGuard.keep = persistent || options.keep_container;
+            std::cerr << "--- Installation session failed. Run 'gcpkg install --resume' to continue. ---"
+                      << std::endl;
         }
 
         return success;
     }
 
+    bool ShowInstallationPlan(const std::vector<std::string>& packageSpecs,
+                              const InstallOptions& options,
+                              bool estimate) {
+        toml::table gcpkg_toml;
+        try {
+            gcpkg_toml = toml::parse_file("gcpkg.toml");
+        } catch (const toml::parse_error& err) {
+            std::cerr << "错误: 解析 gcpkg.toml 文件失败: " << err << std::endl;
+            return false;
+        }
+
+        std::vector<std::string> requested;
+        if (!CollectRequestedSpecs(gcpkg_toml, packageSpecs, options, requested)) {
+            return false;
+        }
+        Lockfile lock;
+        DependencyGraph graph;
+        bool from_lock = false;
+        const std::string config_hash = Basic::Utils::HashFile("gcpkg.toml");
+        if (!LoadOrResolveGraph(gcpkg_toml, requested, config_hash, lock, graph, from_lock)) {
+            return false;
+        }
+
+        BuildHistory history;
+        history.Load();
+
+        const unsigned parallel_builds = GetParallelBuilds(gcpkg_toml);
+        HostBudget budget = LoadHostBudget(gcpkg_toml);
+        ChargeTmpfsToBudget(LoadTmpfsConfig(gcpkg_toml, fs::absolute(fs::current_path()), budget), budget);
+        ScheduleEstimate schedule = EstimateSchedule(graph, history, parallel_builds, budget);
+
+        std::cout << "--- Installation plan for " << requested.size() << " requested package(s) ("
+                  << schedule.entries.size()
+                  << " package(s) to build, parallel_builds = " << parallel_builds << ") ---" << std::endl;
+        PrintCachedPackages(graph);
+
+        for (const auto& entry : schedule.entries) {
+            if (!estimate) {
+                std::cout << "  " << entry.spec << std::endl;
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(48) << entry.spec << std::right << std::fixed
+                      << std::setprecision(1) << " start +" << std::setw(8) << entry.start_seconds << "s  duration "
+                      << std::setw(8) << entry.duration_seconds << "s"
+                      << (entry.from_history ? "" : "  (no history, default)") << std::endl;
+        }
+
+        if (estimate) {
+            std::cout << "--- Estimated total session time: " << std::fixed << std::setprecision(1)
+                      << schedule.total_seconds << "s ---" << std::endl;
+        }
+        return true;
+    }
+
+    bool CheckInstallation(const std::vector<std::string>& packageSpecs,
+                           const InstallOptions& options,
+                           bool& satisfied) {
+        toml::table gcpkg_toml;
+        try {
+            gcpkg_toml = toml::parse_file("gcpkg.toml");
+        } catch (const toml::parse_error& err) {
+            std::cerr << "错误: 解析 gcpkg.toml 文件失败: " << err << std::endl;
+            return false;
+        }
+
+        std::vector<std::string> requested;
+        DependencyGraph graph;
+        if (!CollectRequestedSpecs(gcpkg_toml, packageSpecs, options, requested) ||
+            !ResolveDependencyGraph(requested, graph)) {
+            return false;
+        }
+        ExpandBuildConfigs(graph, gcpkg_toml["global"]["build_type"].value_or(""));
+        satisfied = TopologicalOrder(graph).empty();
+        return true;
+    }
+
+    static std::vector<AffectedPackage> LoadAffectedPackages(const std::vector<std::string>& changed,
+                                                             bool include_port_changes) {
+        PortIndex index;
+        index.Load();
+        index.Refresh();
+        index.Save();
+        return ComputeAffectedPackages(index, changed, include_port_changes);
+    }
+
+    bool ShowOutdatedPackages() {
+        std::vector<AffectedPackage> affected = LoadAffectedPackages({}, true);
+        if (affected.empty()) {
+            std::cout << "--- All installed packages are up to date. ---" << std::endl;
+            return true;
+        }
+
+        std::cout << "--- " << affected.size() << " installed package(s) need rebuilding ---" << std::endl;
+        for (const auto& package : affected) {
+            std::cout << "  " << package.spec << "  (" << package.reason << ")" << std::endl;
+        }
+        return true;
+    }
+
+    // 返回 parent 下某个版本所有构建配置的目录 (<version> 和 <version>@<config>)
+    static std::vector<fs::path> ListConfigDirs(const fs::path& parent, const std::string& version) {
+        std::vector<fs::path> dirs;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(parent, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name == version || name.rfind(version + "@", 0) == 0) dirs.push_back(entry.path());
+        }
+        return dirs;
+    }
+
+    bool RebuildAffectedPackages(const std::vector<std::string>& packageSpecs, bool include_port_changes,
+                                 InstallOptions options) {
+        std::vector<AffectedPackage> affected = LoadAffectedPackages(packageSpecs, include_port_changes);
+        if (affected.empty()) {
+            std::cout << "--- Nothing to rebuild. ---" << std::endl;
+            return true;
+        }
+
+        std::vector<std::string> specs;
+        for (const auto& package : affected) {
+            std::cout << "--- Rebuilding " << package.spec << " (" << package.reason << ") ---" << std::endl;
+            PackageSpec id;
+            if (!ParsePackageSpec(package.spec, id)) continue;
+
+            // 移除所有构建配置的安装目录和步骤日志，使依赖图把它视为未安装并从头构建。
+            // 失效包的上游指纹本来就会变化，因此删除日志不会多执行任何步骤。
+            // 其他 gcpkg 进程正在构建的配置要等它结束后再删除。
+            std::set<std::string> configs;
+            for (const auto& parent : {fs::path("gcpkg/buildtrees"), fs::path("gcpkg/packages")}) {
+                for (const auto& config_dir : ListConfigDirs(parent / id.name, id.version)) {
+                    const std::string dir_name = config_dir.filename().string();
+                    configs.insert(dir_name == id.version ? "" : dir_name.substr(id.version.size() + 1));
+                }
+            }
+            std::vector<std::unique_ptr<Basic::Utils::FileLock>> config_locks;
+            for (const auto& config : configs) {
+                config_locks.push_back(
+                    std::make_unique<Basic::Utils::FileLock>(PackageLockFile(id, config), "package " + package.spec));
+            }
+
+            std::error_code ec;
+            for (const auto& config_dir : ListConfigDirs(fs::path("gcpkg/buildtrees") / id.name, id.version)) {
+                fs::remove(config_dir / BuildStepJournal::kFileName, ec);
+            }
+            for (const auto& config_dir : ListConfigDirs(fs::path("gcpkg/packages") / id.name, id.version)) {
+                fs::remove_all(config_dir, ec);
+                if (ec) {
+                    std::cerr << "错误: 无法移除 " << package.spec << " 的安装目录: " << ec.message() << std::endl;
+                    return false;
+                }
+            }
+            specs.push_back(package.spec);
+        }
+
+        options.update_lock = false;
+        return PerformInstallation(specs, options);
+    }
+
 }  // namespace MainProcess
\ No newline at end of file
@@ -2,22 +2,106 @@
 #define MAINPROCESS_INSTALLATIONORCHESTRATOR_H
 
 #include <string>
+#include <vector>
+
+#include "toml++/toml.hpp"
 
 namespace MainProcess {
 
+    // 安装会话的选项
+    struct InstallOptions {
+        bool manifest = false;        // 同时安装 gcpkg.toml 中 [dependencies] 声明的所有包
+        bool update_lock = true;      // 成功后写入 gcpkg.lock；只重建部分包时不应覆盖项目的锁文件
+        bool resume = false;          // 恢复 gcpkg/session/session.toml 记录的上一次未完成的会话
+        bool keep_container = false;  // 会话失败时保留容器，供 --resume 重新连接
+        std::string container_name;   // 非空时使用并始终保留该名称的会话容器 (守护进程的常驻容器)
+    };
+
+    /**
+     * @brief 读取项目 gcpkg.toml 中声明的依赖。
+     *
+     * 支持两种写法：
+     *   dependencies = ["zlib@default@1.3.1", ...]
+     * 或
+     *   [dependencies]
+     *   zlib = "default@1.3.1"      # namespace@version
+     *   fmt = { namespace = "default", version = "11.0" }
+     *
+     * @param gcpkg_toml 项目配置。
+     * @param specs 追加解析出的包描述符。
+     * @return 如果所有条目格式都有效则返回 true。
+     */
+    bool ReadManifestDependencies(const toml::table& gcpkg_toml, std::vector<std::string>& specs);
+
     /**
      * @brief 执行完整的软件包安装流程，包括所有依赖。
      *
-     * 这是安装过程的顶层入口。它会负责：
-     * 1. 启动一个用于整个安装会话的共享 Docker 容器。
-     * 2. 创建并注册一个全局的 InstallationContext。
-     * 3. 调用递归安装流程。
-     * 4. 确保在流程结束后（无论成功与否）清理容器和上下文。
+     * 这是安装过程的顶层入口。所有请求的包 (以及清单模式下 gcpkg.toml 中声明的包)
+     * 被解析进同一张依赖图，在同一个会话中完成，共享的依赖只构建一次。它会负责：
+     * 1. 一次性解析完整的依赖图，并加载构建历史。
+     * 2. 启动一个用于整个安装会话的共享 Docker 容器。
+     * 3. 创建并注册一个全局的 InstallationContext。
+     * 4. 按关键路径优先的顺序调度所有待构建的包。
+     * 5. 确保在流程结束后（无论成功与否）清理容器和上下文，并保存构建历史。
      *
-     * @param packageSpec 要安装的软件包，格式为 "name@namespace@version"。
+     * 会话进度记录在 gcpkg/session/session.toml 中；失败或中断后可以用 options.resume 继续，
+     * 已完成的包和步骤不会重新执行。
+     *
+     * @param packageSpecs 要安装的软件包，格式为 "name@namespace@version"。
+     * @param options 会话选项。
      * @return true 如果安装成功，否则返回 false。
      */
-    bool PerformInstallation(const std::string& packageSpec);
+    bool PerformInstallation(const std::vector<std::string>& packageSpecs, const InstallOptions& options = {});
+
+    /**
+     * @brief 打印安装计划而不执行任何构建。
+     *
+     * 列出按调度顺序需要构建的包。estimate 为 true 时，根据构建历史
+     * 预测每个包的开始时间和整个会话的总耗时。
+     *
+     * @param packageSpecs 要安装的软件包，格式为 "name@namespace@version"。
+     * @param options 会话选项，与 PerformInstallation 相同。
+     * @param estimate 是否输出耗时预测。
+     * @return true 如果依赖图解析成功。
+     */
+    bool ShowInstallationPlan(const std::vector<std::string>& packageSpecs,
+                              const InstallOptions& options,
+                              bool estimate);
+
+    /**
+     * @brief 解析请求的包的依赖图，检查它们 (包括依赖和所有构建配置) 是否都已安装，不执行任何构建。
+     *
+     * @param packageSpecs 要检查的软件包，格式为 "name@namespace@version"。
+     * @param options 会话选项，只使用 manifest。
+     * @param satisfied 输出：没有需要构建的包时为 true。
+     * @return true 如果依赖图解析成功。
+     */
+    bool CheckInstallation(const std::vector<std::string>& packageSpecs,
+                           const InstallOptions& options,
+                           bool& satisfied);
+
+    /**
+     * @brief 列出因 port 变化而需要重新构建的已安装包。
+     *
+     * 刷新 port 索引，比较每个已安装包构建时的 port 摘要，并沿反向依赖传播。
+     *
+     * @return true 如果索引刷新成功。
+     */
+    bool ShowOutdatedPackages();
+
+    /**
+     * @brief 只重新构建失效的包。
+     *
+     * 失效集合是 packageSpecs 及其已安装的依赖者；include_port_changes 为 true 时再加上 ShowOutdatedPackages
+     * 列出的包。集合中的包会被移除安装目录，然后在一个会话中按拓扑顺序重新构建。
+     *
+     * @param packageSpecs 额外视为已变化的包。
+     * @param include_port_changes 是否包含所有 port 已变化的包 (rebuild --affected)。
+     * @param options 重建会话的选项；update_lock 总是被置为 false。
+     * @return true 如果没有需要重建的包或全部重建成功。
+     */
+    bool RebuildAffectedPackages(const std::vector<std::string>& packageSpecs, bool include_port_changes,
+                                 InstallOptions options = {});
 
 }  // namespace MainProcess
 
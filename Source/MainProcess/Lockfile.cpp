@@ -0,0 +1,284 @@
+#include "MainProcess/Lockfile.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "Basic/Utils/ContentHash.h"
+#include "MainProcess/PortCache.h"
+#include "MainProcess/StepFingerprint.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    static bool StatPort(const fs::path& port_path, int64_t& mtime, int64_t& size) {
+        std::error_code ec;
+        auto write_time = fs::last_write_time(port_path, ec);
+        if (ec) return false;
+        auto file_size = fs::file_size(port_path, ec);
+        if (ec) return false;
+        mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(write_time.time_since_epoch()).count();
+        size = static_cast<int64_t>(file_size);
+        return true;
+    }
+
+    // 影响二进制兼容性的全局构建设置
+    static std::string BuildSettingsKey(const toml::table& gcpkg_toml) {
+        std::ostringstream settings;
+        settings << "image=" << gcpkg_toml["docker"]["build_mirror"].value_or("gcc:latest") << "\n"
+                 << "build_type=" << gcpkg_toml["global"]["build_type"].value_or("") << "\n"
+                 << "platform=" << gcpkg_toml["global"]["platform"].value_or("") << "\n";
+        return settings.str();
+    }
+
+    fs::path Lockfile::DefaultPath() {
+        return fs::path("gcpkg.lock");
+    }
+
+    bool Lockfile::Load(const fs::path& path) {
+        requested.clear();
+        packages.clear();
+        config_hash.clear();
+
+        if (!fs::exists(path)) return false;
+
+        toml::table lock_toml;
+        try {
+            lock_toml = toml::parse_file(path.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 锁文件 " << path << " 已损坏，将重新解析依赖: " << err << std::endl;
+            return false;
+        }
+
+        if (lock_toml["version"].value_or(int64_t{0}) != kFormatVersion) {
+            return false;
+        }
+        config_hash = lock_toml["config_hash"].value_or("");
+        if (auto requested_array = lock_toml["requested"].as_array()) {
+            for (const auto& node : *requested_array) {
+                requested.push_back(node.value_or(""));
+            }
+        }
+
+        auto packages_table = lock_toml["packages"].as_table();
+        if (!packages_table) return true;
+
+        for (auto&& [spec, package_node] : *packages_table) {
+            auto package_table = package_node.as_table();
+            if (!package_table) continue;
+
+            LockedPackage package;
+            package.port_path = (*package_table)["port_path"].value_or("");
+            package.port_hash = (*package_table)["port_hash"].value_or("");
+            package.port_mtime = (*package_table)["port_mtime"].value_or(int64_t{0});
+            package.port_size = (*package_table)["port_size"].value_or(int64_t{0});
+            package.abi = (*package_table)["abi"].value_or("");
+            if (auto deps = (*package_table)["dependencies"].as_array()) {
+                for (const auto& dep : *deps) {
+                    package.dependencies.push_back(dep.value_or(""));
+                }
+            }
+            if (auto sources = (*package_table)["sources"].as_table()) {
+                for (auto&& [file, hash] : *sources) {
+                    package.sources[std::string(file.str())] = hash.value_or("");
+                }
+            }
+            packages[std::string(spec.str())] = std::move(package);
+        }
+        return true;
+    }
+
+    bool Lockfile::Save(const fs::path& path) const {
+        toml::table packages_table;
+        for (const auto& [spec, package] : packages) {
+            toml::array deps;
+            for (const auto& dep : package.dependencies) deps.push_back(dep);
+            toml::table sources;
+            for (const auto& [file, hash] : package.sources) sources.insert_or_assign(file, hash);
+
+            toml::table package_table{{"port_path", package.port_path},
+                                      {"port_hash", package.port_hash},
+                                      {"port_mtime", package.port_mtime},
+                                      {"port_size", package.port_size},
+                                      {"abi", package.abi}};
+            package_table.insert_or_assign("dependencies", std::move(deps));
+            package_table.insert_or_assign("sources", std::move(sources));
+            packages_table.insert_or_assign(spec, std::move(package_table));
+        }
+
+        toml::array requested_array;
+        for (const auto& spec : requested) requested_array.push_back(spec);
+
+        toml::table lock_toml{{"version", kFormatVersion}, {"config_hash", config_hash}};
+        lock_toml.insert_or_assign("requested", std::move(requested_array));
+        lock_toml.insert_or_assign("packages", std::move(packages_table));
+
+        fs::path temp_path = path;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入锁文件 " << temp_path << std::endl;
+                return false;
+            }
+            file << "# 由 gcpkg 自动生成，请勿手动修改。\n" << lock_toml;
+        }
+        std::error_code ec;
+        fs::rename(temp_path, path, ec);
+        return !ec;
+    }
+
+    Lockfile BuildLockfile(const DependencyGraph& graph,
+                           const std::vector<std::string>& requested,
+                           const std::string& config_hash,
+                           const toml::table& gcpkg_toml,
+                           const Lockfile* previous) {
+        Lockfile lock;
+        lock.requested = requested;
+        lock.config_hash = config_hash;
+        const std::string settings_key = BuildSettingsKey(gcpkg_toml);
+
+        // 依赖在前的顺序计算 ABI，使每个包的 ABI 包含其依赖的 ABI
+        std::set<std::string> visiting;
+        std::function<const std::string&(const std::string&)> abi_of;
+        abi_of = [&](const std::string& spec) -> const std::string& {
+            LockedPackage& package = lock.packages[spec];
+            if (!package.abi.empty() || !visiting.insert(spec).second) return package.abi;
+
+            // 已安装的包在解析时不读取 port 文件，依赖图中既没有它们的依赖边，也没有它们的依赖；
+            // 锁文件需要完整的依赖，否则这些包被删除后按锁文件重建的依赖图会缺少依赖
+            PackageSpec id;
+            fs::path port_path;
+            std::string port_hash;
+            bool resolved = false;
+            if (auto it = graph.nodes.find(spec); it != graph.nodes.end()) {
+                id = it->second.id;
+                port_path = it->second.port_path;
+                port_hash = it->second.port_hash;
+                package.dependencies = it->second.dependencies;
+                resolved = !it->second.installed;
+            } else {
+                ParsePackageSpec(spec, id);
+                port_path = fs::path("gcpkg/port") / id.ns / id.name / id.version / "port.toml";
+            }
+            if (!resolved) {
+                // port 已被删除时依赖未知；之后需要构建该包时按锁文件重建依赖图会失败并回退到重新解析
+                std::string error;
+                if (auto port = LoadPortFile(port_path, "lockfile", error)) {
+                    package.dependencies = CollectPortDependencies(port->port_toml);
+                    port_hash = port->hash;
+                }
+            }
+            if (StatPort(port_path, package.port_mtime, package.port_size)) {
+                package.port_path = port_path.string();
+                package.port_hash = port_hash.empty() ? Basic::Utils::HashFile(port_path) : port_hash;
+            }
+
+            std::ostringstream material;
+            material << "port=" << package.port_hash << "\n" << settings_key;
+            for (const auto& dep : package.dependencies) {
+                material << "dep=" << dep << ":" << abi_of(dep) << "\n";
+            }
+
+            BuildStepJournal journal(BuildTreeDir(id));
+            journal.Load();
+            package.sources = journal.Downloads();
+            if (package.sources.empty() && previous) {
+                auto it = previous->packages.find(spec);
+                if (it != previous->packages.end() && it->second.port_hash == package.port_hash) {
+                    package.sources = it->second.sources;
+                }
+            }
+            for (const auto& [file, hash] : package.sources) {
+                material << "source=" << hash << "\n";
+            }
+
+            // 递归过程中 map 可能插入新元素，但 std::map 的引用保持有效
+            package.abi = Basic::Utils::HashString(material.str());
+            return package.abi;
+        };
+
+        for (const auto& [spec, node] : graph.nodes) {
+            // 额外的构建配置由 port 派生，重建依赖图时会重新展开
+            if (node.config_name.empty()) abi_of(spec);
+        }
+        return lock;
+    }
+
+    bool ValidateLockfile(const Lockfile& lock,
+                          const std::vector<std::string>& requested,
+                          const std::string& config_hash) {
+        if (lock.config_hash != config_hash || lock.requested != requested || lock.packages.empty()) {
+            return false;
+        }
+
+        for (const auto& [spec, package] : lock.packages) {
+            if (package.port_path.empty()) continue;  // 已安装但 port 已移除的包
+
+            int64_t mtime = 0;
+            int64_t size = 0;
+            if (!StatPort(package.port_path, mtime, size)) {
+                return false;  // port 文件被删除
+            }
+            if (mtime == package.port_mtime && size == package.port_size) {
+                continue;
+            }
+            // 元数据变化 (例如 git checkout 刷新了 mtime)：以内容摘要为准
+            if (Basic::Utils::HashFile(package.port_path) != package.port_hash) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool LoadGraphFromLockfile(const Lockfile& lock, DependencyGraph& graph) {
+        graph = DependencyGraph{};
+
+        std::function<bool(const std::string&)> visit = [&](const std::string& spec) -> bool {
+            if (graph.nodes.count(spec)) return true;
+
+            auto it = lock.packages.find(spec);
+            if (it == lock.packages.end()) return false;
+            const LockedPackage& package = it->second;
+
+            PackageNode node;
+            node.spec = spec;
+            if (!ParsePackageSpec(spec, node.id)) return false;
+            node.port_path = package.port_path;
+            node.port_hash = package.port_hash;
+
+            node.installed = IsPackageInstalled(node.id);
+
+            if (!node.installed) {
+                // 只有需要构建的包才解析 port 文件
+                std::string error;
+                auto port = LoadPortFile(node.port_path, "lockfile", error);
+                if (!port) {
+                    std::cerr << "错误: " << error << std::endl;
+                    return false;
+                }
+                node.port_toml = port->port_toml;
+                node.dependencies = package.dependencies;
+                for (const auto& dep : node.dependencies) {
+                    if (!visit(dep)) return false;
+                }
+            }
+
+            graph.nodes[spec] = std::move(node);
+            return true;
+        };
+
+        for (const auto& root : lock.requested) {
+            if (!visit(root)) return false;
+            graph.roots.push_back(root);
+        }
+        return true;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef MAINPROCESS_LOCKFILE_H
+#define MAINPROCESS_LOCKFILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MainProcess/DependencyGraph.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // 锁文件中的单个包
+    struct LockedPackage {
+        std::string port_path;
+        std::string port_hash;
+        int64_t port_mtime = 0;  // 用于廉价校验：mtime 与大小都未变时无需重新计算摘要
+        int64_t port_size = 0;
+        std::vector<std::string> dependencies;
+        std::string abi;                             // 由 port 摘要、依赖的 ABI 和构建设置派生
+        std::map<std::string, std::string> sources;  // 下载的源码文件 -> 内容摘要
+    };
+
+    /**
+     * @brief gcpkg.lock：一次安装会话完整解析出的依赖图。
+     *
+     * 只要 gcpkg.toml、请求的包以及每个 port.toml 都没有变化，之后的安装就可以直接从锁文件
+     * 重建依赖图，跳过逐个解析 port 文件的依赖发现过程。
+     */
+    struct Lockfile {
+        // 2：已安装的包同样记录完整的依赖，旧版本的锁文件缺少这些依赖边，不再有效
+        static constexpr int64_t kFormatVersion = 2;
+
+        std::vector<std::string> requested;
+        std::string config_hash;  // gcpkg.toml 的内容摘要
+        std::map<std::string, LockedPackage> packages;
+
+        static std::filesystem::path DefaultPath();
+
+        bool Load(const std::filesystem::path& path = DefaultPath());
+        bool Save(const std::filesystem::path& path = DefaultPath()) const;
+    };
+
+    /**
+     * @brief 由已解析的依赖图生成锁文件。
+     *
+     * 源码摘要取自各包构建目录中的步骤日志；尚未构建过的包沿用 previous 中相同 port 摘要的记录。
+     */
+    Lockfile BuildLockfile(const DependencyGraph& graph,
+                           const std::vector<std::string>& requested,
+                           const std::string& config_hash,
+                           const toml::table& gcpkg_toml,
+                           const Lockfile* previous = nullptr);
+
+    /**
+     * @brief 廉价地校验锁文件是否仍然有效。
+     *
+     * 比较 gcpkg.toml 摘要和请求的包；对每个 port 文件做一次 stat，只有 mtime 或大小变化时
+     * 才重新计算内容摘要。
+     *
+     * @return true 如果锁文件可以直接使用。
+     */
+    bool ValidateLockfile(const Lockfile& lock,
+                          const std::vector<std::string>& requested,
+                          const std::string& config_hash);
+
+    /**
+     * @brief 根据锁文件重建依赖图，跳过依赖发现。
+     *
+     * 只有需要构建的包才会解析其 port.toml。与 ResolveDependencyGraph 一致，已安装的包作为叶子节点。
+     */
+    bool LoadGraphFromLockfile(const Lockfile& lock, DependencyGraph& graph);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_LOCKFILE_H
\ No newline at end of file
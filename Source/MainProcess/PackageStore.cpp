@@ -0,0 +1,287 @@
+#include "MainProcess/PackageStore.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include "Basic/FileHash/FileHash.h"
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/FileClone.h"
+#include "Basic/Utils/FileLock.h"
+#include "MainProcess/StepFingerprint.h"
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    // 同一目录下的临时文件名，用于原子替换
+    static fs::path TempPathFor(const fs::path& path) {
+        static std::atomic<uint64_t> counter{0};
+        fs::path temp = path;
+        temp += ".gcpkg-store-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+        return temp;
+    }
+
+    // 依次尝试 reflink 和硬链接，在 dst 处创建指向 src 的链接 (原子替换 dst)
+    static bool LinkFile(const fs::path& src, const fs::path& dst) {
+        const fs::path temp = TempPathFor(dst);
+        std::error_code ec;
+        if (!Basic::Utils::ReflinkFile(src, temp)) {
+            fs::create_hard_link(src, temp, ec);
+            if (ec) return false;
+        }
+        fs::rename(temp, dst, ec);
+        if (ec) {
+            fs::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // 复制 src 到 dst (原子替换 dst)
+    static bool CopyFile(const fs::path& src, const fs::path& dst) {
+        const fs::path temp = TempPathFor(dst);
+        std::error_code ec;
+        fs::copy_file(src, temp, ec);
+        if (!ec) fs::rename(temp, dst, ec);
+        if (ec) {
+            fs::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    static bool SameContent(const fs::path& a, const fs::path& b) {
+        std::ifstream file_a(a, std::ios::binary), file_b(b, std::ios::binary);
+        if (!file_a || !file_b) return false;
+        char buffer_a[65536], buffer_b[65536];
+        while (true) {
+            file_a.read(buffer_a, sizeof(buffer_a));
+            file_b.read(buffer_b, sizeof(buffer_b));
+            if (file_a.gcount() != file_b.gcount()) return false;
+            if (file_a.gcount() == 0) return true;
+            if (!std::equal(buffer_a, buffer_a + file_a.gcount(), buffer_b)) return false;
+        }
+    }
+
+    fs::path PackageStore::DefaultRoot() {
+        return fs::path("gcpkg/store");
+    }
+
+    fs::path PackageStore::ManifestPath(const fs::path& build_dir) {
+        return build_dir / ".gcpkg_store_manifest.toml";
+    }
+
+    fs::path PackageStore::LockFile() {
+        return fs::path("gcpkg/locks/store.lock");
+    }
+
+    bool PackageStore::ManifestObjects(const fs::path& manifest_path, std::vector<std::string>& objects) {
+        std::error_code ec;
+        if (!fs::exists(manifest_path, ec)) return false;
+        toml::table manifest;
+        try {
+            manifest = toml::parse_file(manifest_path.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 存储清单 " << manifest_path << " 已损坏: " << err << std::endl;
+            return false;
+        }
+        if (auto files = manifest["files"].as_table()) {
+            for (auto&& [path, object_node] : *files) objects.push_back(object_node.value_or(""));
+        }
+        return true;
+    }
+
+    PackageStore::PackageStore(fs::path root) : root_(std::move(root)) {}
+
+    bool PackageStore::Ingest(const fs::path& tree, const fs::path& manifest_path, StoreIngestStats* stats) const {
+        Basic::Trace::Span span("store", "ingest " + tree.string());
+        Basic::Utils::SharedFileLock store_lock(LockFile(), Basic::Utils::SharedFileLock::Mode::Shared,
+                                                "the package store (gc in progress)");
+        StoreIngestStats local_stats;
+        toml::table files, symlinks;
+        toml::array dirs;
+
+        // 先并行计算整棵树的摘要，未变化的文件直接使用缓存
+        std::unordered_map<std::string, std::string> hashes;
+        for (auto& file : Basic::FileHash::HashTree(tree, &FileHashCache())) {
+            hashes[file.relative_path.generic_string()] = std::move(file.hash);
+        }
+
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(tree, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            const fs::path relative = it->path().lexically_relative(tree);
+            std::error_code entry_ec;
+            if (it->is_symlink(entry_ec)) {
+                symlinks.insert_or_assign(relative.generic_string(), fs::read_symlink(it->path(), entry_ec).string());
+                continue;
+            }
+            if (it->is_directory(entry_ec)) {
+                dirs.push_back(relative.generic_string());
+                continue;
+            }
+            // 清单必须覆盖整棵树，否则按清单恢复时会丢失文件；无法记录的条目使整个 Ingest 失败
+            if (!it->is_regular_file(entry_ec)) {
+                std::cerr << "警告: 安装目录中的 " << it->path() << " 不是普通文件，无法放入存储。" << std::endl;
+                return false;
+            }
+
+            const uintmax_t size = it->file_size(entry_ec);
+            auto hash_it = hashes.find(relative.generic_string());
+            if (entry_ec || hash_it == hashes.end()) {
+                std::cerr << "警告: 无法计算 " << it->path() << " 的摘要，不写入存储清单。" << std::endl;
+                return false;
+            }
+            const std::string& hash = hash_it->second;
+            const bool executable = (it->status().permissions() & fs::perms::owner_exec) != fs::perms::none;
+            // 硬链接共享权限位，可执行与否不同的文件不能共用一个对象
+            const std::string object = hash.substr(0, 2) + "/" + hash + "-" + std::to_string(size) +
+                                       (executable ? "x" : "");
+            const fs::path object_path = root_ / "objects" / object;
+            ++local_stats.files;
+
+            if (!fs::exists(object_path, entry_ec)) {
+                // 新对象：从安装树链接到存储，安装树中的文件保持不变；无法链接时 (例如跨文件系统) 复制一份
+                fs::create_directories(object_path.parent_path(), entry_ec);
+                if (!LinkFile(it->path(), object_path) && !CopyFile(it->path(), object_path)) {
+                    std::cerr << "警告: 无法把 " << it->path() << " 放入存储，不写入存储清单。" << std::endl;
+                    return false;
+                }
+            } else {
+                struct stat object_stat {}, file_stat {};
+                if (stat(object_path.c_str(), &object_stat) == 0 && stat(it->path().c_str(), &file_stat) == 0 &&
+                    object_stat.st_ino == file_stat.st_ino && object_stat.st_dev == file_stat.st_dev) {
+                    // 已经是该对象的硬链接
+                } else if (!SameContent(it->path(), object_path)) {
+                    std::cerr << "警告: " << it->path() << " 与存储中摘要相同的对象内容不同，不写入存储清单。"
+                              << std::endl;
+                    return false;
+                } else if (LinkFile(object_path, it->path())) {
+                    ++local_stats.shared;
+                    local_stats.saved_bytes += size;
+                }
+                // 内容相同但无法链接时安装树保留自己的副本，清单仍然记录该对象
+            }
+            files.insert_or_assign(relative.generic_string(), object);
+        }
+        if (ec) {
+            std::cerr << "警告: 遍历安装目录 " << tree << " 失败: " << ec.message() << std::endl;
+            return false;
+        }
+
+        toml::table manifest{{"version", 1}};
+        manifest.insert_or_assign("dirs", std::move(dirs));
+        manifest.insert_or_assign("files", std::move(files));
+        manifest.insert_or_assign("symlinks", std::move(symlinks));
+
+        fs::path temp_path = TempPathFor(manifest_path);
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入存储清单 " << temp_path << std::endl;
+                return false;
+            }
+            file << manifest;
+        }
+        fs::rename(temp_path, manifest_path, ec);
+        if (ec) return false;
+
+        std::cout << "--- Store: " << local_stats.files << " file(s) in " << tree << ", " << local_stats.shared
+                  << " shared, " << local_stats.saved_bytes / (1024 * 1024) << " MiB saved ---" << std::endl;
+        span.Arg("files", static_cast<int64_t>(local_stats.files));
+        span.Arg("saved_bytes", static_cast<int64_t>(local_stats.saved_bytes));
+        Basic::Metrics::CacheLookups("store", true).Add(local_stats.shared);
+        Basic::Metrics::CacheLookups("store", false).Add(local_stats.files - local_stats.shared);
+        Basic::Metrics::GetCounter("gcpkg_store_saved_bytes_total", "Bytes saved by sharing identical installed files.")
+            .Add(local_stats.saved_bytes);
+        if (stats) *stats = local_stats;
+        return true;
+    }
+
+    bool PackageStore::Restore(const fs::path& manifest_path, const fs::path& tree) const {
+        Basic::Trace::Span span("store", "restore " + tree.string());
+        toml::table manifest;
+        try {
+            manifest = toml::parse_file(manifest_path.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 存储清单 " << manifest_path << " 已损坏: " << err << std::endl;
+            return false;
+        }
+
+        std::error_code ec;
+        if (fs::exists(tree, ec) && !fs::is_empty(tree, ec)) {
+            std::cerr << "警告: 恢复目标 " << tree << " 不为空。" << std::endl;
+            return false;
+        }
+        fs::create_directories(tree, ec);
+
+        // 先确认所有对象都在，避免恢复出不完整的安装树
+        auto files = manifest["files"].as_table();
+        if (files) {
+            for (auto&& [path, object_node] : *files) {
+                if (!fs::exists(root_ / "objects" / object_node.value_or(""), ec)) {
+                    std::cerr << "警告: 存储中缺少对象 " << object_node.value_or("") << "，无法恢复 " << tree
+                              << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        if (auto dirs = manifest["dirs"].as_array()) {
+            for (const auto& dir : *dirs) fs::create_directories(tree / dir.value_or(""), ec);
+        }
+        if (files) {
+            for (auto&& [path, object_node] : *files) {
+                const fs::path target = tree / std::string(path.str());
+                fs::create_directories(target.parent_path(), ec);
+                if (!LinkFile(root_ / "objects" / object_node.value_or(""), target)) {
+                    // 无法链接时 (例如跨文件系统) 退回普通复制
+                    fs::copy_file(root_ / "objects" / object_node.value_or(""), target, ec);
+                    if (ec) {
+                        std::cerr << "警告: 无法恢复文件 " << target << ": " << ec.message() << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+        if (auto symlinks = manifest["symlinks"].as_table()) {
+            for (auto&& [path, target_node] : *symlinks) {
+                const fs::path link = tree / std::string(path.str());
+                fs::create_directories(link.parent_path(), ec);
+                fs::create_symlink(target_node.value_or(""), link, ec);
+            }
+        }
+
+        std::cout << "--- Store: restored " << tree << " from " << manifest_path << " ---" << std::endl;
+        return true;
+    }
+
+    bool BreakSharedLinks(const fs::path& tree) {
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(tree, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            std::error_code entry_ec;
+            if (it->is_symlink(entry_ec) || !it->is_regular_file(entry_ec)) continue;
+            if (it->hard_link_count(entry_ec) <= 1 || entry_ec) continue;
+
+            const fs::path temp = TempPathFor(it->path());
+            fs::copy_file(it->path(), temp, entry_ec);
+            if (!entry_ec) fs::rename(temp, it->path(), entry_ec);
+            if (entry_ec) {
+                fs::remove(temp, ec);
+                std::cerr << "警告: 无法解除 " << it->path() << " 与存储的共享: " << entry_ec.message() << std::endl;
+                return false;
+            }
+        }
+        return !ec;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
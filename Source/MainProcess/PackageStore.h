@@ -0,0 +1,65 @@
+#ifndef MAINPROCESS_PACKAGESTORE_H
+#define MAINPROCESS_PACKAGESTORE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace MainProcess {
+
+    // Ingest 的统计
+    struct StoreIngestStats {
+        size_t files = 0;          // 处理的普通文件
+        size_t shared = 0;         // 与存储中已有对象共享的文件
+        uint64_t saved_bytes = 0;  // 共享所节省的空间
+    };
+
+    /**
+     * @brief 按内容寻址的文件存储 (gcpkg/store)。
+     *
+     * 对象保存在 objects/<前两位>/<摘要>-<大小>[x] 下 (x 表示可执行)，安装树中的普通文件通过
+     * reflink 或硬链接指向对象，因此不同版本、不同构建配置中字节相同的头文件和数据文件只占用一份空间。
+     * 每个安装树的清单记录文件到对象的映射，按清单恢复安装树时只创建链接，不复制数据。
+     *
+     * 硬链接与对象共享 inode，原地改写会同时改写对象；重新执行构建步骤之前必须先调用 BreakSharedLinks。
+     * 对象的存活由清单决定：gc 持有存储锁的独占锁，回收没有被任何清单引用的对象。
+     */
+    class PackageStore {
+      public:
+        static std::filesystem::path DefaultRoot();
+        // 安装树的清单保存在对应构建目录中，与步骤日志放在一起
+        static std::filesystem::path ManifestPath(const std::filesystem::path& build_dir);
+        // 存储锁：Ingest 期间持有共享锁，gc 回收对象期间持有独占锁
+        static std::filesystem::path LockFile();
+        // 读取清单引用的对象 (相对于 objects/ 的路径)；清单不存在或已损坏时返回 false
+        static bool ManifestObjects(const std::filesystem::path& manifest_path, std::vector<std::string>& objects);
+
+        explicit PackageStore(std::filesystem::path root = DefaultRoot());
+
+        /**
+         * @brief 把安装树中的普通文件放入存储并替换为指向对象的链接，然后写入清单。
+         *
+         * 摘要相同的文件在链接之前还会逐字节比较；无法链接的文件 (例如跨文件系统) 复制到存储中。
+         * 清单总是覆盖整棵树：有文件无法放入存储时返回 false，不写入清单。
+         * 新对象在清单写出之前没有被任何清单引用，因此整个过程持有存储锁的共享锁。
+         */
+        bool Ingest(const std::filesystem::path& tree,
+                    const std::filesystem::path& manifest_path,
+                    StoreIngestStats* stats = nullptr) const;
+
+        // 按清单重建安装树；tree 必须不存在或为空
+        bool Restore(const std::filesystem::path& manifest_path, const std::filesystem::path& tree) const;
+
+      private:
+        std::filesystem::path root_;
+    };
+
+    /**
+     * @brief 把树中链接数大于 1 的普通文件替换为独立的副本，使之后的原地改写不会影响存储中的对象。
+     */
+    bool BreakSharedLinks(const std::filesystem::path& tree);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_PACKAGESTORE_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "MainProcess/PortCache.h"
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "Basic/Metrics/Metrics.h"
+#include "Basic/Trace/Trace.h"
+#include "Basic/Utils/ContentHash.h"
+#include "MainProcess/DependencyGraph.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    static std::mutex g_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const ParsedPort>> g_ports;  // 绝对路径 -> 解析结果
+
+    std::shared_ptr<const ParsedPort> LoadPortFile(const fs::path& path, const std::string& site, std::string& error) {
+        std::ifstream port_file(path, std::ios::binary);
+        if (!port_file.is_open()) {
+            error = "找不到 port 文件 " + path.string();
+            return nullptr;
+        }
+        std::stringstream content;
+        content << port_file.rdbuf();
+        const std::string port_content = content.str();
+        const std::string hash = Basic::Utils::HashString(port_content);
+
+        std::error_code ec;
+        const std::string key = fs::absolute(path, ec).lexically_normal().string();
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            auto it = g_ports.find(key);
+            if (it != g_ports.end() && it->second->hash == hash) {
+                Basic::Metrics::CacheLookups("port", true).Add();
+                return it->second;
+            }
+        }
+        Basic::Metrics::CacheLookups("port", false).Add();
+
+        // 解析在锁外进行；并发解析同一个文件时后写入的结果覆盖先写入的，两者内容相同
+        auto port = std::make_shared<ParsedPort>();
+        try {
+            Basic::Trace::Span span("toml", path.string());
+            port->port_toml = toml::parse(port_content);
+        } catch (const toml::parse_error& err) {
+            std::ostringstream message;
+            message << "解析 " << path << " 失败: " << err;
+            error = message.str();
+            return nullptr;
+        }
+        port->hash = hash;
+        PortParses(site).Add();
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_ports[key] = port;
+        return port;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
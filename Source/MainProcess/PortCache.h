@@ -0,0 +1,36 @@
+#ifndef MAINPROCESS_PORTCACHE_H
+#define MAINPROCESS_PORTCACHE_H
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // 解析后的 port.toml
+    struct ParsedPort {
+        toml::table port_toml;
+        std::string hash;  // 文件内容的摘要 (Basic::Utils::HashString)
+    };
+
+    /**
+     * @brief 读取并解析 port.toml，解析结果按路径缓存在进程内。
+     *
+     * 每次调用都会读取文件并计算摘要，内容未变化时直接返回缓存的结果而不重新解析。
+     * 同一会话中依赖图解析、inject 和导出的构建系统读取同一个 port 只解析一次；
+     * 守护进程中缓存跨会话保留。线程安全。
+     *
+     * @param path port.toml 的路径。
+     * @param site 调用位置，解析时计入 gcpkg_port_parses_total{site=...}。
+     * @param error 失败时的错误描述。
+     * @return 解析结果；文件无法读取或解析失败时返回 nullptr。
+     */
+    std::shared_ptr<const ParsedPort> LoadPortFile(const std::filesystem::path& path,
+                                                   const std::string& site,
+                                                   std::string& error);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_PORTCACHE_H
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "MainProcess/PortIndex.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include "Basic/Utils/ContentHash.h"
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/StepFingerprint.h"
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    static void ReadStringArray(const toml::node* node, std::vector<std::string>& out) {
+        if (!node) return;
+        if (auto array = node->as_array()) {
+            for (const auto& item : *array) {
+                out.push_back(item.value_or(""));
+            }
+        }
+    }
+
+    static bool ParsePortEntry(const fs::path& port_path, PortIndexEntry& entry) {
+        std::ifstream port_file(port_path, std::ios::binary);
+        if (!port_file.is_open()) return false;
+        std::stringstream content;
+        content << port_file.rdbuf();
+
+        toml::table port_toml;
+        try {
+            port_toml = toml::parse(content.str());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 解析 " << port_path << " 失败，已从索引中跳过: " << err << std::endl;
+            return false;
+        }
+
+        entry.port_hash = Basic::Utils::HashString(content.str());
+        entry.dependencies = CollectPortDependencies(port_toml);
+        entry.build_systems.clear();
+        entry.exports.clear();
+
+        if (auto build_configs = port_toml["build_configs"].as_array()) {
+            for (const auto& config_node : *build_configs) {
+                auto config_table = config_node.as_table();
+                if (!config_table) continue;
+
+                std::string build_system = (*config_table)["build_system"].value_or("");
+                if (!build_system.empty()) entry.build_systems.push_back(build_system);
+
+                if (auto systems = (*config_table)["export_build_system"].as_array()) {
+                    for (const auto& system_node : *systems) {
+                        if (auto system_table = system_node.as_table()) {
+                            entry.exports.push_back((*system_table)["name"].value_or(""));
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    fs::path PortIndex::DefaultPath() {
+        return fs::path("gcpkg/index/port_index.toml");
+    }
+
+    void PortIndex::Load(const fs::path& path) {
+        entries.clear();
+        if (!fs::exists(path)) return;
+
+        toml::table index_toml;
+        try {
+            index_toml = toml::parse_file(path.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: port 索引 " << path << " 已损坏，将重新建立: " << err << std::endl;
+            return;
+        }
+
+        auto ports_table = index_toml["ports"].as_table();
+        if (!ports_table) return;
+
+        for (auto&& [spec, port_node] : *ports_table) {
+            auto port_table = port_node.as_table();
+            if (!port_table) continue;
+
+            PortIndexEntry entry;
+            entry.port_path = (*port_table)["port_path"].value_or("");
+            entry.port_hash = (*port_table)["port_hash"].value_or("");
+            entry.port_mtime = (*port_table)["port_mtime"].value_or(int64_t{0});
+            entry.port_size = (*port_table)["port_size"].value_or(int64_t{0});
+            ReadStringArray(port_table->get("dependencies"), entry.dependencies);
+            ReadStringArray(port_table->get("build_systems"), entry.build_systems);
+            ReadStringArray(port_table->get("exports"), entry.exports);
+            entries[std::string(spec.str())] = std::move(entry);
+        }
+    }
+
+    bool PortIndex::Save(const fs::path& path) const {
+        auto to_array = [](const std::vector<std::string>& values) {
+            toml::array array;
+            for (const auto& value : values) array.push_back(value);
+            return array;
+        };
+
+        toml::table ports_table;
+        for (const auto& [spec, entry] : entries) {
+            toml::table port_table{{"port_path", entry.port_path},
+                                   {"port_hash", entry.port_hash},
+                                   {"port_mtime", entry.port_mtime},
+                                   {"port_size", entry.port_size}};
+            port_table.insert_or_assign("dependencies", to_array(entry.dependencies));
+            port_table.insert_or_assign("build_systems", to_array(entry.build_systems));
+            port_table.insert_or_assign("exports", to_array(entry.exports));
+            ports_table.insert_or_assign(spec, std::move(port_table));
+        }
+
+        toml::table index_toml;
+        index_toml.insert_or_assign("ports", std::move(ports_table));
+
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        fs::path temp_path = path;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入 port 索引 " << temp_path << std::endl;
+                return false;
+            }
+            file << index_toml;
+        }
+        fs::rename(temp_path, path, ec);
+        return !ec;
+    }
+
+    std::string PortSpecFromPath(const fs::path& port_path) {
+        // 目录结构为 port/<namespace>/<name>/<version>/port.toml
+        const fs::path version_dir = port_path.parent_path();
+        const fs::path name_dir = version_dir.parent_path();
+        const fs::path ns_dir = name_dir.parent_path();
+        if (port_path.filename() != "port.toml" || ns_dir.parent_path().filename() != "port") return "";
+        return name_dir.filename().string() + "@" + ns_dir.filename().string() + "@" + version_dir.filename().string();
+    }
+
+    // 文件未变化 (mtime 和大小一致) 时沿用已有条目，否则重新解析；port 不可读时返回 false
+    static bool RefreshEntry(const fs::path& port_path, const PortIndexEntry* existing, PortIndexEntry& entry,
+                             bool& reparsed) {
+        std::error_code stat_ec;
+        auto write_time = fs::last_write_time(port_path, stat_ec);
+        auto file_size = fs::file_size(port_path, stat_ec);
+        if (stat_ec) return false;
+        const int64_t mtime =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(write_time.time_since_epoch()).count();
+        const int64_t size = static_cast<int64_t>(file_size);
+
+        reparsed = false;
+        if (existing && existing->port_mtime == mtime && existing->port_size == size) {
+            entry = *existing;
+            return true;
+        }
+
+        if (!ParsePortEntry(port_path, entry)) return false;
+        entry.port_path = port_path.string();
+        entry.port_mtime = mtime;
+        entry.port_size = size;
+        reparsed = true;
+        return true;
+    }
+
+    void PortIndex::Refresh() {
+        const fs::path port_root = "gcpkg/port";
+        std::map<std::string, PortIndexEntry> refreshed;
+        size_t reparsed = 0;
+
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(port_root, ec);
+             !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            if (it.depth() != 3 || it->path().filename() != "port.toml") continue;
+
+            const std::string spec = PortSpecFromPath(it->path());
+            if (spec.empty()) continue;
+            auto existing = entries.find(spec);
+            PortIndexEntry entry;
+            bool entry_reparsed = false;
+            if (!RefreshEntry(it->path(), existing != entries.end() ? &existing->second : nullptr, entry,
+                              entry_reparsed)) {
+                continue;
+            }
+            refreshed[spec] = std::move(entry);
+            if (entry_reparsed) ++reparsed;
+        }
+
+        std::cout << "--- Port index: " << refreshed.size() << " port(s), " << reparsed << " re-parsed ---"
+                  << std::endl;
+        entries = std::move(refreshed);
+    }
+
+    void PortIndex::RefreshPorts(const std::vector<fs::path>& port_paths) {
+        size_t reparsed = 0, removed = 0;
+        for (const auto& port_path : port_paths) {
+            const std::string spec = PortSpecFromPath(port_path);
+            if (spec.empty()) continue;
+
+            PortIndexEntry entry;
+            bool entry_reparsed = false;
+            // 路径本身已知发生了变化，不沿用旧条目
+            if (!RefreshEntry(port_path, nullptr, entry, entry_reparsed)) {
+                removed += entries.erase(spec);
+                continue;
+            }
+            entries[spec] = std::move(entry);
+            ++reparsed;
+        }
+
+        std::cout << "--- Port index: " << reparsed << " port(s) updated, " << removed << " removed ---"
+                  << std::endl;
+    }
+
+    std::map<std::string, std::set<std::string>> PortIndex::ReverseDependencies() const {
+        std::map<std::string, std::vector<std::string>> exporters;  // 构建系统 -> 导出它的包
+        for (const auto& [spec, entry] : entries) {
+            for (const auto& name : entry.exports) exporters[name].push_back(spec);
+        }
+
+        std::map<std::string, std::set<std::string>> reverse;
+        for (const auto& [spec, entry] : entries) {
+            for (const auto& dep : entry.dependencies) reverse[dep].insert(spec);
+            for (const auto& build_system : entry.build_systems) {
+                auto it = exporters.find(build_system);
+                if (it == exporters.end()) continue;
+                for (const auto& exporter : it->second) {
+                    if (exporter != spec) reverse[exporter].insert(spec);
+                }
+            }
+        }
+        return reverse;
+    }
+
+    // 包的任一构建配置 (<version> 或 <version>@<config> 目录) 已安装且构建完整时返回 true；
+    // built_port_hashes 收集各已安装配置构建时记录的 port 摘要 (早期构建没有此记录)
+    static bool IsInstalled(const std::string& spec, std::vector<std::string>& built_port_hashes) {
+        PackageSpec id;
+        if (!ParsePackageSpec(spec, id)) return false;
+
+        bool installed = false;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(PackageInstallDir(id).parent_path(), ec)) {
+            const std::string dir_name = entry.path().filename().string();
+            std::string config_name;
+            if (dir_name.rfind(id.version + "@", 0) == 0) {
+                config_name = dir_name.substr(id.version.size() + 1);
+            } else if (dir_name != id.version) {
+                continue;
+            }
+            if (!IsPackageInstalled(id, config_name)) continue;
+            installed = true;
+
+            const fs::path build_dir = BuildTreeDir(id, config_name);
+            if (!fs::exists(build_dir / BuildStepJournal::kFileName)) continue;
+            BuildStepJournal journal(build_dir);
+            journal.Load();
+            if (!journal.port_hash.empty()) built_port_hashes.push_back(journal.port_hash);
+        }
+        return installed;
+    }
+
+    std::vector<AffectedPackage> ComputeAffectedPackages(const PortIndex& index,
+                                                         const std::vector<std::string>& changed,
+                                                         bool include_port_changes) {
+        std::map<std::string, std::vector<std::string>> installed;  // spec -> 各配置构建时的 port 摘要
+        for (const auto& [spec, entry] : index.entries) {
+            std::vector<std::string> built_port_hashes;
+            if (IsInstalled(spec, built_port_hashes)) installed[spec] = std::move(built_port_hashes);
+        }
+
+        // 1. 直接失效的包
+        std::map<std::string, std::string> reasons;
+        for (const auto& [spec, built_port_hashes] : installed) {
+            const std::string& port_hash = index.entries.at(spec).port_hash;
+            for (const auto& built_port_hash : built_port_hashes) {
+                if (include_port_changes && built_port_hash != port_hash) reasons[spec] = "port changed";
+            }
+        }
+        for (const auto& spec : changed) {
+            if (installed.count(spec)) reasons.emplace(spec, "requested");
+        }
+
+        // 2. 沿反向依赖传播到所有已安装的依赖者
+        const auto reverse = index.ReverseDependencies();
+        std::vector<std::string> worklist;
+        for (const auto& [spec, reason] : reasons) worklist.push_back(spec);
+        while (!worklist.empty()) {
+            std::string spec = worklist.back();
+            worklist.pop_back();
+            auto it = reverse.find(spec);
+            if (it == reverse.end()) continue;
+            for (const auto& dependent : it->second) {
+                if (installed.count(dependent) && reasons.emplace(dependent, "depends on " + spec).second) {
+                    worklist.push_back(dependent);
+                }
+            }
+        }
+
+        // 3. 在失效集合内按依赖在前的顺序排列
+        std::vector<AffectedPackage> ordered;
+        std::set<std::string> visited;
+        std::function<void(const std::string&)> visit = [&](const std::string& spec) {
+            if (!visited.insert(spec).second) return;
+            for (const auto& dep : index.entries.at(spec).dependencies) {
+                if (reasons.count(dep)) visit(dep);
+            }
+            ordered.push_back({spec, reasons.at(spec)});
+        };
+        for (const auto& [spec, reason] : reasons) visit(spec);
+        return ordered;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef MAINPROCESS_PORTINDEX_H
+#define MAINPROCESS_PORTINDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace MainProcess {
+
+    // 索引中的单个 port
+    struct PortIndexEntry {
+        std::string port_path;
+        std::string port_hash;
+        int64_t port_mtime = 0;
+        int64_t port_size = 0;
+        std::vector<std::string> dependencies;   // 所有 build_configs 的依赖 (inject 规则也来自依赖)
+        std::vector<std::string> build_systems;  // 使用的 build_system
+        std::vector<std::string> exports;        // 通过 export_build_system 导出的构建系统
+    };
+
+    /**
+     * @brief gcpkg/port 下所有 port 的依赖索引 (gcpkg/index/port_index.toml)。
+     *
+     * Refresh 只重新解析 mtime 或大小发生变化的 port 文件，其余条目直接沿用。
+     */
+    class PortIndex {
+      public:
+        static std::filesystem::path DefaultPath();
+
+        void Load(const std::filesystem::path& path = DefaultPath());
+        bool Save(const std::filesystem::path& path = DefaultPath()) const;
+
+        // 扫描 gcpkg/port，更新变化的条目并删除已不存在的 port
+        void Refresh();
+
+        // 只重新解析给定的 port 文件；文件已不存在或无法解析时删除对应条目
+        void RefreshPorts(const std::vector<std::filesystem::path>& port_paths);
+
+        /**
+         * @brief 构建反向依赖：spec -> 直接依赖于它的包。
+         *
+         * 除 dependencies 外，使用某个 build_system 的包也依赖于导出该构建系统的包。
+         */
+        std::map<std::string, std::set<std::string>> ReverseDependencies() const;
+
+        std::map<std::string, PortIndexEntry> entries;
+    };
+
+    // 由 gcpkg/port/<namespace>/<name>/<version>/port.toml 得到 name@namespace@version，路径不符合时返回空字符串
+    std::string PortSpecFromPath(const std::filesystem::path& port_path);
+
+    // 一个已安装但需要重新构建的包
+    struct AffectedPackage {
+        std::string spec;
+        std::string reason;  // 例如 "port changed" 或 "depends on zlib@default@1.3"
+    };
+
+    /**
+     * @brief 计算需要重新构建的最小集合。
+     *
+     * 直接失效的包是 changed 中显式指定的包；include_port_changes 为 true 时再加上构建时记录的
+     * port 摘要与当前 port 不一致的已安装包。然后沿反向依赖把所有已安装的依赖者加入集合。
+     *
+     * @param index 已刷新的 port 索引。
+     * @param changed 额外视为已变化的包。
+     * @param include_port_changes 是否把 port 已变化的包视为直接失效。
+     * @return 按拓扑顺序 (依赖在前) 排列的失效包。
+     */
+    std::vector<AffectedPackage> ComputeAffectedPackages(const PortIndex& index,
+                                                         const std::vector<std::string>& changed,
+                                                         bool include_port_changes = true);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_PORTINDEX_H
\ No newline at end of file
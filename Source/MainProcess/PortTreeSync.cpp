@@ -0,0 +1,129 @@
+#include "MainProcess/PortTreeSync.h"
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+#include "MainProcess/PortIndex.h"
+
+namespace fs = std::filesystem;
+namespace CommandExecutor = Basic::SystemIntegrate::CommandExecutor;
+
+namespace MainProcess {
+
+    // init 把配置仓库克隆到这里
+    static const fs::path kConfigRepo = "gcpkg";
+
+    static bool Git(const std::string& args) {
+        return CommandExecutor::executeCommand("git -C " + CommandExecutor::shellQuote(kConfigRepo.string()) + " " +
+                                               args);
+    }
+
+    // 执行 git 命令并返回去掉末尾换行的标准输出
+    static bool GitOutput(const std::string& args, std::string& output) {
+        if (!CommandExecutor::executeCommandWithOutput(
+                "git -C " + CommandExecutor::shellQuote(kConfigRepo.string()) + " " + args + " 2>/dev/null", output)) {
+            return false;
+        }
+        while (!output.empty() && (output.back() == '\n' || output.back() == '\r')) output.pop_back();
+        return true;
+    }
+
+    bool UpdatePortTree(const UpdateOptions& options) {
+        if (!fs::exists(kConfigRepo / ".git")) {
+            std::cerr << "错误: " << kConfigRepo << " 不是 git 仓库，请先运行 'gcpkg init'。" << std::endl;
+            return false;
+        }
+
+        std::string old_commit, branch;
+        if (!GitOutput("rev-parse --verify -q HEAD", old_commit) || old_commit.empty()) {
+            std::cerr << "错误: 无法读取配置仓库的当前提交。" << std::endl;
+            return false;
+        }
+        GitOutput("symbolic-ref -q --short HEAD", branch);
+
+        // 1. 稀疏检出：只保留用到的命名空间 (cone 模式同时保留仓库根目录下的文件)
+        std::string pathspec = " -- port/";
+        if (!options.namespaces.empty()) {
+            std::string dirs, specs;
+            for (const auto& ns : options.namespaces) {
+                dirs += " " + CommandExecutor::shellQuote("port/" + ns);
+                specs += " " + CommandExecutor::shellQuote("port/" + ns + "/");
+            }
+            if (!Git("sparse-checkout set" + dirs)) {
+                std::cerr << "错误: 无法设置配置仓库的稀疏检出。" << std::endl;
+                return false;
+            }
+            pathspec = " --" + specs;
+        }
+        std::string sparse;
+        GitOutput("config --bool core.sparseCheckout", sparse);
+
+        // 2. 增量获取；--depth 会把完整克隆变成浅克隆，因此只对已经是浅克隆的仓库使用
+        std::string shallow;
+        GitOutput("rev-parse --is-shallow-repository", shallow);
+        std::string args = "fetch --no-tags";
+        if (shallow == "true") {
+            args += options.depth > 0 ? " --depth=" + std::to_string(options.depth) : std::string(" --unshallow");
+        }
+        if (sparse == "true") args += " --filter=blob:none";
+        args += " origin " + CommandExecutor::shellQuote(branch.empty() ? "HEAD" : branch);
+        if (!Git(args)) {
+            std::cerr << "错误: 获取配置仓库的更新失败。" << std::endl;
+            return false;
+        }
+
+        std::string new_commit;
+        if (!GitOutput("rev-parse --verify -q FETCH_HEAD^{commit}", new_commit) || new_commit.empty()) {
+            std::cerr << "错误: 无法解析获取到的提交。" << std::endl;
+            return false;
+        }
+
+        // 3. 计算变化的 port 文件；浅获取后旧提交仍在本地，差异只需要树对象
+        std::vector<fs::path> changed_ports;
+        if (new_commit != old_commit) {
+            std::string diff;
+            if (!GitOutput("diff --name-only --no-renames " + old_commit + " " + new_commit + pathspec, diff)) {
+                std::cerr << "错误: 无法比较配置仓库的新旧提交。" << std::endl;
+                return false;
+            }
+            std::istringstream lines(diff);
+            std::string line;
+            while (std::getline(lines, line)) {
+                fs::path port_path = kConfigRepo / line;
+                if (!PortSpecFromPath(port_path).empty()) changed_ports.push_back(port_path);
+            }
+
+            if (!Git("reset -q --keep " + new_commit)) {
+                std::cerr << "错误: 配置仓库中的本地修改与更新冲突，请先提交或撤销这些修改。" << std::endl;
+                return false;
+            }
+            std::cout << "--- Port tree updated " << old_commit.substr(0, 12) << ".." << new_commit.substr(0, 12)
+                      << ": " << changed_ports.size() << " port file(s) changed ---" << std::endl;
+        } else {
+            std::cout << "--- Port tree is up to date (" << new_commit.substr(0, 12) << ") ---" << std::endl;
+        }
+
+        // 4. 更新索引；稀疏范围变化或索引尚未建立时完整扫描
+        PortIndex index;
+        index.Load();
+        if (index.entries.empty() || !options.namespaces.empty()) {
+            index.Refresh();
+        } else if (!changed_ports.empty()) {
+            index.RefreshPorts(changed_ports);
+        }
+        if (!index.Save()) return false;
+
+        std::vector<AffectedPackage> affected = ComputeAffectedPackages(index, {});
+        if (!affected.empty()) {
+            std::cout << "--- " << affected.size() << " installed package(s) need rebuilding; run 'gcpkg rebuild "
+                      << "--affected' ---" << std::endl;
+            for (const auto& package : affected) {
+                std::cout << "  " << package.spec << "  (" << package.reason << ")" << std::endl;
+            }
+        }
+        return true;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
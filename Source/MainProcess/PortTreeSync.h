@@ -0,0 +1,28 @@
+#ifndef MAINPROCESS_PORTTREESYNC_H
+#define MAINPROCESS_PORTTREESYNC_H
+
+#include <string>
+#include <vector>
+
+namespace MainProcess {
+
+    struct UpdateOptions {
+        int depth = 1;                        // 浅克隆的配置仓库每次获取的深度；0 表示补全完整历史
+        std::vector<std::string> namespaces;  // 不为空时把配置仓库稀疏检出到这些命名空间的 port 目录
+    };
+
+    /**
+     * @brief 增量更新 gcpkg 配置仓库并同步 port 索引。
+     *
+     * 从 origin 获取当前分支 (分离 HEAD 时为远端 HEAD)，用 `git reset --keep` 移动工作区，
+     * 保留本地修改；与更新冲突时中止。完整克隆总是获取完整历史，只有浅克隆按 depth 浅获取。
+     * 随后只重新解析新旧提交之间变化的 port.toml，反向依赖由索引条目实时计算，因此无需另外更新。
+     * 稀疏检出时使用 --filter=blob:none，不下载其他命名空间的文件内容。origin 可以是本地的裸仓库。
+     *
+     * @return 成功时返回 true。
+     */
+    bool UpdatePortTree(const UpdateOptions& options);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_PORTTREESYNC_H
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "MainProcess/ResourceBudget.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace MainProcess {
+
+    // 从历史推算的内存峰值只是一次观测，设置硬限制时预留的余量
+    static constexpr double kLimitHeadroom = 1.5;
+    static constexpr uint64_t kGiB = 1024ull * 1024 * 1024;
+
+    bool ParseByteSize(const std::string& text, uint64_t& bytes) {
+        size_t pos = 0;
+        double number = 0.0;
+        try {
+            number = std::stod(text, &pos);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (number < 0) return false;
+
+        std::string unit;
+        for (char c : text.substr(pos)) {
+            if (!std::isspace(static_cast<unsigned char>(c))) {
+                unit.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+            }
+        }
+        if (unit.size() > 1 && unit.back() == 'B') unit.pop_back();  // "GB" / "GIB" -> "G" / "GI"
+        if (unit.size() > 1 && unit.back() == 'I') unit.pop_back();
+
+        double multiplier = 1.0;
+        if (unit.empty() || unit == "B") {
+            multiplier = 1.0;
+        } else if (unit == "K") {
+            multiplier = 1024.0;
+        } else if (unit == "M") {
+            multiplier = 1024.0 * 1024;
+        } else if (unit == "G") {
+            multiplier = static_cast<double>(kGiB);
+        } else if (unit == "T") {
+            multiplier = static_cast<double>(kGiB) * 1024;
+        } else {
+            return false;
+        }
+        bytes = static_cast<uint64_t>(number * multiplier);
+        return true;
+    }
+
+    bool ReadByteSize(const toml::node_view<const toml::node>& node, uint64_t& bytes) {
+        if (auto text = node.value<std::string>()) {
+            if (ParseByteSize(*text, bytes)) return true;
+            std::cerr << "警告: 无法解析容量 '" << *text << "'，已忽略。" << std::endl;
+            return false;
+        }
+        if (auto number = node.value<int64_t>()) {
+            bytes = static_cast<uint64_t>(std::max<int64_t>(0, *number));
+            return true;
+        }
+        return false;
+    }
+
+    static uint64_t PhysicalMemoryBytes() {
+        long pages = sysconf(_SC_PHYS_PAGES);
+        long page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages <= 0 || page_size <= 0) return 8 * kGiB;
+        return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+    }
+
+    HostBudget LoadHostBudget(const toml::table& gcpkg_toml) {
+        HostBudget budget;
+        budget.memory_bytes = PhysicalMemoryBytes();
+        budget.cpus = std::max(1u, std::thread::hardware_concurrency());
+        budget.default_memory_bytes = 2 * kGiB;
+        budget.default_cpus = 1.0;
+
+        auto resources = gcpkg_toml["resources"];
+        if (!resources.is_table()) {
+            return budget;
+        }
+
+        budget.explicit_memory = ReadByteSize(resources["memory"], budget.memory_bytes);
+        if (auto cpus = resources["cpus"].value<double>()) {
+            budget.cpus = std::max(0.1, *cpus);
+            budget.explicit_cpus = true;
+        }
+        ReadByteSize(resources["default_memory"], budget.default_memory_bytes);
+        budget.default_cpus = resources["default_cpus"].value_or(budget.default_cpus);
+        budget.per_build_cgroup = resources["per_build_cgroup"].value_or(false);
+        return budget;
+    }
+
+    ResourceFootprint EstimateFootprint(const PackageNode& node,
+                                        const BuildHistory& history,
+                                        const HostBudget& budget) {
+        ResourceFootprint footprint;
+        footprint.memory_bytes = budget.default_memory_bytes;
+        footprint.cpus = budget.default_cpus;
+
+        // 1. 历史记录：内存峰值与平均并行度。历史中只保存有独立 cgroup 的构建的读数，
+        //    与其他构建共享会话容器时的采样不会被用作硬限制
+        BuildRecord record;
+        if (history.Find(node.spec, node.port_hash, record)) {
+            if (record.peak_memory_bytes > 0) {
+                footprint.memory_bytes = record.peak_memory_bytes;
+                footprint.memory_limit_bytes = static_cast<uint64_t>(record.peak_memory_bytes * kLimitHeadroom);
+            }
+            if (record.wall_seconds > 0 && record.cpu_seconds > 0) {
+                footprint.cpus = std::max(1.0, std::ceil(record.cpu_seconds / record.wall_seconds));
+            }
+        }
+
+        // 2. port.toml 的显式声明优先于历史推算
+        auto resources = node.port_toml["resources"];
+        if (resources.is_table()) {
+            uint64_t declared_memory = 0;
+            if (ReadByteSize(resources["memory"], declared_memory)) {
+                footprint.memory_bytes = declared_memory;
+                footprint.memory_limit_bytes = declared_memory;
+            }
+            if (auto cpus = resources["cpus"].value<double>()) {
+                footprint.cpus = std::max(0.1, *cpus);
+                footprint.cpu_limit = footprint.cpus;
+            }
+        }
+
+        // 3. 单个构建不可能使用超过宿主机预算的资源
+        footprint.memory_bytes = std::min(footprint.memory_bytes, budget.memory_bytes);
+        footprint.cpus = std::min(footprint.cpus, budget.cpus);
+        if (footprint.memory_limit_bytes > 0) {
+            footprint.memory_limit_bytes = std::min(footprint.memory_limit_bytes, budget.memory_bytes);
+        }
+        if (footprint.cpu_limit > 0) {
+            footprint.cpu_limit = std::min(footprint.cpu_limit, budget.cpus);
+        }
+        return footprint;
+    }
+
+    ResourceLedger::ResourceLedger(const HostBudget& budget) : budget_(budget) {
+    }
+
+    bool ResourceLedger::CanAdmit(const ResourceFootprint& footprint) const {
+        if (running_ == 0) return true;
+        return used_memory_ + footprint.memory_bytes <= budget_.memory_bytes &&
+               used_cpus_ + footprint.cpus <= budget_.cpus + 1e-9;
+    }
+
+    void ResourceLedger::Acquire(const ResourceFootprint& footprint) {
+        used_memory_ += footprint.memory_bytes;
+        used_cpus_ += footprint.cpus;
+        ++running_;
+    }
+
+    void ResourceLedger::Release(const ResourceFootprint& footprint) {
+        used_memory_ -= std::min(used_memory_, footprint.memory_bytes);
+        used_cpus_ = std::max(0.0, used_cpus_ - footprint.cpus);
+        --running_;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef MAINPROCESS_RESOURCEBUDGET_H
+#define MAINPROCESS_RESOURCEBUDGET_H
+
+#include <cstdint>
+#include <string>
+
+#include "MainProcess/BuildHistory.h"
+#include "MainProcess/DependencyGraph.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // 一个构建预计占用的资源
+    struct ResourceFootprint {
+        uint64_t memory_bytes = 0;
+        double cpus = 0.0;
+        // 应用到该构建 cgroup 上的硬限制，0 表示不限制
+        uint64_t memory_limit_bytes = 0;
+        double cpu_limit = 0.0;
+    };
+
+    // 宿主机可分配给构建的资源总量，来自 gcpkg.toml 的 [resources] 表
+    struct HostBudget {
+        uint64_t memory_bytes = 0;
+        double cpus = 0.0;
+        bool explicit_memory = false;  // 用户显式配置了 memory，会话容器将以此为上限
+        bool explicit_cpus = false;    // 用户显式配置了 cpus，会话容器将以此为上限
+        uint64_t default_memory_bytes = 0;
+        double default_cpus = 0.0;
+        bool per_build_cgroup = false;  // 是否为每个构建创建独立的 cgroup
+    };
+
+    /**
+     * @brief 解析 "512M"、"8G"、"1.5GiB" 或纯数字 (字节) 形式的容量描述。
+     *
+     * @return 格式无效时返回 false。
+     */
+    bool ParseByteSize(const std::string& text, uint64_t& bytes);
+
+    // 读取 "8G" 字符串或整数字节数形式的容量项；项不存在或无法解析时返回 false 并保持 bytes 不变
+    bool ReadByteSize(const toml::node_view<const toml::node>& node, uint64_t& bytes);
+
+    /**
+     * @brief 从 gcpkg.toml 的 [resources] 表读取宿主机资源预算。
+     *
+     * 未配置的项使用宿主机的物理内存和 CPU 核心数。
+     */
+    HostBudget LoadHostBudget(const toml::table& gcpkg_toml);
+
+    /**
+     * @brief 估计一个包构建时的资源占用。
+     *
+     * 优先使用 port.toml 中 [resources] 的声明；否则根据构建历史中的内存峰值和
+     * 平均 CPU 并行度推算；都没有时使用预算中的默认值。
+     */
+    ResourceFootprint EstimateFootprint(const PackageNode& node, const BuildHistory& history, const HostBudget& budget);
+
+    /**
+     * @brief 调度器使用的资源记账器 (非线程安全，由调度器的锁保护)。
+     *
+     * 只有当构建的占用能放进剩余预算时才允许启动。为避免单个超出预算的构建永远无法启动，
+     * 在没有任何构建运行时总是允许启动。
+     */
+    class ResourceLedger {
+      public:
+        explicit ResourceLedger(const HostBudget& budget);
+
+        bool CanAdmit(const ResourceFootprint& footprint) const;
+        void Acquire(const ResourceFootprint& footprint);
+        void Release(const ResourceFootprint& footprint);
+
+      private:
+        HostBudget budget_;
+        uint64_t used_memory_ = 0;
+        double used_cpus_ = 0.0;
+        int running_ = 0;
+    };
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_RESOURCEBUDGET_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "MainProcess/ResourceReport.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    static double ToMiB(uint64_t bytes) {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    static toml::table WriteRecord(const CommandResourceRecord& record) {
+        const auto& usage = record.usage;
+        return toml::table{{"package", record.package},
+                           {"step", record.step},
+                           {"command", record.command},
+                           {"meta", record.meta},
+                           {"wall_seconds", record.wall_seconds},
+                           {"cpu_seconds", usage.cpu_seconds},
+                           {"user_cpu_seconds", usage.user_cpu_seconds},
+                           {"system_cpu_seconds", usage.system_cpu_seconds},
+                           {"peak_memory_bytes", static_cast<int64_t>(usage.peak_memory_bytes)},
+                           {"read_bytes", static_cast<int64_t>(usage.read_bytes)},
+                           {"write_bytes", static_cast<int64_t>(usage.write_bytes)}};
+    }
+
+    fs::path ResourceReport::DefaultPath() {
+        return fs::path("gcpkg/session/resource_report.toml");
+    }
+
+    void ResourceReport::Add(CommandResourceRecord record) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.push_back(std::move(record));
+    }
+
+    bool ResourceReport::Save(const std::string& session_id, const fs::path& path) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        toml::array commands;
+        for (const auto& record : records_) commands.push_back(WriteRecord(record));
+        toml::table report_toml{{"session_id", session_id},
+                                {"timestamp", static_cast<int64_t>(std::time(nullptr))},
+                                {"commands", std::move(commands)}};
+
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+
+        fs::path temp_path = path;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入资源报告 " << temp_path << std::endl;
+                return false;
+            }
+            file << report_toml;
+        }
+        fs::rename(temp_path, path, ec);
+        return !ec;
+    }
+
+    void ResourceReport::PrintSummary(size_t top_n) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (records_.empty()) return;
+
+        Basic::DockerExecutor::ResourceUsage total;
+        for (const auto& record : records_) {
+            total.cpu_seconds += record.usage.cpu_seconds;
+            total.user_cpu_seconds += record.usage.user_cpu_seconds;
+            total.system_cpu_seconds += record.usage.system_cpu_seconds;
+            total.peak_memory_bytes = std::max(total.peak_memory_bytes, record.usage.peak_memory_bytes);
+            total.read_bytes += record.usage.read_bytes;
+            total.write_bytes += record.usage.write_bytes;
+        }
+
+        std::cout << std::fixed << std::setprecision(1) << "--- Resource usage of " << records_.size()
+                  << " command(s): cpu " << total.cpu_seconds << "s (user " << total.user_cpu_seconds << "s, sys "
+                  << total.system_cpu_seconds << "s), peak " << ToMiB(total.peak_memory_bytes) << " MiB, read "
+                  << ToMiB(total.read_bytes) << " MiB, written " << ToMiB(total.write_bytes) << " MiB ---"
+                  << std::endl;
+
+        // 按 key 降序打印前 top_n 条；值为 0 的命令没有参考价值，不打印
+        auto print_top = [&](const char* title,
+                             const std::function<double(const CommandResourceRecord&)>& key,
+                             const char* unit) {
+            std::vector<const CommandResourceRecord*> sorted;
+            for (const auto& record : records_) {
+                if (key(record) > 0) sorted.push_back(&record);
+            }
+            if (sorted.empty()) return;
+            const size_t count = std::min(top_n, sorted.size());
+            std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(), [&](auto* a, auto* b) {
+                return key(*a) > key(*b);
+            });
+
+            std::cout << "  Top commands by " << title << ":" << std::endl;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& record = *sorted[i];
+                std::cout << "    " << std::setw(10) << key(record) << unit << "  " << record.package << " "
+                          << record.step << ": " << record.command << std::endl;
+            }
+        };
+
+        print_top("CPU time", [](const auto& r) { return r.usage.cpu_seconds; }, "s  ");
+        print_top("peak memory", [](const auto& r) { return ToMiB(r.usage.peak_memory_bytes); }, " MiB");
+        print_top("I/O", [](const auto& r) { return ToMiB(r.usage.read_bytes + r.usage.write_bytes); }, " MiB");
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef MAINPROCESS_RESOURCEREPORT_H
+#define MAINPROCESS_RESOURCEREPORT_H
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Basic/DockerExecutor/ContainerStats.h"
+
+namespace MainProcess {
+
+    // 一条构建命令 (或元命令) 的资源消耗
+    struct CommandResourceRecord {
+        std::string package;  // 包规格，例如 zlib@1.3
+        std::string step;     // 所属步骤，例如 build
+        std::string command;  // 展开后的命令 (截断) 或元命令名称
+        bool meta = false;    // 是否为在 gcpkg 进程内执行的元命令
+        double wall_seconds = 0.0;
+        Basic::DockerExecutor::ResourceUsage usage;
+    };
+
+    /**
+     * @brief 单次安装会话中每条构建命令的资源消耗报告。
+     *
+     * 容器内命令的用户态/内核态 CPU、内存峰值和块设备读写字节数来自构建所在的 cgroup；
+     * 元命令的数据来自执行线程的 getrusage。报告保存在 gcpkg/session/resource_report.toml 中，
+     * 会话结束时按 CPU、内存峰值和 I/O 分别打印消耗最多的命令。Add 可以被多个构建线程并发调用。
+     */
+    class ResourceReport {
+      public:
+        static std::filesystem::path DefaultPath();
+
+        void Add(CommandResourceRecord record);
+
+        // 按记录顺序写出全部命令；先写临时文件再重命名
+        bool Save(const std::string& session_id, const std::filesystem::path& path = DefaultPath()) const;
+
+        // 打印 CPU 时间、内存峰值和 I/O 字节数各自排名前 top_n 的命令
+        void PrintSummary(size_t top_n) const;
+
+      private:
+        mutable std::mutex mutex_;
+        std::vector<CommandResourceRecord> records_;
+    };
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_RESOURCEREPORT_H
\ No newline at end of file
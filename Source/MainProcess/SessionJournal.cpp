@@ -0,0 +1,210 @@
+#include "MainProcess/SessionJournal.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+
+#include "toml++/toml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    const char* ToString(SessionPackageState state) {
+        switch (state) {
+            case SessionPackageState::Pending:
+                return "pending";
+            case SessionPackageState::Building:
+                return "building";
+            case SessionPackageState::Done:
+                return "done";
+            case SessionPackageState::Failed:
+                return "failed";
+        }
+        return "pending";
+    }
+
+    static SessionPackageState ParseState(const std::string& text) {
+        if (text == "done") return SessionPackageState::Done;
+        if (text == "failed") return SessionPackageState::Failed;
+        // 中断时正在构建的包与未开始的包一样需要重新调度
+        return SessionPackageState::Pending;
+    }
+
+    fs::path SessionJournal::DefaultPath() {
+        return fs::path("gcpkg/session/session.toml");
+    }
+
+    SessionJournal::SessionJournal(fs::path path) : path_(std::move(path)) {
+    }
+
+    bool SessionJournal::Load() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_id.clear();
+        container_name.clear();
+        requested.clear();
+        packages.clear();
+
+        if (!fs::exists(path_)) return false;
+
+        toml::table session_toml;
+        try {
+            session_toml = toml::parse_file(path_.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 会话日志 " << path_ << " 已损坏: " << err << std::endl;
+            return false;
+        }
+
+        session_id = session_toml["session_id"].value_or("");
+        container_name = session_toml["container"].value_or("");
+        update_lock = session_toml["update_lock"].value_or(true);
+        if (auto requested_array = session_toml["requested"].as_array()) {
+            for (const auto& node : *requested_array) {
+                requested.push_back(node.value_or(""));
+            }
+        }
+        if (auto packages_table = session_toml["packages"].as_table()) {
+            for (auto&& [spec, package_node] : *packages_table) {
+                auto package_table = package_node.as_table();
+                if (!package_table) continue;
+
+                SessionPackage package;
+                package.state = ParseState((*package_table)["state"].value_or("pending"));
+                if (auto downloads = (*package_table)["downloads"].as_table()) {
+                    for (auto&& [file, hash] : *downloads) {
+                        package.downloads[std::string(file.str())] = hash.value_or("");
+                    }
+                }
+                packages[std::string(spec.str())] = std::move(package);
+            }
+        }
+        return !requested.empty();
+    }
+
+    bool SessionJournal::Save() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return SaveLocked();
+    }
+
+    bool SessionJournal::SaveLocked() const {
+        toml::table packages_table;
+        for (const auto& [spec, package] : packages) {
+            toml::table downloads;
+            for (const auto& [file, hash] : package.downloads) downloads.insert_or_assign(file, hash);
+            toml::table package_table{{"state", ToString(package.state)}};
+            package_table.insert_or_assign("downloads", std::move(downloads));
+            packages_table.insert_or_assign(spec, std::move(package_table));
+        }
+
+        toml::array requested_array;
+        for (const auto& spec : requested) requested_array.push_back(spec);
+
+        toml::table session_toml{
+            {"session_id", session_id}, {"container", container_name}, {"update_lock", update_lock}};
+        session_toml.insert_or_assign("requested", std::move(requested_array));
+        session_toml.insert_or_assign("packages", std::move(packages_table));
+
+        std::error_code ec;
+        fs::create_directories(path_.parent_path(), ec);
+        fs::path temp_path = path_;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入会话日志 " << temp_path << std::endl;
+                return false;
+            }
+            file << session_toml;
+        }
+        fs::rename(temp_path, path_, ec);
+        return !ec;
+    }
+
+    void SessionJournal::Finish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::error_code ec;
+        fs::remove(path_, ec);
+    }
+
+    void SessionJournal::SetPackageState(const std::string& spec, SessionPackageState state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        packages[spec].state = state;
+        SaveLocked();
+    }
+
+    static const fs::path kLiveSessionDir = "gcpkg/session/live";
+
+    // 记录与锁文件同名，扩展名不同：记录通过原子替换写入，锁必须留在不变的 inode 上
+    static fs::path LiveSessionLockFile(const fs::path& record) {
+        fs::path lock_file = record;
+        return lock_file.replace_extension(".lock");
+    }
+
+    LiveSession::LiveSession(const std::string& session_id, const std::set<std::string>& packages)
+        : path_(kLiveSessionDir / (session_id + "-" + std::to_string(getpid()) + ".toml")) {
+        // 先加锁再写记录，gc 看到的记录总是已被锁定
+        lock_ = std::make_unique<Basic::Utils::SharedFileLock>(
+            LiveSessionLockFile(path_), Basic::Utils::SharedFileLock::Mode::Shared, "live session record");
+
+        toml::array packages_array;
+        for (const auto& package : packages) packages_array.push_back(package);
+        toml::table record{{"session_id", session_id}};
+        record.insert_or_assign("packages", std::move(packages_array));
+
+        std::error_code ec;
+        fs::create_directories(path_.parent_path(), ec);
+        fs::path temp_path = path_;
+        temp_path += ".tmp";
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入会话记录 " << temp_path << "，gc 可能回收本次会话的包。" << std::endl;
+                return;
+            }
+            file << record;
+        }
+        fs::rename(temp_path, path_, ec);
+    }
+
+    LiveSession::~LiveSession() {
+        std::error_code ec;
+        fs::remove(path_, ec);
+        fs::remove(LiveSessionLockFile(path_), ec);
+    }
+
+    std::set<std::string> LiveSession::LoadPackages(bool remove_stale) {
+        std::set<std::string> packages;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(kLiveSessionDir, ec)) {
+            if (entry.path().extension() != ".toml") continue;
+            const fs::path lock_file = LiveSessionLockFile(entry.path());
+            // 能拿到独占锁说明写记录的进程已经退出
+            if (auto stale = Basic::Utils::SharedFileLock::TryAcquire(lock_file,
+                                                                     Basic::Utils::SharedFileLock::Mode::Exclusive)) {
+                if (remove_stale) {
+                    std::error_code remove_ec;
+                    fs::remove(entry.path(), remove_ec);
+                    fs::remove(lock_file, remove_ec);
+                }
+                continue;
+            }
+            try {
+                const toml::table record = toml::parse_file(entry.path().string());
+                if (auto packages_array = record["packages"].as_array()) {
+                    for (const auto& node : *packages_array) packages.insert(node.value_or(""));
+                }
+            } catch (const toml::parse_error& err) {
+                std::cerr << "警告: 会话记录 " << entry.path() << " 已损坏: " << err << std::endl;
+            }
+        }
+        return packages;
+    }
+
+    void SessionJournal::SetPackageDownloads(const std::string& spec, std::map<std::string, std::string> downloads) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        packages[spec].downloads = std::move(downloads);
+        SaveLocked();
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
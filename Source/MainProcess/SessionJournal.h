@@ -0,0 +1,92 @@
+#ifndef MAINPROCESS_SESSIONJOURNAL_H
+#define MAINPROCESS_SESSIONJOURNAL_H
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Basic/Utils/FileLock.h"
+
+namespace MainProcess {
+
+    // 会话中单个包的状态
+    enum class SessionPackageState { Pending, Building, Done, Failed };
+
+    struct SessionPackage {
+        SessionPackageState state = SessionPackageState::Pending;
+        std::map<std::string, std::string> downloads;  // 构建完成时下载的文件 -> 内容摘要
+    };
+
+    /**
+     * @brief 安装会话的磁盘日志 (gcpkg/session/session.toml)。
+     *
+     * 每当包的状态改变时立即落盘，因此 Ctrl-C、容器崩溃或构建失败之后，
+     * `gcpkg install --resume` 仍能知道上一次会话请求了哪些包、用的是哪个容器、进行到哪一步。
+     * 步骤级别的进度由各包构建目录中的步骤日志 (BuildStepJournal) 记录。
+     * 会话成功结束时删除该文件。
+     */
+    class SessionJournal {
+      public:
+        static std::filesystem::path DefaultPath();
+
+        explicit SessionJournal(std::filesystem::path path = DefaultPath());
+
+        // 读取上一次未结束的会话；不存在或已损坏时返回 false
+        bool Load();
+        bool Save() const;
+        // 会话成功结束：删除日志文件
+        void Finish();
+
+        // 线程安全：更新包状态并立即落盘
+        void SetPackageState(const std::string& spec, SessionPackageState state);
+        void SetPackageDownloads(const std::string& spec, std::map<std::string, std::string> downloads);
+
+        std::string session_id;
+        std::string container_name;
+        std::vector<std::string> requested;
+        bool update_lock = true;  // 与 InstallOptions::update_lock 相同，恢复时沿用
+        std::map<std::string, SessionPackage> packages;
+
+      private:
+        bool SaveLocked() const;
+
+        std::filesystem::path path_;
+        mutable std::mutex mutex_;
+    };
+
+    /**
+     * @brief 进行中的安装会话的记录 (gcpkg/session/live/<会话>.toml)，列出会话依赖图中的包。
+     *
+     * session.toml 只保存最近一次可以恢复的会话；同时进行的多个会话 (其他进程或守护进程中的会话)
+     * 各自用这份记录让 gc 保护它们的包。存在期间持有 <会话>.lock 上的共享锁，
+     * gc 据此区分进行中的会话和异常退出后残留的记录。析构时删除记录。
+     */
+    class LiveSession {
+      public:
+        LiveSession(const std::string& session_id, const std::set<std::string>& packages);
+        ~LiveSession();
+
+        LiveSession(const LiveSession&) = delete;
+        LiveSession& operator=(const LiveSession&) = delete;
+
+        /**
+         * @brief 读取所有进行中的会话记录的包。
+         *
+         * @param remove_stale 是否删除异常退出的会话残留的记录。
+         */
+        static std::set<std::string> LoadPackages(bool remove_stale);
+
+      private:
+        std::filesystem::path path_;
+        std::unique_ptr<Basic::Utils::SharedFileLock> lock_;
+    };
+
+    const char* ToString(SessionPackageState state);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_SESSIONJOURNAL_H
\ No newline at end of file
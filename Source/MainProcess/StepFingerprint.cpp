@@ -0,0 +1,201 @@
+#include "MainProcess/StepFingerprint.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Basic/Utils/ContentHash.h"
+#include "MainProcess/DependencyGraph.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    BuildStepJournal::BuildStepJournal(fs::path build_dir) : path_(std::move(build_dir) / kFileName) {
+    }
+
+    void BuildStepJournal::Load() {
+        steps_.clear();
+        complete = false;
+        final_fingerprint.clear();
+        port_hash.clear();
+        pruned = false;
+
+        if (!fs::exists(path_)) return;
+
+        toml::table journal_toml;
+        try {
+            journal_toml = toml::parse_file(path_.string());
+        } catch (const toml::parse_error& err) {
+            std::cerr << "警告: 步骤日志 " << path_ << " 已损坏，将从头构建: " << err << std::endl;
+            return;
+        }
+
+        complete = journal_toml["complete"].value_or(false);
+        final_fingerprint = journal_toml["final_fingerprint"].value_or("");
+        // 旧格式只在顶层记录最后一个步骤结束时的 ${last_file}
+        const std::string legacy_last_file = journal_toml["last_file"].value_or("");
+        port_hash = journal_toml["port_hash"].value_or("");
+        pruned = journal_toml["pruned"].value_or(false);
+
+        if (auto steps_table = journal_toml["steps"].as_table()) {
+            for (auto&& [step_name, step_node] : *steps_table) {
+                auto step_table = step_node.as_table();
+                if (!step_table) continue;
+
+                StepState state;
+                state.fingerprint = (*step_table)["fingerprint"].value_or("");
+                state.last_file = (*step_table)["last_file"].value_or(legacy_last_file);
+                if (auto downloads_table = (*step_table)["downloads"].as_table()) {
+                    for (auto&& [file, hash_node] : *downloads_table) {
+                        state.downloads[std::string(file.str())] = hash_node.value_or("");
+                    }
+                }
+                steps_[std::string(step_name.str())] = std::move(state);
+            }
+        }
+    }
+
+    bool BuildStepJournal::Save() const {
+        toml::table steps_table;
+        for (const auto& [step_name, state] : steps_) {
+            toml::table downloads_table;
+            for (const auto& [file, hash] : state.downloads) {
+                downloads_table.insert_or_assign(file, hash);
+            }
+            steps_table.insert_or_assign(step_name,
+                                         toml::table{{"fingerprint", state.fingerprint},
+                                                     {"downloads", std::move(downloads_table)},
+                                                     {"last_file", state.last_file}});
+        }
+
+        toml::table journal_toml{{"complete", complete},
+                                 {"final_fingerprint", final_fingerprint},
+                                 {"port_hash", port_hash},
+                                 {"pruned", pruned}};
+        journal_toml.insert_or_assign("steps", std::move(steps_table));
+
+        std::error_code ec;
+        fs::create_directories(path_.parent_path(), ec);
+        fs::path temp_path = path_;
+        temp_path += ".tmp" + std::to_string(getpid());
+        {
+            std::ofstream file(temp_path);
+            if (!file.is_open()) {
+                std::cerr << "警告: 无法写入步骤日志 " << temp_path << std::endl;
+                return false;
+            }
+            file << journal_toml;
+        }
+        fs::rename(temp_path, path_, ec);
+        return !ec;
+    }
+
+    const StepState* BuildStepJournal::Find(const std::string& step) const {
+        auto it = steps_.find(step);
+        return it == steps_.end() ? nullptr : &it->second;
+    }
+
+    void BuildStepJournal::MarkCompleted(const std::string& step, StepState state) {
+        steps_[step] = std::move(state);
+    }
+
+    void BuildStepJournal::InvalidateFrom(const std::string& step, const std::vector<std::string>& step_order) {
+        bool invalidate = false;
+        for (const auto& name : step_order) {
+            if (name == step) invalidate = true;
+            if (invalidate) steps_.erase(name);
+        }
+        complete = false;
+        final_fingerprint.clear();
+    }
+
+    std::map<std::string, std::string> BuildStepJournal::Downloads() const {
+        std::map<std::string, std::string> downloads;
+        for (const auto& [step_name, state] : steps_) {
+            downloads.insert(state.downloads.begin(), state.downloads.end());
+        }
+        return downloads;
+    }
+
+    std::string ComputeUpstreamFingerprint(const toml::table& port_toml) {
+        std::ostringstream material;
+        material << "port:" << port_toml << "\n";
+
+        for (const auto& dep_spec : CollectPortDependencies(port_toml)) {
+            PackageSpec dep;
+            std::string dep_fingerprint;
+            if (ParsePackageSpec(dep_spec, dep)) {
+                BuildStepJournal dep_journal(fs::path("gcpkg/buildtrees") / dep.name / dep.version);
+                dep_journal.Load();
+                dep_fingerprint = dep_journal.final_fingerprint;
+            }
+            material << "dep:" << dep_spec << "=" << dep_fingerprint << "\n";
+        }
+        return Basic::Utils::HashString(material.str());
+    }
+
+    std::string ComputeStepFingerprint(const std::string& upstream,
+                                       const std::string& step,
+                                       const std::vector<std::string>& expanded_commands,
+                                       const std::string& work_dir,
+                                       const std::string& env_prefix_command) {
+        std::ostringstream material;
+        material << "upstream:" << upstream << "\n"
+                 << "step:" << step << "\n"
+                 << "work_dir:" << work_dir << "\n"
+                 << "env:" << env_prefix_command << "\n";
+        for (const auto& cmd : expanded_commands) {
+            material << "cmd:" << cmd << "\n";
+        }
+        return Basic::Utils::HashString(material.str());
+    }
+
+    Basic::FileHash::HashCache& FileHashCache() {
+        static Basic::FileHash::HashCache* cache = [] {
+            auto* instance = new Basic::FileHash::HashCache(fs::path("gcpkg/cache/file_hashes.tsv"));
+            instance->Load();
+            return instance;
+        }();
+        return *cache;
+    }
+
+    std::string HashDownload(const fs::path& file) {
+        return FileHashCache().Get(file, "fnv1a64", Basic::Utils::HashFile);
+    }
+
+    bool StepOutputsIntact(const std::string& step, const StepState& state, const fs::path& package_install_dir) {
+        if (step.find("install") != std::string::npos) {
+            std::error_code ec;
+            if (!fs::is_directory(package_install_dir, ec) || fs::is_empty(package_install_dir, ec)) {
+                return false;
+            }
+        }
+        for (const auto& [file, hash] : state.downloads) {
+            if (!fs::exists(file) || HashDownload(file) != hash) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IsBuildIncomplete(const fs::path& build_dir) {
+        // 构建目录是指向 tmpfs 的符号链接且 tmpfs 的内容已丢失：那次构建没有完成
+        std::error_code ec;
+        if (fs::is_symlink(build_dir, ec) && !fs::exists(build_dir, ec)) return true;
+        if (!fs::exists(build_dir / BuildStepJournal::kFileName)) {
+            return false;  // 早于步骤日志引入的构建，沿用安装目录存在即视为已安装的规则
+        }
+        BuildStepJournal journal(build_dir);
+        journal.Load();
+        return !journal.complete;
+    }
+
+    void MarkBuildStarted(const fs::path& build_dir) {
+        if (fs::exists(build_dir / BuildStepJournal::kFileName)) return;
+        BuildStepJournal(build_dir).Save();
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef MAINPROCESS_STEPFINGERPRINT_H
+#define MAINPROCESS_STEPFINGERPRINT_H
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Basic/FileHash/HashCache.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    // 一个已完成步骤的记录
+    struct StepState {
+        std::string fingerprint;
+        std::map<std::string, std::string> downloads;  // 该步骤下载的文件 -> 内容摘要
+        std::string last_file;                         // 该步骤结束时 ${last_file} 的值，跳过该步骤时用于恢复
+    };
+
+    /**
+     * @brief 单个包构建目录中的步骤日志 (${build_dir}/.gcpkg_steps.toml)。
+     *
+     * 记录每个已完成步骤的指纹和下载产物，使重新运行的安装可以跳过指纹未变且产物完好的步骤，
+     * 从第一个发生变化或失败的步骤继续。
+     */
+    class BuildStepJournal {
+      public:
+        static constexpr const char* kFileName = ".gcpkg_steps.toml";
+
+        explicit BuildStepJournal(std::filesystem::path build_dir);
+
+        void Load();
+        bool Save() const;
+
+        // 返回步骤的记录；该步骤尚未完成时返回 nullptr
+        const StepState* Find(const std::string& step) const;
+        void MarkCompleted(const std::string& step, StepState state);
+        // 删除 step 及其之后所有步骤的记录
+        void InvalidateFrom(const std::string& step, const std::vector<std::string>& step_order);
+        // 所有已完成步骤下载的文件 -> 内容摘要
+        std::map<std::string, std::string> Downloads() const;
+
+        bool complete = false;           // 全部步骤已成功完成
+        std::string final_fingerprint;   // 最后一个步骤的指纹，供依赖于本包的包使用
+        std::string port_hash;           // 完成构建时 port.toml 的内容摘要，用于判断包是否过期
+        bool pruned = false;             // 构建目录的内容已被 gc 删除，只保留了步骤日志和下载目录
+
+      private:
+        std::filesystem::path path_;
+        std::map<std::string, StepState> steps_;
+    };
+
+    /**
+     * @brief 计算一个包所有步骤指纹链的起点。
+     *
+     * 由 port.toml 的内容和每个依赖项最终的步骤指纹组成，因此任何依赖被重新构建后，
+     * 依赖于它的包也会从头开始构建。
+     */
+    std::string ComputeUpstreamFingerprint(const toml::table& port_toml);
+
+    /**
+     * @brief 计算单个步骤的指纹。
+     *
+     * @param upstream 上游指纹 (前一步骤的指纹及其下载产物的摘要)。
+     * @param step 步骤名。
+     * @param expanded_commands 展开变量后的命令列表。
+     * @param work_dir 展开后的工作目录。
+     * @param env_prefix_command 环境变量前缀。
+     */
+    std::string ComputeStepFingerprint(const std::string& upstream,
+                                       const std::string& step,
+                                       const std::vector<std::string>& expanded_commands,
+                                       const std::string& work_dir,
+                                       const std::string& env_prefix_command);
+
+    /**
+     * @brief 整个进程共用的文件摘要缓存 (gcpkg/cache/file_hashes.tsv)，第一次使用时加载。
+     *
+     * 下载产物的校验和存储去重都通过它查询摘要，未变化的文件不会被重新读取。
+     */
+    Basic::FileHash::HashCache& FileHashCache();
+
+    // 下载产物的内容摘要 (FNV-1a，经 FileHashCache 缓存)
+    std::string HashDownload(const std::filesystem::path& file);
+
+    /**
+     * @brief 检查已完成步骤的产物是否完好。
+     *
+     * 下载的文件必须仍存在且内容未变；安装阶段 (pre_install, install, post_install) 的步骤
+     * 还要求安装目录非空，否则手动删除安装目录后将无法重新安装。
+     */
+    bool StepOutputsIntact(const std::string& step,
+                           const StepState& state,
+                           const std::filesystem::path& package_install_dir);
+
+    /**
+     * @brief 判断构建目录中是否有一次尚未完成的构建。
+     *
+     * PrepareEnvironmentForPackage 会在构建开始前创建安装目录，因此仅凭安装目录是否存在
+     * 无法区分已安装的包和中途失败的构建。
+     */
+    bool IsBuildIncomplete(const std::filesystem::path& build_dir);
+
+    /**
+     * @brief 在第一次构建开始前写入一个未完成的步骤日志。
+     *
+     * 否则在第一个步骤完成之前被中断的构建会留下一个空的安装目录而没有步骤日志，
+     * 按 IsBuildIncomplete 的旧规则被当作已安装。已有步骤日志时不做任何修改。
+     */
+    void MarkBuildStarted(const std::filesystem::path& build_dir);
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_STEPFINGERPRINT_H
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "MainProcess/TmpfsBuildTree.h"
+
+#include <linux/magic.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "Basic/DockerExecutor/ExecuteInContainer.h"
+#include "Basic/Log/Log.h"
+#include "Basic/Utils/ContentHash.h"
+#include "MainProcess/BuildHistory.h"
+#include "MainProcess/BuildPlanner.h"
+#include "MainProcess/GarbageCollector.h"
+#include "MainProcess/ResourceBudget.h"
+#include "MainProcess/StepFingerprint.h"
+
+namespace fs = std::filesystem;
+
+namespace MainProcess {
+
+    // 可用空间低于该值时认为 tmpfs 已满
+    static constexpr uint64_t kFullThresholdBytes = 64ull << 20;
+
+    TmpfsConfig LoadTmpfsConfig(const toml::table& gcpkg_toml, const fs::path& gcpkg_root, const HostBudget& budget) {
+        TmpfsConfig config;
+        const auto tmpfs = gcpkg_toml["tmpfs"];
+        if (!tmpfs["enabled"].value_or(false)) return config;
+
+        const fs::path dir = fs::absolute(fs::path(tmpfs["dir"].value_or("/dev/shm")));
+        struct statfs dir_stat {};
+        if (statfs(dir.c_str(), &dir_stat) != 0) {
+            std::cerr << "警告: [tmpfs] 的目录 " << dir << " 不可用，构建目录仍放在磁盘上。" << std::endl;
+            return config;
+        }
+        if (dir_stat.f_type != TMPFS_MAGIC) {
+            std::cerr << "警告: " << dir << " 不是 tmpfs，把构建目录放在这里不会减少磁盘 I/O。" << std::endl;
+        }
+        // /dev/shm 的可用空间通常是物理内存的一半，与构建可用的内存预算无关，不能直接作为默认容量
+        const uint64_t available = static_cast<uint64_t>(dir_stat.f_bavail) * static_cast<uint64_t>(dir_stat.f_bsize);
+        if (!ReadByteSize(tmpfs["size"], config.capacity_bytes) || config.capacity_bytes == 0) {
+            config.capacity_bytes = std::min(available, budget.memory_bytes / 4);
+        } else if (config.capacity_bytes > budget.memory_bytes / 2) {
+            std::cerr << "警告: [tmpfs] 的 size 超过内存预算的一半，只使用 " << (budget.memory_bytes / 2 >> 20)
+                      << " MiB。" << std::endl;
+            config.capacity_bytes = budget.memory_bytes / 2;
+        }
+        if (!ReadByteSize(tmpfs["per_build_max"], config.per_build_bytes) || config.per_build_bytes == 0 ||
+            config.per_build_bytes > config.capacity_bytes) {
+            config.per_build_bytes = config.capacity_bytes;
+        }
+
+        // 不同项目的构建目录互不干扰
+        config.root = dir / ("gcpkg-" + Basic::Utils::HashString(gcpkg_root.string()).substr(0, 16));
+        std::error_code ec;
+        fs::create_directories(config.root, ec);
+        if (ec) {
+            std::cerr << "警告: 无法创建 " << config.root << ": " << ec.message() << "，构建目录仍放在磁盘上。"
+                      << std::endl;
+            config.root.clear();
+        }
+        return config;
+    }
+
+    void ChargeTmpfsToBudget(const TmpfsConfig& config, HostBudget& budget) {
+        if (config.root.empty()) return;
+        budget.memory_bytes -= std::min(budget.memory_bytes, config.capacity_bytes);
+    }
+
+    std::vector<std::string> TmpfsMountOptions(const TmpfsConfig& config) {
+        if (config.root.empty()) return {};
+        return {"-v", config.root.string() + ":" + config.root.string()};
+    }
+
+    bool IsTmpfsMounted(const std::string& container_name, const TmpfsConfig& config) {
+        if (config.root.empty()) return false;
+        // 在主机上创建一个标记文件，看容器中能否看到它
+        const fs::path marker = config.root / (".mount-check-" + std::to_string(getpid()));
+        std::ofstream(marker).put('\n');
+        const bool mounted =
+            Basic::DockerExecutor::ExecuteInContainer(container_name, "/", "test -e '" + marker.string() + "'");
+        std::error_code ec;
+        fs::remove(marker, ec);
+        return mounted;
+    }
+
+    TmpfsBuildTrees::TmpfsBuildTrees(TmpfsConfig config) : config_(std::move(config)) {
+        std::cout << "--- Build trees on tmpfs: " << config_.root << " (" << (config_.capacity_bytes >> 20)
+                  << " MiB, at most " << (config_.per_build_bytes >> 20) << " MiB per build) ---" << std::endl;
+    }
+
+    bool TmpfsBuildTrees::Reserve(uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (reserved_ + bytes > config_.capacity_bytes) return false;
+        reserved_ += bytes;
+        return true;
+    }
+
+    void TmpfsBuildTrees::ReserveExisting(uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_ += bytes;
+    }
+
+    void TmpfsBuildTrees::Release(uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_ -= std::min(reserved_, bytes);
+    }
+
+    // 同一文件系统内直接重命名，跨文件系统时退回复制后删除
+    static bool MoveEntry(const fs::path& from, const fs::path& to) {
+        std::error_code ec;
+        fs::rename(from, to, ec);
+        if (!ec) return true;
+        fs::copy(from,
+                 to,
+                 fs::copy_options::recursive | fs::copy_options::copy_symlinks | fs::copy_options::overwrite_existing,
+                 ec);
+        if (ec) {
+            std::cerr << "警告: 无法把 " << from << " 移动到 " << to << ": " << ec.message() << std::endl;
+            return false;
+        }
+        fs::remove_all(from, ec);
+        return true;
+    }
+
+    // 把构建目录的元数据从 from 移到 to；返回 from 中是否还有被丢下的构建产物
+    static bool MoveMetadata(const fs::path& from, const fs::path& to) {
+        const auto metadata = BuildTreeMetadata(from);
+        bool left_behind = false;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(from, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (metadata.count(name)) {
+                MoveEntry(entry.path(), to / name);
+            } else {
+                left_behind = true;
+            }
+        }
+        return left_behind;
+    }
+
+    static void MarkPruned(const fs::path& build_dir) {
+        if (!fs::exists(build_dir / BuildStepJournal::kFileName)) return;
+        BuildStepJournal journal(build_dir);
+        journal.Load();
+        journal.pruned = true;
+        journal.Save();
+    }
+
+    BuildTreePlacement::BuildTreePlacement(TmpfsBuildTrees* tmpfs, const PackageNode& node, const BuildHistory* history)
+        : tmpfs_(tmpfs), disk_dir_(BuildTreeDir(node.id)) {
+        // disk_dir_ 是主配置的构建目录，额外配置只把它当作源码目录读取，不能移动它
+        if (!node.config_name.empty()) return;
+        std::error_code ec;
+        bool linked = fs::is_symlink(disk_dir_, ec);
+        if (linked) {
+            tmpfs_dir_ = fs::read_symlink(disk_dir_, ec);
+            if (!fs::is_directory(tmpfs_dir_, ec)) {
+                std::cerr << "警告: " << disk_dir_ << " 指向的 tmpfs 目录已不存在 (例如主机重启过)，将从头构建。"
+                          << std::endl;
+                fs::remove(disk_dir_, ec);
+                linked = false;
+            }
+        }
+
+        bool use_tmpfs = tmpfs_ && node.config_units.empty();
+        uint64_t estimate = use_tmpfs ? tmpfs_->Config().per_build_bytes : 0;
+        BuildRecord record;
+        if (use_tmpfs && history && history->Find(node.spec, node.port_hash, record) && record.buildtree_bytes > 0) {
+            if (record.buildtree_bytes > tmpfs_->Config().per_build_bytes) {
+                std::cout << "--- " << node.spec << " needs about " << (record.buildtree_bytes >> 20)
+                          << " MiB of build tree, more than the tmpfs budget. Building on disk. ---" << std::endl;
+                use_tmpfs = false;
+            } else {
+                estimate = record.buildtree_bytes;
+            }
+        }
+        if (use_tmpfs) {
+            // 继续上一次的构建时，已经在 tmpfs 上的字节无论如何都占用着容量
+            const uint64_t existing = linked ? DirectoryBytes(tmpfs_dir_) : 0;
+            estimate = std::max(estimate, existing);
+            if (tmpfs_->Reserve(estimate)) {
+                reserved_ = estimate;
+            } else if (linked) {
+                // 上一次失败的构建已经在 tmpfs 上时继续使用它，即使预留不到完整的估计
+                tmpfs_->ReserveExisting(existing);
+                reserved_ = existing;
+            } else {
+                std::cout << "--- tmpfs is fully reserved. Building " << node.spec << " on disk. ---" << std::endl;
+                use_tmpfs = false;
+            }
+        }
+
+        if (linked) {
+            on_tmpfs_ = true;
+            if (use_tmpfs) {
+                std::cout << "--- Resuming the build tree on tmpfs: " << tmpfs_dir_ << " ---" << std::endl;
+            } else {
+                MoveToDisk();
+            }
+        } else if (use_tmpfs) {
+            tmpfs_dir_ = tmpfs_->Config().root / node.id.name / node.id.version;
+            MoveToTmpfs();
+        }
+    }
+
+    BuildTreePlacement::~BuildTreePlacement() {
+        if (reserved_ > 0) tmpfs_->Release(reserved_);
+    }
+
+    void BuildTreePlacement::MoveToTmpfs() {
+        std::error_code ec;
+        fs::remove_all(tmpfs_dir_, ec);  // 没有构建目录指向的残留目录
+        fs::create_directories(tmpfs_dir_, ec);
+        if (ec) {
+            std::cerr << "警告: 无法创建 " << tmpfs_dir_ << ": " << ec.message() << "，构建目录仍放在磁盘上。"
+                      << std::endl;
+            return;
+        }
+        fs::create_directories(disk_dir_, ec);
+        // 磁盘上已有的构建产物不会被带到 tmpfs 上，之后按被 gc 清理过的构建目录处理
+        if (MoveMetadata(disk_dir_, tmpfs_dir_)) MarkPruned(tmpfs_dir_);
+        fs::remove_all(disk_dir_, ec);
+        fs::create_directory_symlink(tmpfs_dir_, disk_dir_, ec);
+        if (ec) {
+            std::cerr << "警告: 无法创建符号链接 " << disk_dir_ << ": " << ec.message() << "，构建目录仍放在磁盘上。"
+                      << std::endl;
+            fs::create_directories(disk_dir_, ec);
+            MoveMetadata(tmpfs_dir_, disk_dir_);
+            fs::remove_all(tmpfs_dir_, ec);
+            return;
+        }
+        on_tmpfs_ = true;
+        std::cout << "--- Building on tmpfs: " << tmpfs_dir_ << " ---" << std::endl;
+    }
+
+    void BuildTreePlacement::MoveToDisk() {
+        // 日志在后台线程中写出，先等 package.log 写完再移动它
+        Basic::Log::Flush();
+        std::error_code ec;
+        fs::remove(disk_dir_, ec);
+        fs::create_directories(disk_dir_, ec);
+        if (MoveMetadata(tmpfs_dir_, disk_dir_)) MarkPruned(disk_dir_);
+        fs::remove_all(tmpfs_dir_, ec);
+        on_tmpfs_ = false;
+    }
+
+    bool BuildTreePlacement::Exhausted(bool oom_killed) const {
+        if (!on_tmpfs_ || !tmpfs_) return false;
+        if (oom_killed) return true;
+        struct statfs tmpfs_stat {};
+        if (statfs(tmpfs_dir_.c_str(), &tmpfs_stat) == 0 &&
+            static_cast<uint64_t>(tmpfs_stat.f_bavail) * static_cast<uint64_t>(tmpfs_stat.f_bsize) <
+                kFullThresholdBytes) {
+            return true;
+        }
+        return DirectoryBytes(tmpfs_dir_) > tmpfs_->Config().per_build_bytes;
+    }
+
+    void BuildTreePlacement::SpillToDisk() {
+        std::cout << "--- The build tree outgrew tmpfs. Rebuilding " << disk_dir_ << " on disk. ---" << std::endl;
+        MoveToDisk();
+        // tmpfs 上的步骤产物已不复存在，只保留下载缓存
+        BuildStepJournal(disk_dir_).Save();
+        if (reserved_ > 0) tmpfs_->Release(reserved_);
+        reserved_ = 0;
+    }
+
+    void BuildTreePlacement::Finish(bool success) {
+        if (on_tmpfs_ && success) MoveToDisk();
+        if (reserved_ > 0) tmpfs_->Release(reserved_);
+        reserved_ = 0;
+    }
+
+}  // namespace MainProcess
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef MAINPROCESS_TMPFSBUILDTREE_H
+#define MAINPROCESS_TMPFSBUILDTREE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MainProcess/DependencyGraph.h"
+#include "MainProcess/ResourceBudget.h"
+#include "toml++/toml.hpp"
+
+namespace MainProcess {
+
+    class BuildHistory;
+
+    // gcpkg.toml 的 [tmpfs] 表：把构建目录放在内存文件系统上
+    struct TmpfsConfig {
+        std::filesystem::path root;    // <dir>/gcpkg-<项目路径摘要>；为空表示不使用 tmpfs
+        uint64_t capacity_bytes = 0;   // size：所有并行构建合计可用的容量，默认为内存预算的 1/4 (不超过 dir 的可用空间)
+        uint64_t per_build_bytes = 0;  // per_build_max：单个构建目录的上限，默认等于 capacity_bytes
+    };
+
+    /**
+     * @brief 读取 [tmpfs] 表。
+     *
+     * enabled 为 false 或 dir (默认 /dev/shm) 不可用时返回的 root 为空。
+     * root 在主机和会话容器中使用相同的路径，因此构建目录可以是指向它的符号链接。
+     * tmpfs 占用的是内存，容量最多为 budget 内存预算的一半。
+     */
+    TmpfsConfig LoadTmpfsConfig(const toml::table& gcpkg_toml,
+                                const std::filesystem::path& gcpkg_root,
+                                const HostBudget& budget);
+
+    /**
+     * @brief 从构建可用的内存预算中扣除 tmpfs 的容量。
+     *
+     * tmpfs 的页面计入写入它的构建所在的内存 cgroup，不扣除时准入控制会按整个内存预算启动构建，
+     * 构建目录增长后整个会话超出内存。扣除后的预算用于准入和每个构建的内存限制；
+     * 会话容器的 --memory 仍使用原来的预算。config.root 为空时不做任何改变。
+     */
+    void ChargeTmpfsToBudget(const TmpfsConfig& config, HostBudget& budget);
+
+    // 启动会话容器时需要的 docker run 选项：把 root 以相同路径绑定到容器中
+    std::vector<std::string> TmpfsMountOptions(const TmpfsConfig& config);
+
+    // 容器中的 root 是否就是主机上的 root；重新连接的常驻容器可能是在未启用 tmpfs 时创建的
+    bool IsTmpfsMounted(const std::string& container_name, const TmpfsConfig& config);
+
+    /**
+     * @brief 一次安装会话中 tmpfs 容量的分配。线程安全。
+     *
+     * 每个放在 tmpfs 上的构建按历史记录中的构建目录大小 (没有记录时按 per_build_bytes) 预留容量，
+     * 预留不到时该构建使用磁盘。
+     */
+    class TmpfsBuildTrees {
+      public:
+        explicit TmpfsBuildTrees(TmpfsConfig config);
+
+        const TmpfsConfig& Config() const {
+            return config_;
+        }
+
+        bool Reserve(uint64_t bytes);
+        // 记入已经在 tmpfs 上的字节，即使超出容量
+        void ReserveExisting(uint64_t bytes);
+        void Release(uint64_t bytes);
+
+      private:
+        TmpfsConfig config_;
+        std::mutex mutex_;
+        uint64_t reserved_ = 0;
+    };
+
+    /**
+     * @brief 单个包在构建期间的构建目录位置。
+     *
+     * 放在 tmpfs 上时，BuildTreeDir 被替换为指向 <root>/<name>/<version> 的符号链接，主机上的步骤日志、
+     * 下载和解压与容器中的构建命令都经由同一个路径访问，构建计划不需要任何改变。
+     * 构建成功后只把步骤日志、存储清单、日志和 _downloads 移回磁盘，并像被 gc 清理过的构建目录一样标记为 pruned；
+     * 安装前缀本来就在磁盘上的 gcpkg/packages 中。构建失败时保留 tmpfs 中的目录，供 `install --resume` 继续。
+     *
+     * 只有没有额外构建配置的包使用 tmpfs：额外配置的构建把主配置的构建目录当作共享的源码目录，
+     * 因此额外配置的节点完全不改变构建目录的位置。必须在持有包锁时构造。
+     */
+    class BuildTreePlacement {
+      public:
+        BuildTreePlacement(TmpfsBuildTrees* tmpfs, const PackageNode& node, const BuildHistory* history);
+        ~BuildTreePlacement();
+
+        BuildTreePlacement(const BuildTreePlacement&) = delete;
+        BuildTreePlacement& operator=(const BuildTreePlacement&) = delete;
+
+        bool OnTmpfs() const {
+            return on_tmpfs_;
+        }
+
+        // 为该构建预留的 tmpfs 容量；这些页面计入构建的内存 cgroup，内存限制需要加上它
+        uint64_t Reserved() const {
+            return reserved_;
+        }
+
+        /**
+         * @brief 失败的构建是否是因为构建目录超出了预算或 tmpfs 已满。
+         *
+         * @param oom_killed 构建期间它的内存 cgroup 中是否发生了 OOM kill；tmpfs 的页面计入该 cgroup，
+         *                   放在 tmpfs 上时同样视为 tmpfs 不够用。
+         */
+        bool Exhausted(bool oom_killed) const;
+
+        // 把构建目录移回磁盘并清空步骤记录，之后的构建从第一个步骤开始
+        void SpillToDisk();
+
+        // 构建结束：成功时把元数据移回磁盘并删除 tmpfs 中的目录
+        void Finish(bool success);
+
+      private:
+        void MoveToTmpfs();
+        void MoveToDisk();
+
+        TmpfsBuildTrees* tmpfs_;
+        std::filesystem::path disk_dir_;   // BuildTreeDir(node.id)
+        std::filesystem::path tmpfs_dir_;  // <root>/<name>/<version>
+        uint64_t reserved_ = 0;
+        bool on_tmpfs_ = false;
+    };
+
+}  // namespace MainProcess
+
+#endif  // MAINPROCESS_TMPFSBUILDTREE_H
\ No newline at end of file
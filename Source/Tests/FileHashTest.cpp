@@ -0,0 +1,65 @@
+// Hash64 与 XXH64 参考实现的测试向量一致；HashFile 的树形摘要与线程数无关
+#include <cstdint>
+#include <string>
+
+#include "Basic/FileHash/FileHash.h"
+#include "Tests/TestSupport.h"
+
+namespace FileHash = Basic::FileHash;
+
+namespace {
+
+    struct Vector {
+        std::string input;
+        uint64_t seed;
+        uint64_t expected;
+    };
+
+    // 由 xxHash 参考实现 (XXH64) 生成，覆盖空输入、4 / 8 字节尾部和多个 32 字节条带
+    const Vector kVectors[] = {
+        {"", 0, 0xef46db3751d8e999ULL},
+        {"", 1, 0xd5afba1336a3be4bULL},
+        {"", 0x9e3779b97f4a7c15ULL, 0xc4349fc93c010000ULL},
+        {"a", 0, 0xd24ec4f1a98c6e5bULL},
+        {"a", 1, 0xdec2bc81c3cd46c6ULL},
+        {"abc", 0, 0x44bc2cf5ad770999ULL},
+        {"abc", 0x9e3779b97f4a7c15ULL, 0x2ed0f59d6b43ac8bULL},
+        {"0123456789abcde", 0, 0x4bb51a30968e6a4dULL},
+        {"0123456789abcde", 1, 0x874394f505a62f29ULL},
+        {"Nobody inspects the spammish repetition", 0, 0xfbcea83c8a378bf1ULL},
+        {"Nobody inspects the spammish repetition", 1, 0x43f425448d954db6ULL},
+        {"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef!", 0, 0x2020b26dbc09cee8ULL},
+        {"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef!", 0x9e3779b97f4a7c15ULL,
+         0x06a25d8aaa9c3cc0ULL},
+    };
+
+}  // namespace
+
+int main() {
+    for (const auto& vector : kVectors) {
+        const uint64_t actual = FileHash::Hash64(vector.input.data(), vector.input.size(), vector.seed);
+        if (actual != vector.expected) {
+            std::cerr << "Hash64(\"" << vector.input << "\", " << vector.seed << ") = " << std::hex << actual
+                      << "，期望 " << vector.expected << std::dec << std::endl;
+        }
+        TEST_CHECK(actual == vector.expected);
+    }
+
+    Tests::TempDir temp("file-hash");
+    // 只有一块的文件的摘要就是 Hash64(内容, 0)
+    Tests::WriteFile(temp.Path() / "small", "abc");
+    TEST_CHECK(FileHash::HashFile(temp.Path() / "small") == "44bc2cf5ad770999");
+
+    // 多块的文件：摘要不随线程数变化，改动任何一块都会改变摘要
+    std::string content(FileHash::kChunkSize * 2 + 12345, '\0');
+    for (size_t i = 0; i < content.size(); ++i) content[i] = static_cast<char>((i * 131) ^ (i >> 11));
+    Tests::WriteFile(temp.Path() / "large", content);
+    const std::string one_thread = FileHash::HashFile(temp.Path() / "large", 1);
+    TEST_CHECK(one_thread.size() == 16);
+    TEST_CHECK(FileHash::HashFile(temp.Path() / "large", 4) == one_thread);
+    content[FileHash::kChunkSize + 1] ^= 1;
+    Tests::WriteFile(temp.Path() / "large", content);
+    TEST_CHECK(FileHash::HashFile(temp.Path() / "large", 4) != one_thread);
+
+    return Tests::Result();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// 锁在进程内共享，读写锁的实例之间互斥；被其他进程持有时 Acquire 在 stop_token 请求停止后放弃等待，对方释放后加锁成功
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <stop_token>
+#include <thread>
+
+#include "Basic/Utils/FileLock.h"
+#include "Tests/TestSupport.h"
+
+using Basic::Utils::FileLock;
+
+int main() {
+    Tests::TempDir temp("file-lock");
+    const auto lock_file = temp.Path() / "locks" / "package.lock";
+
+    {
+        FileLock first(lock_file, "package");
+        FileLock second(lock_file, "package");  // 本进程已持有，不会阻塞
+        TEST_CHECK(FileLock::Acquire(lock_file, "package", {}) != nullptr);
+        TEST_CHECK(FileLock::TryAcquire(lock_file) == nullptr);
+        TEST_CHECK(FileLock::IsHeld(lock_file));
+    }
+    TEST_CHECK(!FileLock::IsHeld(lock_file));
+
+    // 读写锁的实例之间即使在同一进程中也遵守共享 / 独占语义
+    {
+        using Mode = Basic::Utils::SharedFileLock::Mode;
+        const auto store_lock = temp.Path() / "locks" / "store.lock";
+        Basic::Utils::SharedFileLock reader(store_lock, Mode::Shared, "store");
+        TEST_CHECK(Basic::Utils::SharedFileLock::TryAcquire(store_lock, Mode::Shared) != nullptr);
+        TEST_CHECK(Basic::Utils::SharedFileLock::TryAcquire(store_lock, Mode::Exclusive) == nullptr);
+        auto writer = Basic::Utils::SharedFileLock::TryAcquire(temp.Path() / "locks" / "other.lock", Mode::Exclusive);
+        TEST_CHECK(writer != nullptr);
+    }
+    TEST_CHECK(Basic::Utils::SharedFileLock::TryAcquire(temp.Path() / "locks" / "store.lock",
+                                                       Basic::Utils::SharedFileLock::Mode::Exclusive) != nullptr);
+
+    // 子进程持有锁直到从管道读到数据
+    int release[2];
+    int ready[2];
+    if (pipe(release) != 0 || pipe(ready) != 0) return 1;
+    const pid_t child = fork();
+    if (child == 0) {
+        FileLock held(lock_file, "package");
+        char byte = 0;
+        (void)!write(ready[1], &byte, 1);
+        (void)!read(release[0], &byte, 1);
+        _exit(0);
+    }
+    char byte = 0;
+    TEST_CHECK(read(ready[0], &byte, 1) == 1);
+    TEST_CHECK(FileLock::IsHeld(lock_file));
+
+    std::stop_source stop;
+    std::jthread canceller([&stop] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        stop.request_stop();
+    });
+    TEST_CHECK(FileLock::Acquire(lock_file, "package", stop.get_token()) == nullptr);
+    canceller.join();
+
+    TEST_CHECK(write(release[1], &byte, 1) == 1);
+    TEST_CHECK(FileLock::Acquire(lock_file, "package", {}) != nullptr);
+    waitpid(child, nullptr, 0);
+
+    return Tests::Result();
+}
\ No newline at end of file
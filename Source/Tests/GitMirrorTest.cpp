@@ -0,0 +1,67 @@
+// GitMirror 对本地裸仓库 (file:// 地址) 的获取、增量更新和两种检出方式
+#include <filesystem>
+#include <string>
+
+#include "Basic/SystemIntegrate/GitMirror/GitMirror.h"
+#include "Tests/TestSupport.h"
+
+namespace fs = std::filesystem;
+namespace GitMirror = Basic::SystemIntegrate::GitMirror;
+
+int main() {
+    Tests::TempDir temp("git-mirror");
+    const fs::path work = temp.Path() / "work";
+    const fs::path upstream = temp.Path() / "upstream.git";
+    const std::string url = "file://" + upstream.string();
+
+    // 上游：一个提交，推送到裸仓库
+    fs::create_directories(work);
+    Tests::Git(work, "init -q");
+    Tests::WriteFile(work / "version.txt", "1\n");
+    Tests::Git(work, "add version.txt");
+    Tests::Git(work, "commit -q -m first");
+    Tests::Git(temp.Path(), "clone -q --bare work upstream.git");
+    const std::string first = Tests::Git(upstream, "rev-parse main");
+
+    GitMirror::GitFetchOptions options;
+    options.cache_dir = temp.Path() / "cache";
+
+    // 1. 第一次获取创建镜像并以 worktree 检出
+    std::string commit;
+    TEST_CHECK(GitMirror::FetchGitSource(url, "main", temp.Path() / "a", options, &commit));
+    TEST_CHECK(commit == first);
+    TEST_CHECK(Tests::ReadFile(temp.Path() / "a" / "version.txt") == "1\n");
+    const fs::path mirror = GitMirror::MirrorPath(options.cache_dir, url);
+    TEST_CHECK(fs::exists(mirror / "HEAD"));
+
+    // 2. 上游前进后增量更新同一个镜像，以 alternates 方式检出到另一个目录
+    Tests::WriteFile(work / "version.txt", "2\n");
+    Tests::Git(work, "commit -q -a -m second");
+    Tests::Git(work, "push -q " + upstream.string() + " main");
+    const std::string second = Tests::Git(upstream, "rev-parse main");
+
+    options.mode = GitMirror::CheckoutMode::Alternates;
+    TEST_CHECK(GitMirror::FetchGitSource(url, "main", temp.Path() / "b", options, &commit));
+    TEST_CHECK(commit == second);
+    TEST_CHECK(Tests::ReadFile(temp.Path() / "b" / "version.txt") == "2\n");
+    TEST_CHECK(Tests::ReadFile(temp.Path() / "b" / ".git/objects/info/alternates").find(mirror.string()) == 0);
+    size_t mirrors = 0;
+    for (const auto& entry : fs::directory_iterator(options.cache_dir)) mirrors += entry.is_directory() ? 1 : 0;
+    TEST_CHECK(mirrors == 1);
+
+    // 3. 已有的检出原地切换到新的提交
+    options.mode = GitMirror::CheckoutMode::Worktree;
+    TEST_CHECK(GitMirror::FetchGitSource(url, "main", temp.Path() / "a", options, &commit));
+    TEST_CHECK(Tests::ReadFile(temp.Path() / "a" / "version.txt") == "2\n");
+
+    // 4. 镜像中已有的提交哈希不访问远端，上游不可达时仍然可用
+    fs::remove_all(upstream);
+    TEST_CHECK(GitMirror::UpdateMirror(url, second, options, commit));
+    TEST_CHECK(commit == second);
+
+    // 5. 上游不可达时使用镜像中缓存的 ref
+    TEST_CHECK(GitMirror::UpdateMirror(url, "main", options, commit));
+    TEST_CHECK(commit == second);
+
+    return Tests::Result();
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+// UpdatePortTree 对本地裸仓库 (file:// 地址) 的增量同步和 port 索引更新
+#include <filesystem>
+#include <string>
+
+#include "MainProcess/PortIndex.h"
+#include "MainProcess/PortTreeSync.h"
+#include "Tests/TestSupport.h"
+
+namespace fs = std::filesystem;
+
+static std::string PortToml(const std::string& dependencies) {
+    return "[[build_configs]]\nbuild_type = \"Release\"\ndependencies = [" + dependencies + "]\n";
+}
+
+static void WritePort(const fs::path& repo, const std::string& path, const std::string& content) {
+    Tests::WriteFile(repo / "port" / path / "port.toml", content);
+}
+
+// 在 project 中克隆配置仓库并更新，返回更新后的索引
+static MainProcess::PortIndex Update(const fs::path& project) {
+    fs::current_path(project);
+    TEST_CHECK(MainProcess::UpdatePortTree({}));
+    MainProcess::PortIndex index;
+    index.Load();
+    return index;
+}
+
+int main() {
+    Tests::TempDir temp("port-tree-sync");
+    const fs::path work = temp.Path() / "work";
+    const fs::path upstream = temp.Path() / "upstream.git";
+    const std::string url = "file://" + upstream.string();
+
+    fs::create_directories(work);
+    Tests::Git(work, "init -q");
+    WritePort(work, "main/zlib/1.3", PortToml(""));
+    WritePort(work, "main/png/1.6", PortToml("\"zlib@main@1.3\""));
+    Tests::Git(work, "add port");
+    Tests::Git(work, "commit -q -m ports");
+    Tests::Git(temp.Path(), "clone -q --bare work upstream.git");
+
+    const fs::path full = temp.Path() / "full";
+    const fs::path shallow = temp.Path() / "shallow";
+    fs::create_directories(full);
+    fs::create_directories(shallow);
+    Tests::Git(full, "clone -q " + url + " gcpkg");
+    Tests::Git(shallow, "clone -q --depth=1 " + url + " gcpkg");
+
+    // 1. 第一次更新建立完整的索引
+    MainProcess::PortIndex index = Update(full);
+    TEST_CHECK(index.entries.size() == 2);
+    TEST_CHECK(index.ReverseDependencies()["zlib@main@1.3"].count("png@main@1.6") == 1);
+
+    // 2. 上游修改和新增 port：只有变化的条目被更新，反向依赖随之变化
+    WritePort(work, "main/png/1.6", PortToml(""));
+    WritePort(work, "main/curl/8.0", PortToml("\"zlib@main@1.3\""));
+    Tests::Git(work, "add port");
+    Tests::Git(work, "commit -q -m update");
+    Tests::Git(work, "push -q " + upstream.string() + " HEAD:main");
+
+    index = Update(full);
+    TEST_CHECK(index.entries.size() == 3);
+    TEST_CHECK(index.entries["png@main@1.6"].dependencies.empty());
+    auto reverse = index.ReverseDependencies();
+    TEST_CHECK(reverse["zlib@main@1.3"].count("png@main@1.6") == 0);
+    TEST_CHECK(reverse["zlib@main@1.3"].count("curl@main@8.0") == 1);
+    TEST_CHECK(Tests::ReadFile(full / "gcpkg/port/main/png/1.6/port.toml") == PortToml(""));
+
+    // 3. 完整克隆在默认的 depth 下仍然保持完整历史
+    TEST_CHECK(Tests::Git(full / "gcpkg", "rev-parse --is-shallow-repository") == "false");
+    TEST_CHECK(Tests::Git(full / "gcpkg", "rev-list --count HEAD") == "2");
+
+    // 4. 浅克隆继续浅获取
+    index = Update(shallow);
+    TEST_CHECK(index.entries.size() == 3);
+    TEST_CHECK(Tests::Git(shallow / "gcpkg", "rev-parse --is-shallow-repository") == "true");
+
+    fs::current_path(temp.Path());
+    return Tests::Result();
+}
\ No newline at end of file
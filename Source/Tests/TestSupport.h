@@ -0,0 +1,91 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+
+// 测试是独立的可执行文件：TEST_CHECK 失败时打印位置并计数，main 返回 Tests::Result()
+#define TEST_CHECK(condition)                                                                        \
+    do {                                                                                             \
+        if (!(condition)) {                                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #condition << std::endl;     \
+            ++Tests::Failures();                                                                     \
+        }                                                                                            \
+    } while (0)
+
+namespace Tests {
+
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline int Result() {
+        if (Failures() > 0) std::cerr << Failures() << " 项检查失败。" << std::endl;
+        return Failures() == 0 ? 0 : 1;
+    }
+
+    // 系统临时目录下的空目录，析构时连同内容一起删除
+    class TempDir {
+      public:
+        explicit TempDir(const std::string& name) {
+            path_ = std::filesystem::temp_directory_path() /
+                    ("gcpkg-test-" + name + "-" + std::to_string(::getpid()));
+            std::filesystem::remove_all(path_);
+            std::filesystem::create_directories(path_);
+        }
+        ~TempDir() {
+            std::error_code ec;
+            std::filesystem::remove_all(path_, ec);
+        }
+
+        TempDir(const TempDir&) = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        const std::filesystem::path& Path() const {
+            return path_;
+        }
+
+      private:
+        std::filesystem::path path_;
+    };
+
+    // 执行 shell 命令，失败时计为一项失败
+    inline bool Shell(const std::string& command) {
+        if (Basic::SystemIntegrate::CommandExecutor::executeCommand(command)) return true;
+        std::cerr << "命令失败: " << command << std::endl;
+        ++Failures();
+        return false;
+    }
+
+    // 在 repo 中执行 git 命令并返回去掉末尾换行的标准输出；提交使用固定的作者
+    inline std::string Git(const std::filesystem::path& repo, const std::string& args) {
+        using Basic::SystemIntegrate::CommandExecutor::shellQuote;
+        std::string output;
+        const std::string command = "git -c user.name=gcpkg -c user.email=gcpkg@localhost -c init.defaultBranch=main "
+                                    "-C " + shellQuote(repo.string()) + " " + args;
+        if (!Basic::SystemIntegrate::CommandExecutor::executeCommandWithOutput(command, output)) {
+            std::cerr << "命令失败: " << command << std::endl;
+            ++Failures();
+        }
+        while (!output.empty() && output.back() == '\n') output.pop_back();
+        return output;
+    }
+
+    inline void WriteFile(const std::filesystem::path& path, const std::string& content) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    inline std::string ReadFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+}  // namespace Tests
\ No newline at end of file
@@ -2,16 +2,23 @@
 #include <filesystem>  // 用于创建目录 (需要 C++17)
 #include <fstream>     // 用于文件写入 (std::ofstream)
 #include <iostream>
+#include <optional>
 #include <sstream>  // 用于解析 port 字符串
 #include <string>
 #include <thread>  // 用于获取 CPU 核心数
 #include <vector>
 
 #include "Basic/DockerExecutor/ExecuteInContainer.h"
+#include "Basic/Log/Log.h"
 #include "Basic/SystemIntegrate/CommandExecutor/CommandExecutor.h"
+#include "Basic/Trace/Trace.h"
 #include "MainProcess/CreatePortFile.h"
 #include "MainProcess/CreateProjectFile.h"
+#include "MainProcess/Daemon.h"
+#include "MainProcess/GarbageCollector.h"
 #include "MainProcess/InstallProcess.h"
+#include "MainProcess/InstallationOrchestrator.h"
+#include "MainProcess/PortTreeSync.h"
 #include "llvm-22/llvm/Support/CommandLine.h"
 
 namespace cl = llvm::cl;
@@ -43,14 +50,119 @@ static cl::opt<std::string> PortSpec("port",
                                      cl::cat(GcpkgCategory));
 
 // 'install' 子命令
-cl::SubCommand InstallCommand("install", "安装一个包");
-static cl::opt<std::string> PortToInstall(cl::Positional,  // This marks the option as positional
-                                          cl::desc("<package-spec>"),
-                                          cl::value_desc("name@namespace@version"),
-                                          cl::Required,
-                                          cl::sub(InstallCommand)  // Associate with the 'install' command
+cl::SubCommand InstallCommand("install", "安装一个或多个包");
+static cl::list<std::string> PortsToInstall(cl::Positional,  // This marks the option as positional
+                                            cl::desc("<package-spec>..."),
+                                            cl::value_desc("name@namespace@version"),
+                                            cl::ZeroOrMore,
+                                            cl::sub(InstallCommand)  // Associate with the 'install' command
 );
 
+static cl::opt<bool> InstallManifest("manifest",
+                                     cl::desc("安装 gcpkg.toml 中 [dependencies] 声明的所有包"),
+                                     cl::sub(InstallCommand),
+                                     cl::cat(GcpkgCategory));
+
+static cl::opt<bool> InstallResume("resume",
+                                   cl::desc("从上一次失败或中断的安装会话继续"),
+                                   cl::sub(InstallCommand),
+                                   cl::cat(GcpkgCategory));
+
+static cl::opt<bool> InstallKeepContainer("keep-container",
+                                          cl::desc("会话失败时保留容器，供 --resume 重新连接"),
+                                          cl::sub(InstallCommand),
+                                          cl::cat(GcpkgCategory));
+
+// 'plan' 子命令
+cl::SubCommand PlanCommand("plan", "显示安装计划而不执行构建");
+static cl::list<std::string> PortsToPlan(cl::Positional,
+                                         cl::desc("<package-spec>..."),
+                                         cl::value_desc("name@namespace@version"),
+                                         cl::ZeroOrMore,
+                                         cl::sub(PlanCommand));
+
+static cl::opt<bool> PlanManifest("manifest",
+                                  cl::desc("包含 gcpkg.toml 中 [dependencies] 声明的所有包"),
+                                  cl::sub(PlanCommand),
+                                  cl::cat(GcpkgCategory));
+
+static cl::opt<bool> EstimatePlan("estimate",
+                                  cl::desc("根据构建历史预测每个包的开始时间和会话总耗时"),
+                                  cl::sub(PlanCommand),
+                                  cl::cat(GcpkgCategory));
+
+// 'outdated' 子命令
+cl::SubCommand OutdatedCommand("outdated", "列出因 port 变化而需要重新构建的已安装包");
+
+// 'rebuild' 子命令
+cl::SubCommand RebuildCommand("rebuild", "只重新构建受 port 变化影响的包");
+static cl::list<std::string> PortsToRebuild(cl::Positional,
+                                            cl::desc("<package-spec>..."),
+                                            cl::value_desc("name@namespace@version"),
+                                            cl::ZeroOrMore,
+                                            cl::sub(RebuildCommand));
+
+static cl::opt<bool> RebuildAffected("affected",
+                                     cl::desc("重新构建所有 port 已变化的包及其已安装的依赖者"),
+                                     cl::sub(RebuildCommand),
+                                     cl::cat(GcpkgCategory));
+
+// 'update' 子命令
+cl::SubCommand UpdateCommand("update", "增量更新配置仓库并同步 port 索引");
+static cl::opt<int> UpdateDepth("depth",
+                                cl::desc("配置仓库为浅克隆时获取的深度，0 表示补全完整历史"),
+                                cl::value_desc("n"),
+                                cl::init(1),
+                                cl::sub(UpdateCommand),
+                                cl::cat(GcpkgCategory));
+
+static cl::list<std::string> UpdateNamespaces("namespace",
+                                              cl::desc("只检出这些命名空间的 port (逗号分隔)"),
+                                              cl::value_desc("ns"),
+                                              cl::CommaSeparated,
+                                              cl::sub(UpdateCommand),
+                                              cl::cat(GcpkgCategory));
+
+// 'daemon' 子命令
+cl::SubCommand DaemonCommand("daemon", "常驻运行，执行并合并其他 gcpkg 进程转发的命令");
+static cl::opt<bool> DaemonStop("stop",
+                                cl::desc("停止当前项目正在运行的守护进程"),
+                                cl::sub(DaemonCommand),
+                                cl::cat(GcpkgCategory));
+
+// 'gc' 子命令
+cl::SubCommand GcCommand("gc", "按 gcpkg.toml [gc] 中的容量上限回收最近最少使用的安装目录、构建目录和缓存");
+static cl::opt<bool> GcDryRun("dry-run",
+                              cl::desc("只列出会被回收的条目"),
+                              cl::sub(GcCommand),
+                              cl::cat(GcpkgCategory));
+
+// 可以转发给守护进程的子命令共用的选项
+static cl::opt<bool> NoDaemon("no-daemon",
+                              cl::desc("即使守护进程正在运行也在本进程中执行"),
+                              cl::sub(InstallCommand),
+                              cl::sub(PlanCommand),
+                              cl::sub(OutdatedCommand),
+                              cl::sub(RebuildCommand),
+                              cl::sub(UpdateCommand),
+                              cl::cat(GcpkgCategory));
+
+// 所有会执行安装或更新的子命令共用的选项
+static cl::opt<std::string> TraceFile("trace",
+                                      cl::desc("把本次会话的时间线以 Chrome trace-event JSON 格式写入该文件"),
+                                      cl::value_desc("file"),
+                                      cl::sub(InstallCommand),
+                                      cl::sub(PlanCommand),
+                                      cl::sub(RebuildCommand),
+                                      cl::sub(UpdateCommand),
+                                      cl::cat(GcpkgCategory));
+
+// 守护进程正在运行时把命令转发给它；--trace 只能记录本进程的时间线，因此总是在本进程中执行
+static std::optional<int> TryForwardToDaemon(const MainProcess::DaemonRequest& request) {
+    if (NoDaemon || !TraceFile.empty()) return std::nullopt;
+    return MainProcess::ForwardToDaemon(request);
+}
+
 // 3. 构建并填充分发映射
 using SubCommandCallback = std::function<int(int, char**)>;
 llvm::DenseMap<cl::SubCommand*, SubCommandCallback> SubCommandDispatchMap;
@@ -59,7 +171,10 @@ int HandleInitSubCommand(int argc, char** argv) {
     std::cout << "'init' 子命令被调用。" << std::endl;
     std::cout << "配置仓库 URL (--conf): " << ConfUrl.getValue() << std::endl;
     std::string git_command = "git clone " + ConfUrl.getValue() + " gcpkg";
-    Basic::SystemIntegrate::CommandExecutor::executeCommand(git_command);
+    if (!Basic::SystemIntegrate::CommandExecutor::executeCommand(git_command)) {
+        std::cerr << "错误: 克隆配置仓库失败。" << std::endl;
+        return 1;
+    }
     std::cout << "\n克隆完成。仓库内容已下载到 'gcpkg' 目录中。" << std::endl;
     return 0;
 }
@@ -92,23 +207,78 @@ int HandleCreateSubCommand(int argc, char** argv) {
 }
 
 int HandleInstallSubCommand(int argc, char** argv) {
-    if (PortToInstall.empty()) {
-        std::cerr << "错误: 'install' 命令需要一个包描述符。" << std::endl;
-        return 1;
-    }
+    // 不带包描述符时默认使用清单模式
+    MainProcess::InstallOptions options;
+    options.manifest = InstallManifest || (PortsToInstall.empty() && !InstallResume);
+    options.resume = InstallResume;
+    options.keep_container = InstallKeepContainer;
 
-    if (MainProcess::InstallPackage(PortToInstall.getValue())) {
+    std::vector<std::string> specs(PortsToInstall.begin(), PortsToInstall.end());
+    if (auto forwarded = TryForwardToDaemon({"install", specs, options, false, {}, false})) return *forwarded;
+    if (MainProcess::InstallPackages(specs, options)) {
         return 0;  // 成功
     } else {
         return 1;  // 失败
     }
 }
 
+int HandlePlanSubCommand(int argc, char** argv) {
+    MainProcess::InstallOptions options;
+    options.manifest = PlanManifest || PortsToPlan.empty();
+
+    std::vector<std::string> specs(PortsToPlan.begin(), PortsToPlan.end());
+    if (auto forwarded = TryForwardToDaemon({"plan", specs, options, EstimatePlan, {}, false})) return *forwarded;
+    return MainProcess::ShowInstallationPlan(specs, options, EstimatePlan) ? 0 : 1;
+}
+
+int HandleOutdatedSubCommand(int argc, char** argv) {
+    if (auto forwarded = TryForwardToDaemon({"outdated", {}, {}, false, {}, false})) return *forwarded;
+    return MainProcess::ShowOutdatedPackages() ? 0 : 1;
+}
+
+int HandleRebuildSubCommand(int argc, char** argv) {
+    if (!RebuildAffected && PortsToRebuild.empty()) {
+        std::cerr << "错误: 'rebuild' 命令需要 --affected 选项或至少一个包描述符。" << std::endl;
+        return 1;
+    }
+    // 只有 --affected 才把所有 port 已变化的包加入失效集合；否则只重建指定的包及其依赖者
+    std::vector<std::string> specs(PortsToRebuild.begin(), PortsToRebuild.end());
+    if (auto forwarded = TryForwardToDaemon({"rebuild", specs, {}, false, {}, RebuildAffected})) return *forwarded;
+    return MainProcess::RebuildAffectedPackages(specs, RebuildAffected) ? 0 : 1;
+}
+
+int HandleUpdateSubCommand(int argc, char** argv) {
+    MainProcess::UpdateOptions options;
+    options.depth = UpdateDepth;
+    options.namespaces.assign(UpdateNamespaces.begin(), UpdateNamespaces.end());
+    if (auto forwarded = TryForwardToDaemon({"update", {}, {}, false, options, false})) return *forwarded;
+    return MainProcess::UpdatePortTree(options) ? 0 : 1;
+}
+
+int HandleDaemonSubCommand(int argc, char** argv) {
+    if (DaemonStop) {
+        if (auto result = MainProcess::ForwardToDaemon({"stop", {}, {}, false, {}, false})) return *result;
+        std::cerr << "错误: 当前项目没有正在运行的守护进程。" << std::endl;
+        return 1;
+    }
+    return MainProcess::RunDaemon() ? 0 : 1;
+}
+
+int HandleGcSubCommand(int argc, char** argv) {
+    return MainProcess::RunGarbageCollection(GcDryRun) ? 0 : 1;
+}
+
 // 4. 注册子命令及其回调的函数
 void RegisterSubCommands() {
     SubCommandDispatchMap[&InitCommand] = HandleInitSubCommand;
     SubCommandDispatchMap[&CreateCommand] = HandleCreateSubCommand;
     SubCommandDispatchMap[&InstallCommand] = HandleInstallSubCommand;
+    SubCommandDispatchMap[&PlanCommand] = HandlePlanSubCommand;
+    SubCommandDispatchMap[&OutdatedCommand] = HandleOutdatedSubCommand;
+    SubCommandDispatchMap[&RebuildCommand] = HandleRebuildSubCommand;
+    SubCommandDispatchMap[&UpdateCommand] = HandleUpdateSubCommand;
+    SubCommandDispatchMap[&DaemonCommand] = HandleDaemonSubCommand;
+    SubCommandDispatchMap[&GcCommand] = HandleGcSubCommand;
 }
 
 // 主函数
@@ -124,7 +294,12 @@ int main(int argc, char** argv) {
     // 5. 在 main 函数中进行分发
     for (auto const& [subCmd, callback] : SubCommandDispatchMap) {
         if (*subCmd) {
-            return callback(argc, argv);
+            if (!TraceFile.empty()) Basic::Trace::Start(TraceFile.getValue());
+            Basic::Log::Start();
+            int result = callback(argc, argv);
+            Basic::Log::Stop();
+            Basic::Trace::Flush();
+            return result;
         }
     }
     return 0;